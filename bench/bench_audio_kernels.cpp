@@ -0,0 +1,153 @@
+// bench_audio_kernels.cpp — SIMD analysis kernels vs their scalar references.
+//
+// Runs every kernel over 1–60 s of 16 kHz speech-like PCM, first checking
+// that the vector result matches the scalar one (odd lengths, empty input,
+// no-crossing and edge-crossing cases included), then timing both.
+// Exits non-zero on any mismatch.
+#include "bench_check.h"
+#include "audio_kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace ak = audio_kernels;
+using Clock = std::chrono::steady_clock;
+
+static bool near(float a, float b)
+{
+    return std::fabs(a - b) <= 1e-4f * std::max(1.0f, std::fabs(b));
+}
+
+// Silence, then a burst of "speech", then silence — the shape trimming sees.
+static std::vector<float> makeSignal(size_t n, std::mt19937& rng)
+{
+    std::normal_distribution<float> noise(0.0f, 0.001f);
+    std::vector<float> x(n);
+    const size_t on = n / 5, off = n - n / 4;
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = noise(rng);
+        if (i >= on && i < off)
+            x[i] += 0.2f * std::sin(static_cast<float>(i) * 0.031f)
+                  * (0.5f + 0.5f * std::sin(static_cast<float>(i) * 0.0007f));
+    }
+    return x;
+}
+
+static void checkCorrectness(std::mt19937& rng)
+{
+    for (size_t n : { size_t{0}, size_t{1}, size_t{3}, size_t{7}, size_t{8}, size_t{15},
+                      size_t{17}, size_t{160}, size_t{481}, size_t{16000}, size_t{16003} }) {
+        std::vector<float> x = makeSignal(n, rng);
+        for (float thr : { 0.0f, 0.005f, 0.0065f, 0.15f, 10.0f }) {
+            expect(ak::findFirstAbove(x.data(), n, thr) == ak::scalar::findFirstAbove(x.data(), n, thr),
+                   "findFirstAbove", n);
+            expect(ak::findLastAbove(x.data(), n, thr) == ak::scalar::findLastAbove(x.data(), n, thr),
+                   "findLastAbove", n);
+            expect(ak::countAtOrAbove(x.data(), n, thr) == ak::scalar::countAtOrAbove(x.data(), n, thr),
+                   "countAtOrAbove", n);
+        }
+        expect(ak::countZeroCrossings(x.data(), n) == ak::scalar::countZeroCrossings(x.data(), n),
+               "countZeroCrossings", n);
+        expect(near(ak::sumSquares(x.data(), n), ak::scalar::sumSquares(x.data(), n)), "sumSquares", n);
+        if (n > 0)
+            expect(near(ak::dot(x.data(), x.data() + n / 2, n - n / 2),
+                        ak::scalar::dot(x.data(), x.data() + n / 2, n - n / 2)), "dot", n);
+        expect(ak::peakAbs(x.data(), n) == ak::scalar::peakAbs(x.data(), n), "peakAbs", n);
+
+        // int16 storage: identical to scalar, saturating, exact round trip.
+        {
+            std::vector<float> y = x;
+            if (n > 2) { y[0] = 1.5f; y[1] = -1.5f; y[2] = 0.5f / 32768.0f; }   // clip, clip, tie
+            std::vector<int16_t> a(n), b(n);
+            ak::floatToInt16(y.data(), n, a.data());
+            ak::scalar::floatToInt16(y.data(), n, b.data());
+            expect(a == b, "floatToInt16", n);
+            if (n > 2) expect(a[0] == 32767 && a[1] == -32768 && a[2] == 0, "floatToInt16 saturate/tie", n);
+            std::vector<float> f(n), g(n);
+            ak::int16ToFloat(a.data(), n, f.data());
+            ak::scalar::int16ToFloat(a.data(), n, g.data());
+            expect(f == g, "int16ToFloat", n);
+            std::vector<int16_t> c(n);
+            ak::floatToInt16(f.data(), n, c.data());
+            expect(a == c, "int16 round trip", n);
+        }
+
+        // A single loud sample at each edge must be found exactly.
+        if (n > 0) {
+            std::vector<float> edge(n, 0.0f);
+            edge[n - 1] = -0.5f;
+            expect(ak::findFirstAbove(edge.data(), n, 0.1f) == n - 1, "findFirstAbove edge", n);
+            expect(ak::findLastAbove(edge.data(), n, 0.1f) == n - 1, "findLastAbove edge", n);
+            edge[n - 1] = 0.0f;
+            edge[0]     = 0.5f;
+            expect(ak::findLastAbove(edge.data(), n, 0.1f) == 0, "findLastAbove first", n);
+        }
+    }
+}
+
+template <typename Fn>
+static double timeMs(Fn fn, int reps)
+{
+    const auto t0 = Clock::now();
+    for (int r = 0; r < reps; ++r) fn();
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count() / reps;
+}
+
+int main()
+{
+    std::mt19937 rng(1234);
+    checkCorrectness(rng);
+    std::printf("Correctness vs scalar: %s\n\n", g_failures == 0 ? "OK" : "FAILED");
+
+    std::printf("ISA: %s\n", ak::isaName());
+    std::printf("%6s  %-15s %10s %10s %8s\n", "len", "kernel", "scalar ms", "simd ms", "speedup");
+
+    volatile float  sinkF = 0.0f;
+    volatile size_t sinkN = 0;
+    for (size_t sec : { 1, 5, 15, 30, 60 }) {
+        const size_t n = 16000 * sec;
+        std::vector<float> x = makeSignal(n, rng);
+        const float* p = x.data();
+        const int reps = static_cast<int>(std::max<size_t>(3, 600 / sec));
+
+        auto row = [&](const char* name, auto scalarFn, auto simdFn) {
+            const double s = timeMs(scalarFn, reps);
+            const double v = timeMs(simdFn, reps);
+            std::printf("%4zus   %-15s %10.4f %10.4f %7.1fx\n", sec, name, s, v, s / v);
+        };
+        row("sumSquares",
+            [&] { sinkF = ak::scalar::sumSquares(p, n); },
+            [&] { sinkF = ak::sumSquares(p, n); });
+        row("dot",
+            [&] { sinkF = ak::scalar::dot(p, p + n / 2, n / 2); },
+            [&] { sinkF = ak::dot(p, p + n / 2, n / 2); });
+        row("peakAbs",
+            [&] { sinkF = ak::scalar::peakAbs(p, n); },
+            [&] { sinkF = ak::peakAbs(p, n); });
+        row("first+last>thr",
+            [&] { sinkN = ak::scalar::findFirstAbove(p, n, 0.005f) + ak::scalar::findLastAbove(p, n, 0.005f); },
+            [&] { sinkN = ak::findFirstAbove(p, n, 0.005f) + ak::findLastAbove(p, n, 0.005f); });
+        row("countAtOrAbove",
+            [&] { sinkN = ak::scalar::countAtOrAbove(p, n, 0.0065f); },
+            [&] { sinkN = ak::countAtOrAbove(p, n, 0.0065f); });
+        std::vector<int16_t> q(n);
+        std::vector<float>   back(n);
+        row("floatToInt16",
+            [&] { ak::scalar::floatToInt16(p, n, q.data()); },
+            [&] { ak::floatToInt16(p, n, q.data()); });
+        row("int16ToFloat",
+            [&] { ak::scalar::int16ToFloat(q.data(), n, back.data()); },
+            [&] { ak::int16ToFloat(q.data(), n, back.data()); });
+        row("zeroCrossings",
+            [&] { sinkN = ak::scalar::countZeroCrossings(p, n); },
+            [&] { sinkN = ak::countZeroCrossings(p, n); });
+    }
+    (void)sinkF; (void)sinkN;
+
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+// bench_cancel.cpp — how fast a cancelled or preempted transcription frees the CPU.
+//
+// whisper_full runs a ggml compute graph on n threads; the CPU backend
+// polls whisper_full_params::abort_callback between graph nodes (thread 0
+// checks, the rest see the flag at the next node barrier).  This bench runs
+// the same shape of work — n threads, a barrier per node, ~0.1-2 ms of
+// arithmetic per node — with CancelToken::abortCallback as the callback,
+// behind OrderedJobQueue and a worker loop like Transcriber's, and checks:
+//
+//   - cancel() of a running job: time from the request until every compute
+//     thread has stopped, for several node sizes;
+//   - cancel() of a queued job: completes at once with an empty result and
+//     without holding up (or jumping ahead of) its stream;
+//   - preemption: a background job yields to an interactive one, is queued
+//     again and completes once, with its result, afterwards;
+//   - close() aborts the running job so shutdown does not wait for it.
+//
+// Exits non-zero on any failed check.
+#include "bench_check.h"
+#include "ordered_job_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double msBetween(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+// ------------------------------------------------------------------
+// Stand-in for ggml_graph_compute on the CPU backend.
+// ------------------------------------------------------------------
+struct GraphRun {
+    bool              aborted = false;
+    Clock::time_point lastThreadStopped;
+};
+
+static volatile float g_sink = 0.0f;
+
+static GraphRun computeGraph(int threads, int nodes, int nodeWork, CancelToken& token)
+{
+    std::atomic<bool>             abort{false};
+    std::vector<Clock::time_point> stopped(threads);
+    std::barrier sync(threads);
+
+    auto body = [&](int ith) {
+        float acc = 0.0f;
+        for (int node = 0; node < nodes; ++node) {
+            for (int i = 0; i < nodeWork; ++i)
+                acc += std::sqrt(static_cast<float>(i + ith + node));
+            // ggml: thread 0 polls the callback; everyone stops at the barrier.
+            if (ith == 0 && CancelToken::abortCallback(&token)) abort.store(true);
+            sync.arrive_and_wait();
+            if (abort.load()) break;
+        }
+        g_sink = g_sink + acc;
+        stopped[ith] = Clock::now();
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(body, t);
+    body(0);
+    for (auto& t : pool) t.join();
+    return GraphRun{ abort.load(), *std::max_element(stopped.begin(), stopped.end()) };
+}
+
+// Work units that take about `ms` on one thread.
+static int calibrate(double ms)
+{
+    CancelToken idle;
+    const int probe = 200000;
+    const auto t0 = Clock::now();
+    computeGraph(1, 10, probe, idle);
+    const double perUnit = msBetween(t0, Clock::now()) / (10.0 * probe);
+    return std::max(1, static_cast<int>(ms / perUnit));
+}
+
+// ------------------------------------------------------------------
+// Worker loop shaped like Transcriber::workerLoop.
+// ------------------------------------------------------------------
+struct Work {
+    int nodes    = 0;
+    int nodeWork = 0;
+    std::string text;
+};
+using Queue = OrderedJobQueue<Work, std::string>;
+
+struct WorkerLog {
+    std::mutex                     m;
+    std::vector<uint64_t>          started;     // job ids, each (re)start
+    std::vector<Clock::time_point> startedAt;
+    std::vector<GraphRun>          runs;
+};
+
+static std::thread startWorker(Queue& q, int threads, WorkerLog& log)
+{
+    return std::thread([&q, threads, &log] {
+        Queue::Job job;
+        while (q.pop(job)) {
+            {
+                std::lock_guard<std::mutex> l(log.m);
+                log.started.push_back(job.id);
+                log.startedAt.push_back(Clock::now());
+            }
+            CancelToken& cancel = *job.cancel;
+            const GraphRun run = computeGraph(threads, job.payload.nodes, job.payload.nodeWork, cancel);
+            {
+                std::lock_guard<std::mutex> l(log.m);
+                log.runs.push_back(run);
+            }
+            std::string text = job.payload.text;
+            if (cancel.requested()) {
+                if (cancel.reason() == CancelToken::Reason::Preempted && q.requeue(job)) continue;
+                text.clear();
+            }
+            q.complete(job, std::move(text));
+        }
+    });
+}
+
+// ------------------------------------------------------------------
+
+static void cancelLatency(int threads)
+{
+    std::printf("Cancel a running job (%d compute threads)\n", threads);
+    std::printf("  %-12s %-14s %-14s %s\n", "node", "stop mean", "stop worst", "trials");
+    bool fast = true;
+    for (double nodeMs : { 0.1, 0.5, 2.0 }) {
+        const int work = calibrate(nodeMs);
+        double sum = 0.0, worst = 0.0;
+        constexpr int kTrials = 20;
+        for (int t = 0; t < kTrials; ++t) {
+            Queue q;
+            WorkerLog log;
+            std::thread worker = startWorker(q, threads, log);
+            std::atomic<int> delivered{0};
+            std::string result = "unset";
+            const uint64_t id = q.push(Work{ 100000, work, "text" },
+                [&](uint64_t, std::string r) { result = std::move(r); delivered.fetch_add(1); },
+                2, Clock::now(), 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5 + t % 7));
+            const auto asked = Clock::now();
+            q.cancel(id, std::string{});
+            q.waitIdle();
+            q.close();
+            worker.join();
+
+            const double ms = log.runs.empty() ? 1e9 : msBetween(asked, log.runs.back().lastThreadStopped);
+            sum  += ms;
+            worst = std::max(worst, ms);
+            fast &= delivered.load() == 1 && result.empty() && log.runs.back().aborted;
+        }
+        std::printf("  %6.1f ms    %8.2f ms    %8.2f ms    %d\n", nodeMs, sum / kTrials, worst, kTrials);
+        fast &= worst < nodeMs * 2.0 + 5.0;
+    }
+    expect(fast, "all threads stop within a node or two plus 5 ms");
+}
+
+static void cancelQueued(int threads)
+{
+    std::printf("\nCancel a queued job\n");
+    const int work = calibrate(0.5);
+    Queue q;
+    WorkerLog log;
+    std::vector<std::string> delivered;
+    std::mutex m;
+    auto record = [&](uint64_t, std::string r) { std::lock_guard<std::mutex> l(m); delivered.push_back(std::move(r)); };
+
+    std::thread worker = startWorker(q, threads, log);
+    q.push(Work{ 60, work, "first" }, record, 2, Clock::now(), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    const uint64_t second = q.push(Work{ 60, work, "second" }, record, 2, Clock::now(), 1);
+    q.push(Work{ 60, work, "third" }, record, 2, Clock::now(), 1);
+
+    const auto asked = Clock::now();
+    const bool ok = q.cancel(second, std::string{});
+    const double callMs = msBetween(asked, Clock::now());
+    size_t early = 0;
+    {
+        std::lock_guard<std::mutex> l(m);
+        early = delivered.size();
+    }
+    q.waitIdle();
+    q.close();
+    worker.join();
+
+    std::printf("  cancel() returned in %.3f ms\n", callMs);
+    expect(ok && early == 0, "queued job withdrawn without waiting for the stream");
+    expect(delivered == std::vector<std::string>({ "first", "", "third" }),
+           "completions in order: first, (cancelled), third");
+    expect(std::find(log.started.begin(), log.started.end(), second) == log.started.end(),
+           "cancelled job never ran");
+}
+
+static void preemption(int threads)
+{
+    std::printf("\nPreempt a background job\n");
+    const int work = calibrate(0.5);
+    Queue q;
+    WorkerLog log;
+    std::vector<std::pair<uint64_t, std::string>> delivered;
+    std::mutex m;
+    auto record = [&](uint64_t id, std::string r) { std::lock_guard<std::mutex> l(m); delivered.emplace_back(id, std::move(r)); };
+
+    std::thread worker = startWorker(q, threads, log);
+    const uint64_t bg = q.push(Work{ 400, work, "recovered" }, record, 0, Clock::now(), 1, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const auto pushed = Clock::now();
+    const uint64_t fg = q.push(Work{ 40, work, "dictation" }, record, 2, Clock::now(), 1, 0);
+    q.waitIdle();
+    q.close();
+    worker.join();
+
+    double startMs = -1.0;
+    for (size_t i = 0; i < log.started.size(); ++i)
+        if (log.started[i] == fg) startMs = msBetween(pushed, log.startedAt[i]);
+    std::printf("  interactive job started %.2f ms after it was queued\n", startMs);
+    std::printf("  start order:");
+    for (uint64_t id : log.started) std::printf(" %s", id == bg ? "bg" : "fg");
+    std::printf("\n");
+
+    expect(log.started == std::vector<uint64_t>({ bg, fg, bg }), "background yields, then runs again");
+    expect(startMs >= 0.0 && startMs < 10.0, "interactive job starts within 10 ms");
+    expect(delivered.size() == 2 && delivered[0] == std::make_pair(fg, std::string("dictation"))
+               && delivered[1] == std::make_pair(bg, std::string("recovered")),
+           "each completes once with its own result");
+}
+
+static void shutdown(int threads)
+{
+    std::printf("\nShut down with a job running\n");
+    const int work = calibrate(0.5);
+    Queue q;
+    WorkerLog log;
+    std::thread worker = startWorker(q, threads, log);
+    q.push(Work{ 100000, work, "long" }, nullptr, 2, Clock::now(), 1);
+    q.push(Work{ 100000, work, "queued" }, nullptr, 2, Clock::now(), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const auto asked = Clock::now();
+    q.close();
+    worker.join();
+    const double ms = msBetween(asked, Clock::now());
+    std::printf("  worker joined %.2f ms after close()\n", ms);
+    expect(ms < 10.0 && log.started.size() == 1, "close() aborts the running job, drops the queued one");
+}
+
+int main()
+{
+    const int threads = std::max(2, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    cancelLatency(threads);
+    cancelQueued(threads);
+    preemption(threads);
+    shutdown(threads);
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+// bench_capture_path.cpp — drives the full AudioManager capture path
+// (source -> ring -> consumer stage -> features/VAD -> page chain) from
+// the synthetic and file sources, no audio hardware needed.
+//
+//   bench_capture_path               built-in synthetic cases
+//   bench_capture_path clip.wav ...  also replay files as fast as possible
+//
+// Checks that every delivered sample arrives in the drained recording,
+// bit-exact and in order, with no drops, in fast and real-time modes, with
+// an armed pre-roll and with two instances capturing at once; that a
+// 4-channel array gets its quietest channel picked (or blended); that a
+// drop at the spill cap keeps interleaved channels in phase; and the
+// lengths through the resampler, denoiser and conditioning.  Exits
+// non-zero on any failure.
+#include "bench_check.h"
+#include "audio_manager.h"
+#include "audio_source.h"
+#include "audio_kernels.h"
+#include "capture_ring.h"
+#include "resampler.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <future>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// Everything a source produces, collected directly — the reference.
+static std::vector<float> collect(std::unique_ptr<AudioSource> src, uint32_t channels = 1)
+{
+    std::vector<float> out;
+    src->open(16000, channels, 30, [&](const float* x, size_t n) { out.insert(out.end(), x, x + n * channels); });
+    src->start();
+    while (!src->finished()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    src->stop();
+    src->close();
+    return out;
+}
+
+struct Run {
+    PcmChain pcm;
+    size_t   events  = 0;
+    size_t   preroll = 0;
+    double   wallMs  = 0.0;
+    double   startMs = 0.0;
+    int      dropped = 0;
+    std::vector<AudioManager::ChannelInfo> channels;
+};
+
+struct Options {
+    uint32_t                  rate      = 16000;
+    uint32_t                  channels  = 1;
+    size_t                    prerollMs = 0;
+    std::chrono::milliseconds armedFor{0};
+    bool                      denoise   = false;
+    bool                      condition = false;   // off: bit-exact comparison needs the raw samples
+    bool                      compact   = false;
+    ChannelMixer::Mode        mix       = ChannelMixer::Mode::Select;
+};
+
+static Run capture(std::unique_ptr<AudioSource> src, const Options& o = Options{})
+{
+    Run r;
+    AudioManager audio;
+    audio.setCaptureRate(o.rate);
+    audio.setCaptureChannels(o.channels);
+    audio.setChannelMode(o.mix);
+    audio.setNoiseSuppression(o.denoise);
+    audio.setConditioning(o.condition);
+    audio.setCompactPcm(o.compact);
+    audio.setPrerollMs(o.prerollMs);
+    audio.setVadCallback([&](VadEvent, size_t, uint32_t) { ++r.events; });
+    if (!audio.init(nullptr, std::move(src))) {
+        expect(false, "init");
+        return r;
+    }
+    std::this_thread::sleep_for(o.armedFor);
+
+    const auto t0 = Clock::now();
+    audio.startCapture();
+    while (!audio.sourceFinished()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    audio.stopCapture();
+    r.pcm      = audio.drainBuffer();
+    r.wallMs   = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    r.startMs  = audio.getStartLatencyMs();
+    r.preroll  = audio.getPrerollMs();
+    r.dropped  = audio.getDroppedSamples();
+    r.channels = audio.getChannelInfo();
+    audio.shutdown();
+    return r;
+}
+
+static bool sameSamples(const PcmChain& pcm, const float* ref, size_t n)
+{
+    if (pcm.size() != n) return false;
+    for (size_t i = 0; i < n; ++i)
+        if (pcm.at(i) != ref[i]) return false;
+    return true;
+}
+
+static void report(const char* name, const Run& r, double audioMs)
+{
+    std::printf("%-22s %8.0f ms audio  %8.1f ms wall  %6.1fx  start %6.2f ms  %zu VAD events\n",
+                name, audioMs, r.wallMs, audioMs / r.wallMs, r.startMs, r.events);
+}
+
+int main(int argc, char** argv)
+{
+    SyntheticSignal sig;
+    sig.totalMs = 30000;
+
+    {
+        const std::vector<float> ref = collect(makeSyntheticSource(sig, false));
+        const Run r = capture(makeSyntheticSource(sig, false));
+        report("synthetic, fast", r, ref.size() / 16.0);
+        expect(r.dropped == 0, "no drops");
+        expect(sameSamples(r.pcm, ref.data(), ref.size()), "recording matches source");
+        expect(r.events > 0, "VAD fired");
+    }
+    {
+        SyntheticSignal shortSig = sig;
+        shortSig.totalMs = 3000;
+        const std::vector<float> ref = collect(makeSyntheticSource(shortSig, false));
+        const Run r = capture(makeSyntheticSource(shortSig, true));
+        report("synthetic, real-time", r, ref.size() / 16.0);
+        expect(sameSamples(r.pcm, ref.data(), ref.size()), "recording matches source");
+        expect(r.wallMs > 2900.0, "paced like a device");
+    }
+    {
+        // Armed for 1 s before the "hotkey": the recording must start with
+        // the last 500 ms of pre-roll, directly followed by live samples.
+        SyntheticSignal armed = sig;
+        armed.totalMs = 4000;
+        const std::vector<float> ref = collect(makeSyntheticSource(armed, false));
+        Options o;
+        o.prerollMs = 500;
+        o.armedFor  = std::chrono::milliseconds(1000);
+        const Run r = capture(makeSyntheticSource(armed, true), o);
+        report("synthetic, armed 500ms", r, r.pcm.size() / 16.0);
+        expect(r.preroll == 500, "500 ms pre-roll stitched");
+        const size_t skipped = ref.size() - r.pcm.size();
+        expect(r.pcm.size() <= ref.size() && sameSamples(r.pcm, ref.data() + skipped, r.pcm.size()),
+               "pre-roll contiguous with live audio");
+    }
+
+    {
+        // Native 48 kHz through the consumer-side resampler: every second of
+        // input must come out as one second at 16 kHz, plus the filter delay
+        // — its tail is flushed on drain, so nothing at the end is lost.
+        Options o;
+        o.rate = 0;
+        const Run r = capture(makeSyntheticSource(sig, false), o);
+        report("synthetic 48k, fast", r, r.pcm.size() / 16.0);
+        const size_t delay = static_cast<size_t>(std::ceil(Resampler(48000, 16000).delay()));
+        expect(r.dropped == 0, "no drops");
+        expect(r.pcm.size() == 16000 * 30 + delay, "resampled length");
+    }
+
+    {
+        // Denoiser in the consumer stage: one 10 ms hop of delay, nothing lost.
+        Options o;
+        o.denoise = true;
+        const Run r = capture(makeSyntheticSource(sig, false), o);
+        report("synthetic, denoised", r, r.pcm.size() / 16.0);
+        expect(r.pcm.size() == 16000 * 30 + NoiseSuppressor::kHop, "denoised length");
+    }
+
+    {
+        // Full chain: high-pass, denoise, look-ahead AGC.  The AGC's delay
+        // line is flushed on drain, so only the denoiser's hop is added.
+        Options o;
+        o.denoise   = true;
+        o.condition = true;
+        const Run r = capture(makeSyntheticSource(sig, false), o);
+        report("synthetic, conditioned", r, r.pcm.size() / 16.0);
+        expect(r.pcm.size() == 16000 * 30 + NoiseSuppressor::kHop, "conditioned length");
+    }
+
+    {
+        // int16 ring and pages: the recording is the source quantised once,
+        // exactly — no second rounding on the way out.
+        std::vector<float> ref = collect(makeSyntheticSource(sig, false));
+        std::vector<int16_t> q(ref.size());
+        audio_kernels::floatToInt16(ref.data(), ref.size(), q.data());
+        audio_kernels::int16ToFloat(q.data(), q.size(), ref.data());
+        Options o;
+        o.compact = true;
+        const Run r = capture(makeSyntheticSource(sig, false), o);
+        report("synthetic, compact", r, ref.size() / 16.0);
+        expect(r.pcm.format() == PcmFormat::Int16 && r.pcm.bytes() * 2 <= 16000 * 30 * sizeof(float) + PcmPage::kBytes,
+               "int16 pages, half the bytes");
+        std::vector<float> back(r.pcm.size());
+        r.pcm.copyTo(back.data(), 0, back.size());
+        expect(back == ref, "recording matches quantised source");
+    }
+
+    {
+        // Two managers at once, each with its own ring: neither sees the
+        // other's samples.
+        const std::vector<float> ref = collect(makeSyntheticSource(sig, false));
+        SyntheticSignal other = sig;
+        other.seed = 2;
+        const std::vector<float> refOther = collect(makeSyntheticSource(other, false));
+        auto a = std::async(std::launch::async, [&] { return capture(makeSyntheticSource(sig, false)); });
+        auto b = std::async(std::launch::async, [&] { return capture(makeSyntheticSource(other, false)); });
+        const Run ra = a.get(), rb = b.get();
+        report("two instances", ra, ref.size() / 16.0);
+        expect(sameSamples(ra.pcm, ref.data(), ref.size())
+               && sameSamples(rb.pcm, refOther.data(), refOther.size()), "both recordings match their source");
+    }
+
+    {
+        // 4-mic array, channel 2 quietest (6 dB per channel away from it):
+        // Select must settle on channel 2 and then record it bit-exact.
+        SyntheticSignal array = sig;
+        array.channels    = 4;
+        array.bestChannel = 2;
+        const std::vector<float> ref = collect(makeSyntheticSource(array, false), 4);
+        const Run r = capture(makeSyntheticSource(array, false), Options{ 16000, 0 });
+        report("4-ch array, select", r, r.pcm.size() / 16.0);
+        for (const AudioManager::ChannelInfo& c : r.channels)
+            std::printf("    SNR %5.1f dB  weight %.2f\n", c.snrDb, c.weight);
+        const size_t frames = ref.size() / 4;
+        bool tail = r.pcm.size() == frames;
+        for (size_t i = frames / 2; tail && i < frames; ++i) tail = r.pcm.at(i) == ref[i * 4 + 2];
+        expect(r.channels.size() == 4 && r.channels[2].weight == 1.0f, "channel 2 selected");
+        expect(tail, "second half is channel 2, bit-exact");
+
+        Options blend{ 16000, 0 };
+        blend.mix = ChannelMixer::Mode::Blend;
+        const Run rb = capture(makeSyntheticSource(array, false), blend);
+        report("4-ch array, blend", rb, rb.pcm.size() / 16.0);
+        for (const AudioManager::ChannelInfo& c : rb.channels)
+            std::printf("    SNR %5.1f dB  weight %.2f\n", c.snrDb, c.weight);
+        float sum = 0.0f;
+        for (const AudioManager::ChannelInfo& c : rb.channels) sum += c.weight;
+        expect(rb.channels.size() == 4 && std::fabs(sum - 1.0f) < 1e-5f && rb.channels[0].weight == 0.0f
+               && rb.channels[2].weight > rb.channels[1].weight && rb.channels[2].weight > rb.channels[3].weight,
+               "blend weights favour channel 2, drop channel 0 (-12 dB)");
+    }
+
+    {
+        // Spill cap hit in the middle of a 3-channel frame (a 1 s page is
+        // not a whole number of frames): after the gap, every stored
+        // sample must still sit on its own channel's position.
+        CaptureRing ring(1600, CaptureRing::kPageFrames, 3);
+        std::vector<float> period(480 * 3);
+        size_t frame = 0;
+        auto write = [&](int periods) {
+            for (int p = 0; p < periods; ++p) {
+                for (size_t f = 0; f < 480; ++f, ++frame)
+                    for (size_t c = 0; c < 3; ++c) period[f * 3 + c] = static_cast<float>(frame * 4 + c);
+                ring.write(period.data(), period.size());
+            }
+        };
+        std::vector<float> out;
+        auto drain = [&] {
+            std::vector<float> buf(ring.readAvailable());
+            out.insert(out.end(), buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(ring.read(buf.data(), buf.size())));
+        };
+        write(20);   // 28800 samples into 17600 of storage
+        drain();
+        write(5);
+        ring.flushSpill();
+        drain();
+        bool inPhase = out.size() % 3 == 0;
+        for (size_t i = 0; inPhase && i < out.size(); ++i)
+            inPhase = static_cast<size_t>(out[i]) % 4 == i % 3;
+        std::printf("  3-ch drop at the cap: %zu samples kept, %zu gap(s)\n", out.size(), ring.gaps().size());
+        expect(!ring.gaps().empty(), "3-ch cap: the drop is reported");
+        expect(inPhase, "3-ch cap: channels stay in phase after the gap");
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        const std::vector<float> ref = collect(makeFileSource(argv[i], false));
+        const Run r = capture(makeFileSource(argv[i], false), Options{ 16000, 1 });
+        report(argv[i], r, ref.size() / 16.0);
+        expect(sameSamples(r.pcm, ref.data(), ref.size()), "recording matches file");
+    }
+
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+// bench_capture_ring.cpp — CaptureRing vs the old per-sample g_ring.
+//
+// Simulates 15 s of 16 kHz capture delivered in 30 ms callback periods
+// (the device config in audio_manager.cpp), then drains it the way
+// AudioManager::drainBuffer does.  Reports mean/worst callback time and
+// total drain time for both queues.
+//
+//   cmake -B build -DFLOWON_BUILD_BENCHMARKS=ON
+//   cmake --build build --config Release --target bench_capture_ring
+#include "capture_ring.h"
+#include "readerwriterqueue.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr size_t kRate       = 16000;
+static constexpr size_t kPeriod     = 480;          // 30 ms
+static constexpr size_t kSeconds    = 15;
+static constexpr size_t kTotal      = kRate * kSeconds;
+static constexpr int    kIterations = 20;
+
+struct Result {
+    double cbMeanUs  = 0.0;
+    double cbWorstUs = 0.0;
+    double drainMs   = 0.0;
+};
+
+static double usSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+}
+
+template <typename PushFn, typename DrainFn>
+static Result run(const std::vector<float>& pcm, PushFn push, DrainFn drain)
+{
+    Result r;
+    for (int it = 0; it < kIterations; ++it) {
+        double sum = 0.0, worst = 0.0;
+        size_t periods = 0;
+        for (size_t off = 0; off < kTotal; off += kPeriod, ++periods) {
+            const auto t0 = Clock::now();
+            push(pcm.data() + off, kPeriod);
+            const double us = usSince(t0);
+            sum  += us;
+            worst = us > worst ? us : worst;
+        }
+
+        std::vector<float> out;
+        out.reserve(kTotal);
+        const auto t0 = Clock::now();
+        drain(out);
+        const double ms = usSince(t0) / 1000.0;
+
+        if (out.size() != kTotal) {
+            std::printf("  ERROR: drained %zu of %zu samples\n", out.size(), kTotal);
+        }
+
+        r.cbMeanUs  += sum / static_cast<double>(periods);
+        r.cbWorstUs  = worst > r.cbWorstUs ? worst : r.cbWorstUs;
+        r.drainMs   += ms;
+    }
+    r.cbMeanUs /= kIterations;
+    r.drainMs  /= kIterations;
+    return r;
+}
+
+static void print(const char* name, const Result& r)
+{
+    std::printf("%-28s callback mean %7.3f us  worst %8.3f us  drain %8.3f ms\n",
+                name, r.cbMeanUs, r.cbWorstUs, r.drainMs);
+}
+
+int main()
+{
+    std::vector<float> pcm(kTotal);
+    for (size_t i = 0; i < kTotal; ++i)
+        pcm[i] = 0.1f * std::sin(static_cast<float>(i) * 0.05f);
+
+    std::printf("15 s @ 16 kHz, %zu-frame periods, %d iterations\n\n", kPeriod, kIterations);
+
+    {
+        moodycamel::ReaderWriterQueue<float> q(kTotal);
+        const Result r = run(pcm,
+            [&](const float* d, size_t n) {
+                for (size_t i = 0; i < n; ++i) q.try_enqueue(d[i]);
+            },
+            [&](std::vector<float>& out) {
+                float s;
+                while (q.try_dequeue(s)) out.push_back(s);
+            });
+        print("ReaderWriterQueue<float>", r);
+    }
+
+    {
+        CaptureRing ring(kTotal);
+        const Result r = run(pcm,
+            [&](const float* d, size_t n) { ring.write(d, n); },
+            [&](std::vector<float>& out) {
+                const size_t avail = ring.readAvailable();
+                out.resize(avail);
+                out.resize(ring.read(out.data(), avail));
+            });
+        print("CaptureRing", r);
+    }
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+// bench_check.h — pass/fail bookkeeping shared by the bench programs.
+//
+// Each check prints one line; a bench counts its failures in g_failures
+// and exits non-zero when there were any.
+#include <cstddef>
+#include <cstdio>
+
+inline int g_failures = 0;
+
+inline void expect(bool ok, const char* what)
+{
+    std::printf("  %-60s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) ++g_failures;
+}
+
+// For a check repeated over many input sizes: prints only the failures.
+inline void expect(bool ok, const char* what, size_t n)
+{
+    if (!ok) {
+        std::printf("  MISMATCH: %s (n=%zu)\n", what, n);
+        ++g_failures;
+    }
+}
@@ -0,0 +1,237 @@
+// bench_idle_tiers.cpp — memory and first-token latency of the two idle-unload tiers.
+//
+//   bench_idle_tiers model.bin speech.wav
+//
+// Transcriber::unloadIfIdle frees the workers' whisper_states (KV caches
+// and compute buffers) after a short idle and the weights after a long
+// one.  This loads the model the way Transcriber does (weights with
+// whisper_init_from_file_with_params_no_state, a state per worker) and
+// prints the process memory at each step:
+//
+//   baseline       nothing loaded
+//   weights        context only
+//   + state        one whisper_state
+//   transcribed    after a job (buffers touched)
+//   state freed    tier 1
+//   weights freed  tier 2
+//
+// then the time from job start to the first token (the first logits
+// filter call) when everything is warm, after tier 1 (state re-created
+// first) and after tier 2 (weights reloaded first), with the transcript
+// of each.  Without a model and a clip, nothing is measured.
+// Exits non-zero if a check fails.
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "bench_check.h"
+#include "decode_params.h"
+#include "whisper.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+static double msBetween(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+// ------------------------------------------------------------------
+// Process memory, MB: resident set and private (anonymous) memory —
+// the part an unload can actually give back.
+// ------------------------------------------------------------------
+struct MemoryUse {
+    double resident = 0.0;
+    double priv     = 0.0;
+};
+
+static MemoryUse memoryUse()
+{
+    MemoryUse m;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS_EX pmc{};
+    pmc.cb = sizeof(pmc);
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof(pmc))) {
+        m.resident = pmc.WorkingSetSize / 1048576.0;
+        m.priv     = pmc.PrivateUsage / 1048576.0;
+    }
+#else
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        unsigned long size = 0, resident = 0;
+        if (std::fscanf(f, "%lu %lu", &size, &resident) == 2)
+            m.resident = static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / 1048576.0;
+        std::fclose(f);
+    }
+    if (FILE* f = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        unsigned long kb = 0;
+        while (std::fgets(line, sizeof(line), f))
+            if (std::sscanf(line, "RssAnon: %lu kB", &kb) == 1) m.priv = kb / 1024.0;
+        std::fclose(f);
+    }
+#endif
+    return m;
+}
+
+static void printMemory(const char* step, const MemoryUse& m, const MemoryUse& base)
+{
+    std::printf("  %-14s %9.1f MB %9.1f MB %+10.1f MB\n", step, m.resident, m.priv, m.priv - base.priv);
+}
+
+// ------------------------------------------------------------------
+// Whisper
+// ------------------------------------------------------------------
+
+static bool loadClip(const char* path, std::vector<float>& pcm)
+{
+    ma_decoder_config cfg = ma_decoder_config_init(ma_format_f32, 1, 16000);
+    ma_uint64 frames = 0;
+    void* data = nullptr;
+    if (ma_decode_file(path, &cfg, &frames, &data) != MA_SUCCESS) return false;
+    pcm.assign(static_cast<float*>(data), static_cast<float*>(data) + frames);
+    ma_free(data, nullptr);
+    return true;
+}
+
+struct Tiers {
+    const char*            modelPath;
+    whisper_context_params cp;
+    whisper_context*       ctx   = nullptr;
+    whisper_state*         state = nullptr;
+};
+
+struct JobResult {
+    double      restoreMs    = 0.0;   // weights and/or state rebuilt first
+    double      firstTokenMs = 0.0;   // job start to first token
+    double      totalMs      = 0.0;
+    std::string text;
+};
+
+// One job as Transcriber's worker runs it: rebuild what the idle unload
+// freed, then whisper_full_with_state.
+static JobResult job(Tiers& t, const std::vector<float>& clip)
+{
+    JobResult r;
+    const auto start = Clock::now();
+    if (!t.ctx)   t.ctx   = whisper_init_from_file_with_params_no_state(t.modelPath, t.cp);
+    if (t.ctx && !t.state) t.state = whisper_init_state(t.ctx);
+    r.restoreMs = msBetween(start, Clock::now());
+    if (!t.state) return r;
+
+    Clock::time_point firstToken{};
+    whisper_full_params p = clipDecodeParams(clip.size(), 1);
+    p.logits_filter_callback = [](whisper_context*, whisper_state*, const whisper_token_data*, int,
+                                  float*, void* user) {
+        auto* at = static_cast<Clock::time_point*>(user);
+        if (*at == Clock::time_point{}) *at = Clock::now();
+    };
+    p.logits_filter_callback_user_data = &firstToken;
+    whisper_full_with_state(t.ctx, t.state, p, clip.data(), static_cast<int>(clip.size()));
+    r.totalMs      = msBetween(start, Clock::now());
+    r.firstTokenMs = firstToken == Clock::time_point{} ? r.totalMs : msBetween(start, firstToken);
+    for (int i = 0; i < whisper_full_n_segments_from_state(t.state); ++i)
+        r.text += whisper_full_get_segment_text_from_state(t.state, i);
+    return r;
+}
+
+static void freeState(Tiers& t)
+{
+    if (t.state) whisper_free_state(t.state);
+    t.state = nullptr;
+}
+
+static void freeWeights(Tiers& t)
+{
+    freeState(t);
+    if (t.ctx) whisper_free(t.ctx);
+    t.ctx = nullptr;
+}
+
+static void measure(const char* modelPath, const char* clipPath)
+{
+    std::vector<float> clip;
+    if (!loadClip(clipPath, clip)) {
+        std::printf("cannot decode %s\n", clipPath);
+        ++g_failures;
+        return;
+    }
+
+    Tiers t{ modelPath, whisper_context_default_params() };
+    t.cp.use_gpu    = false;
+    t.cp.flash_attn = true;
+
+    std::printf("Memory, %s\n", modelPath);
+    std::printf("  %-14s %12s %12s %13s\n", "step", "resident", "private", "vs baseline");
+    const MemoryUse base = memoryUse();
+    printMemory("baseline", base, base);
+    t.ctx = whisper_init_from_file_with_params_no_state(modelPath, t.cp);
+    if (!t.ctx) {
+        std::printf("cannot load %s\n", modelPath);
+        ++g_failures;
+        return;
+    }
+    const MemoryUse weights = memoryUse();
+    printMemory("weights", weights, base);
+    t.state = whisper_init_state(t.ctx);
+    printMemory("+ state", memoryUse(), base);
+    const JobResult warmUp = job(t, clip);
+    const MemoryUse busy = memoryUse();
+    printMemory("transcribed", busy, base);
+    freeState(t);
+    const MemoryUse tier1 = memoryUse();
+    printMemory("state freed", tier1, base);
+    freeWeights(t);
+    const MemoryUse tier2 = memoryUse();
+    printMemory("weights freed", tier2, base);
+
+    // First-token latency: hot, after tier 1, after tier 2.  Each is the
+    // best of three so a stray page fault does not decide the row.
+    auto best = [&](auto evict) {
+        JobResult r;
+        r.firstTokenMs = 1e30;
+        for (int i = 0; i < 3; ++i) {
+            evict();
+            const JobResult one = job(t, clip);
+            if (one.firstTokenMs < r.firstTokenMs) r = one;
+        }
+        return r;
+    };
+    job(t, clip);   // reload after the memory walk
+    const JobResult hot   = best([] {});
+    const JobResult warm  = best([&] { freeState(t); });
+    const JobResult cold  = best([&] { freeWeights(t); });
+    freeWeights(t);
+
+    std::printf("\nFirst token, %s (%.1f s)\n", clipPath, clip.size() / 16000.0);
+    std::printf("  %-22s %10s %12s %10s\n", "before the job", "restore", "first token", "total");
+    auto row = [](const char* what, const JobResult& r) {
+        std::printf("  %-22s %7.0f ms %9.0f ms %7.0f ms\n", what, r.restoreMs, r.firstTokenMs, r.totalMs);
+    };
+    row("warm", hot);
+    row("state freed (tier 1)", warm);
+    row("weights freed (tier 2)", cold);
+
+    expect(tier1.priv < busy.priv, "freeing the state gives memory back");
+    expect(tier2.priv < tier1.priv, "freeing the weights gives more back");
+    expect(warm.firstTokenMs <= cold.firstTokenMs, "first token after tier 1 beats a full reload");
+    expect(hot.text == warmUp.text && warm.text == warmUp.text && cold.text == warmUp.text,
+           "same transcript after each kind of eviction");
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 3) measure(argv[1], argv[2]);
+    else std::printf("(no model and clip given: nothing measured)\n");
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
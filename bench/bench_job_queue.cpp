@@ -0,0 +1,172 @@
+// bench_job_queue.cpp — the transcription job queue against the old single-flight guard.
+//
+// A stand-in worker "transcribes" each job by sleeping for a time
+// proportional to its audio length (Whisper-like real-time factor, scaled
+// down so the run takes about a second).  Checks, without a model:
+//
+//   - a burst of dictations with mixed lengths: every one completes exactly
+//     once, completions arrive in submission order, and within a priority
+//     shorter utterances are started first;
+//   - a background job on its own stream yields to interactive ones and
+//     does not hold up their completions;
+//   - dictations arriving faster than they are transcribed: the old
+//     reject-while-busy guard drops some, the queue drops none.
+//
+// Exits non-zero on any failed check.
+#include "bench_check.h"
+#include "ordered_job_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Utterance {
+    int    tag     = 0;
+    size_t samples = 0;   // 16 kHz
+};
+using Queue = OrderedJobQueue<Utterance, int>;
+
+static constexpr double kRtf = 0.004;   // bench seconds of work per second of audio
+
+static std::chrono::microseconds workFor(size_t samples)
+{
+    return std::chrono::microseconds(static_cast<long long>(samples / 16000.0 * kRtf * 1e6));
+}
+
+static Clock::time_point deadlineFor(Clock::time_point now, size_t samples)
+{
+    // Same rule as Transcriber::submit: 1.5 s + half the audio length.
+    return now + std::chrono::milliseconds(1500) + std::chrono::milliseconds(samples / 32);
+}
+
+// Runs one worker until the queue is closed; records the start order.
+static std::thread startWorker(Queue& q, std::vector<int>& started, std::mutex& m)
+{
+    return std::thread([&q, &started, &m] {
+        Queue::Job job;
+        while (q.pop(job)) {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                started.push_back(job.payload.tag);
+            }
+            std::this_thread::sleep_for(workFor(job.payload.samples));
+            const int tag = job.payload.tag;
+            q.complete(job, tag);
+        }
+    });
+}
+
+static void burst()
+{
+    std::printf("Burst of 8 dictations + 1 background job\n");
+    Queue q;
+    std::vector<int> started, delivered, background;
+    std::mutex m;
+
+    // Hold the worker on a first job so the rest queue up behind it.
+    const size_t lengths[] = { 16000 * 6, 16000 * 20, 16000 * 2, 16000 * 9,
+                               16000 * 1, 16000 * 14, 16000 * 3, 16000 * 5 };
+    auto record = [&](std::vector<int>& into) {
+        return [&into, &m](uint64_t, int tag) { std::lock_guard<std::mutex> l(m); into.push_back(tag); };
+    };
+    const auto t0 = Clock::now();
+    q.push(Utterance{ 0, lengths[0] }, record(delivered), 2, deadlineFor(t0, lengths[0]), lengths[0]);
+    std::thread worker = startWorker(q, started, m);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    q.push(Utterance{ 100, 16000 * 30 }, record(background), 0, deadlineFor(t0, 16000 * 30), 16000 * 30, 1);
+    for (int i = 1; i < 8; ++i)
+        q.push(Utterance{ i, lengths[i] }, record(delivered), 2, deadlineFor(t0, lengths[i]), lengths[i]);
+
+    q.waitIdle();
+    q.close();
+    worker.join();
+
+    expect(delivered.size() == 8 && background.size() == 1, "every job completed exactly once");
+    bool inOrder = true;
+    for (int i = 0; i < static_cast<int>(delivered.size()); ++i) inOrder &= delivered[i] == i;
+    expect(inOrder, "dictation completions in submission order");
+    // After the first job: 1 s, 2 s, 3 s, 5 s, 9 s, 14 s, 20 s, then background.
+    const std::vector<int> expectStart = { 0, 4, 2, 6, 7, 3, 5, 1, 100 };
+    expect(started == expectStart, "short first within a priority; background last");
+    std::printf("  start order:");
+    for (int t : started) std::printf(" %d", t);
+    std::printf("\n");
+}
+
+static void arrivals()
+{
+    std::printf("\nDictations arriving faster than they are transcribed\n");
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<size_t> len(16000 * 1, 16000 * 12);
+    std::exponential_distribution<double> gapMs(1.0 / 20.0);   // mean 20 ms apart
+
+    constexpr int kJobs = 40;
+    std::vector<size_t>  sizes(kJobs);
+    std::vector<double>  gaps(kJobs);
+    for (int i = 0; i < kJobs; ++i) { sizes[i] = len(rng); gaps[i] = gapMs(rng); }
+
+    // Old behaviour: one job at a time, anything arriving meanwhile is rejected.
+    int rejected = 0;
+    {
+        std::atomic<bool> busy{false};
+        std::vector<std::thread> jobs;
+        for (int i = 0; i < kJobs; ++i) {
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(gaps[i] * 1000)));
+            bool expected = false;
+            if (!busy.compare_exchange_strong(expected, true)) { ++rejected; continue; }
+            jobs.emplace_back([&busy, s = sizes[i]] {
+                std::this_thread::sleep_for(workFor(s));
+                busy.store(false);
+            });
+        }
+        for (auto& t : jobs) t.join();
+    }
+
+    // Queue: everything is accepted and comes back in order.
+    Queue q;
+    std::vector<int> started, delivered;
+    std::vector<double> waitMs;
+    std::mutex m;
+    std::thread worker = startWorker(q, started, m);
+    std::vector<Clock::time_point> submitted(kJobs);
+    for (int i = 0; i < kJobs; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(gaps[i] * 1000)));
+        submitted[i] = Clock::now();
+        q.push(Utterance{ i, sizes[i] }, [&, i](uint64_t, int tag) {
+            std::lock_guard<std::mutex> l(m);
+            delivered.push_back(tag);
+            waitMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - submitted[i]).count());
+        }, 2, deadlineFor(submitted[i], sizes[i]), sizes[i]);
+    }
+    q.waitIdle();
+    q.close();
+    worker.join();
+
+    bool inOrder = delivered.size() == kJobs;
+    for (int i = 0; inOrder && i < kJobs; ++i) inOrder = delivered[i] == i;
+    double mean = 0.0, worst = 0.0;
+    for (double w : waitMs) { mean += w; worst = std::max(worst, w); }
+    mean /= std::max<size_t>(1, waitMs.size());
+
+    std::printf("  single-flight guard: %d of %d dictations rejected (\"Busy, try again\")\n", rejected, kJobs);
+    std::printf("  job queue:           %zu of %d completed in order, submit->result mean %.1f ms, worst %.1f ms\n",
+                delivered.size(), kJobs, mean, worst);
+    expect(rejected > 0, "load is high enough that the old guard rejects");
+    expect(inOrder, "queue completes every dictation, in order");
+}
+
+int main()
+{
+    burst();
+    arrivals();
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
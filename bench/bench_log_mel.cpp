@@ -0,0 +1,329 @@
+// bench_log_mel.cpp — incremental log-mel spectrogram vs whisper.cpp's.
+//
+//   bench_log_mel                        checks and timing
+//   bench_log_mel model.bin speech.wav   also the handoff to a real model
+//
+// Checks: LogMelSpectrogram fed in blocks matches a direct-DFT port of
+// whisper.cpp's whole-clip log_mel_spectrogram() (reflect pad, periodic
+// Hann, power spectrum, mel filterbank, log10, max - 8 clamp, (x + 4) / 4),
+// is identical for every block size, and a trimmed extract() matches the
+// reference run on the trimmed clip away from its edges.
+//
+// Timing: what is left at release (finish() + extract()) against
+// computing the whole clip's spectrogram then, which is what whisper_full
+// does today.  With a model and a recording (any file miniaudio decodes),
+// whisper_pcm_to_mel() is timed against extract() + whisper_set_mel(), and
+// the clip is transcribed both ways.
+// Exits non-zero if a check fails.
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "bench_check.h"
+#include "decode_params.h"
+#include "log_mel.h"
+#include "whisper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+// Voiced-ish test signal: harmonic stacks with a wandering pitch and
+// syllable envelope, over low noise, with silence at both ends.
+static std::vector<float> speechLike(double seconds, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 0.002f);
+    const size_t n = static_cast<size_t>(seconds * 16000);
+    std::vector<float> x(n);
+    double phase = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const double t  = static_cast<double>(i) / 16000.0;
+        const double f0 = 140.0 + 30.0 * std::sin(2.0 * 3.14159265 * 0.7 * t);
+        phase += 2.0 * 3.14159265 * f0 / 16000.0;
+        const bool voiced = t > 0.4 && t < seconds - 0.4;
+        const double env = voiced ? 0.5 + 0.5 * std::sin(2.0 * 3.14159265 * 4.0 * t) : 0.0;
+        double v = 0.0;
+        for (int h = 1; h <= 12; ++h) v += std::sin(phase * h) / h;
+        x[i] = static_cast<float>(0.15 * env * v) + noise(rng);
+    }
+    return x;
+}
+
+// ------------------------------------------------------------------
+// Reference: whisper.cpp's log_mel_spectrogram(), whole clip, direct DFT
+// in double precision.  Output is mel-major, nMel x nLen.
+// ------------------------------------------------------------------
+static std::vector<float> referenceMel(const float* x, size_t n, size_t nMel, size_t& nLen)
+{
+    constexpr size_t kFft = 400, kHop = 160, kPad = 200, kBins = 201;
+    std::vector<double> padded(n + 16000 * 30 + 2 * kPad, 0.0);
+    for (size_t i = 0; i < n; ++i) padded[kPad + i] = x[i];
+    for (size_t k = 0; k < kPad; ++k) padded[k] = x[kPad - k];   // reflect
+    nLen = (padded.size() - kFft) / kHop;
+
+    const std::vector<float> filters = LogMelSpectrogram::filterbank(nMel);
+    std::vector<double> cosT(kFft), sinT(kFft), hann(kFft);
+    for (size_t j = 0; j < kFft; ++j) {
+        cosT[j] = std::cos(2.0 * 3.141592653589793 * j / kFft);
+        sinT[j] = std::sin(2.0 * 3.141592653589793 * j / kFft);
+        hann[j] = 0.5 - 0.5 * cosT[j];
+    }
+
+    std::vector<float> mel(nMel * nLen);
+    std::vector<double> frame(kFft), power(kBins);
+    const float silent = -10.0f;
+    for (size_t f = 0; f < nLen; ++f) {
+        bool any = false;
+        for (size_t j = 0; j < kFft; ++j) {
+            frame[j] = padded[f * kHop + j] * hann[j];
+            any |= frame[j] != 0.0;
+        }
+        if (!any) {   // pure padding
+            for (size_t b = 0; b < nMel; ++b) mel[b * nLen + f] = silent;
+            continue;
+        }
+        for (size_t k = 0; k < kBins; ++k) {
+            double re = 0.0, im = 0.0;
+            for (size_t j = 0; j < kFft; ++j) {
+                const size_t a = (k * j) % kFft;
+                re += frame[j] * cosT[a];
+                im -= frame[j] * sinT[a];
+            }
+            power[k] = re * re + im * im;
+        }
+        for (size_t b = 0; b < nMel; ++b) {
+            double sum = 0.0;
+            for (size_t k = 0; k < kBins; ++k) sum += filters[b * kBins + k] * power[k];
+            mel[b * nLen + f] = static_cast<float>(std::log10(std::max(sum, 1e-10)));
+        }
+    }
+    float peak = -1e30f;
+    for (float v : mel) peak = std::max(peak, v);
+    for (float& v : mel) v = (std::max(v, peak - 8.0f) + 4.0f) / 4.0f;
+    return mel;
+}
+
+static std::vector<float> incrementalMel(const std::vector<float>& x, size_t block, size_t nMel,
+                                         size_t begin, size_t end, size_t& nLen)
+{
+    LogMelSpectrogram mel(nMel);
+    for (size_t i = 0; i < x.size(); i += block)
+        mel.push(x.data() + i, std::min(block, x.size() - i));
+    mel.finish();
+    std::vector<float> out;
+    nLen = mel.extract(begin, end, out);
+    return out;
+}
+
+// Largest difference over frames [from, to) of two mel-major spectrograms.
+static float maxDiff(const std::vector<float>& a, const std::vector<float>& b, size_t nMel,
+                     size_t nLen, size_t from, size_t to)
+{
+    float worst = 0.0f;
+    for (size_t m = 0; m < nMel; ++m)
+        for (size_t f = from; f < to; ++f)
+            worst = std::max(worst, std::fabs(a[m * nLen + f] - b[m * nLen + f]));
+    return worst;
+}
+
+static void accuracyChecks()
+{
+    std::printf("Accuracy (5 s speech-like clip)\n");
+    const std::vector<float> x = speechLike(5.0, 7);
+
+    for (size_t nMel : { size_t{80}, size_t{128} }) {
+        size_t refLen = 0, len = 0;
+        const std::vector<float> ref = referenceMel(x.data(), x.size(), nMel, refLen);
+        const std::vector<float> inc = incrementalMel(x, 160, nMel, 0, x.size(), len);
+        const float d = len == refLen ? maxDiff(ref, inc, nMel, len, 0, len) : 1e9f;
+        char what[96];
+        std::snprintf(what, sizeof(what), "%zu bands match whisper.cpp (max diff %.1e)",
+                      nMel, static_cast<double>(d));
+        expect(len == refLen && d < 2e-3f, what);
+    }
+
+    size_t len160 = 0;
+    const std::vector<float> base = incrementalMel(x, 160, 80, 0, x.size(), len160);
+    bool same = true;
+    for (size_t block : { size_t{1}, size_t{37}, size_t{480}, size_t{4096}, x.size() }) {
+        size_t len = 0;
+        same &= incrementalMel(x, block, 80, 0, x.size(), len) == base && len == len160;
+    }
+    expect(same, "identical for block sizes 1, 37, 480, 4096 and whole clip");
+
+    // Trimmed to [0.3 s, 4.7 s) like trimSilence() would: the reference
+    // runs on the trimmed clip itself.  Edge frames see real neighbours
+    // instead of padding; compare from the third frame to three before
+    // the end of the audio.
+    const size_t b = 4800 + 37, e = 75200;
+    const size_t aligned = b / 160 * 160;
+    size_t refLen = 0, len = 0;
+    const std::vector<float> ref = referenceMel(x.data() + aligned, e - aligned, 80, refLen);
+    const std::vector<float> inc = incrementalMel(x, 160, 80, b, e, len);
+    const size_t audible = (e - aligned) / 160;
+    const float d = len == refLen ? maxDiff(ref, inc, 80, len, 2, audible - 3) : 1e9f;
+    const float dPad = len == refLen ? maxDiff(ref, inc, 80, len, audible + 3, len) : 1e9f;
+    char what[96];
+    std::snprintf(what, sizeof(what), "trimmed extract matches the trimmed clip (%.1e)",
+                  static_cast<double>(std::max(d, dPad)));
+    expect(len == refLen && d < 2e-3f && dPad < 2e-3f, what);
+
+    LogMelSpectrogram unfinished;
+    unfinished.push(x.data(), x.size());
+    std::vector<float> out;
+    expect(unfinished.extract(0, x.size(), out) == 0 && unfinished.extract(0, x.size() - 400, out) > 0,
+           "extract refuses frames that need finish()");
+}
+
+// ------------------------------------------------------------------
+// Timing
+// ------------------------------------------------------------------
+
+static void timing()
+{
+    std::printf("\nCritical path at release (80 bands, single thread)\n");
+    std::printf("  %-8s %14s %14s %14s %12s\n", "clip", "whole clip", "while rec.", "at release", "per 10 ms");
+    for (double sec : { 2.0, 5.0, 15.0, 30.0 }) {
+        const std::vector<float> x = speechLike(sec, 11);
+        std::vector<float> out;
+
+        // Today: all of it after release.
+        double wholeMs = 1e30;
+        for (int rep = 0; rep < 3; ++rep) {
+            const auto t0 = Clock::now();
+            LogMelSpectrogram mel;
+            mel.push(x.data(), x.size());
+            mel.finish();
+            mel.extract(0, x.size(), out);
+            wholeMs = std::min(wholeMs, msSince(t0));
+        }
+
+        // Incremental: 10 ms blocks while recording, then finish + extract.
+        double liveMs = 0.0, releaseMs = 1e30;
+        for (int rep = 0; rep < 3; ++rep) {
+            LogMelSpectrogram mel;
+            for (size_t i = 0; i < x.size(); i += 160)
+                mel.push(x.data() + i, std::min<size_t>(160, x.size() - i));
+            liveMs = mel.stats().computeMs;
+            const auto t0 = Clock::now();
+            mel.finish();
+            mel.extract(0, x.size(), out);
+            releaseMs = std::min(releaseMs, msSince(t0));
+        }
+        std::printf("  %5.0f s  %11.2f ms %11.2f ms %11.3f ms %9.1f us\n",
+                    sec, wholeMs, liveMs, releaseMs, 1000.0 * liveMs / (sec * 100.0));
+    }
+}
+
+// ------------------------------------------------------------------
+// With a model: whisper's own mel vs the precomputed one
+// ------------------------------------------------------------------
+
+static bool loadClip(const char* path, std::vector<float>& pcm)
+{
+    ma_decoder_config cfg = ma_decoder_config_init(ma_format_f32, 1, 16000);
+    ma_uint64 frames = 0;
+    void* data = nullptr;
+    if (ma_decode_file(path, &cfg, &frames, &data) != MA_SUCCESS) return false;
+    pcm.assign(static_cast<float*>(data), static_cast<float*>(data) + frames);
+    ma_free(data, nullptr);
+    return true;
+}
+
+struct EncoderStart {
+    Clock::time_point at{};
+};
+
+static std::string decode(whisper_context* ctx, const float* x, size_t n, int durationMs,
+                          double& toEncoderMs)
+{
+    whisper_full_params p = clipDecodeParams(n, 1);
+    p.duration_ms = durationMs;
+    EncoderStart start;
+    p.encoder_begin_callback = [](whisper_context*, whisper_state*, void* user) {
+        auto* s = static_cast<EncoderStart*>(user);
+        if (s->at == Clock::time_point{}) s->at = Clock::now();
+        return true;
+    };
+    p.encoder_begin_callback_user_data = &start;
+    const auto t0 = Clock::now();
+    if (whisper_full(ctx, p, x, static_cast<int>(n)) != 0) return "(failed)";
+    toEncoderMs = std::chrono::duration<double, std::milli>(start.at - t0).count();
+    std::string out;
+    for (int i = 0; i < whisper_full_n_segments(ctx); ++i) out += whisper_full_get_segment_text(ctx, i);
+    return out;
+}
+
+static void compare(const char* modelPath, const char* clipPath)
+{
+    std::vector<float> clip;
+    if (!loadClip(clipPath, clip)) {
+        std::printf("\ncannot decode %s\n", clipPath);
+        ++g_failures;
+        return;
+    }
+    whisper_context_params cp = whisper_context_default_params();
+    cp.use_gpu = false;
+    whisper_context* ctx = whisper_init_from_file_with_params(modelPath, cp);
+    if (!ctx) {
+        std::printf("\ncannot load %s\n", modelPath);
+        ++g_failures;
+        return;
+    }
+    const int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    const size_t nMel = static_cast<size_t>(whisper_model_n_mels(ctx));
+    std::printf("\n%s, %.1f s, %zu mel bands, %d threads\n", clipPath, clip.size() / 16000.0, nMel, threads);
+
+    const auto p0 = Clock::now();
+    whisper_pcm_to_mel(ctx, clip.data(), static_cast<int>(clip.size()), threads);
+    const double pcmMelMs = msSince(p0);
+
+    LogMelSpectrogram mel(nMel);
+    for (size_t i = 0; i < clip.size(); i += 160)
+        mel.push(clip.data() + i, std::min<size_t>(160, clip.size() - i));
+    std::vector<float> data;
+    const auto s0 = Clock::now();
+    mel.finish();
+    const size_t nLen = mel.extract(0, clip.size(), data);
+    const bool set = nLen > 0 && whisper_set_mel(ctx, data.data(), static_cast<int>(nLen),
+                                                 static_cast<int>(nMel)) == 0;
+    const double handoffMs = msSince(s0);
+    std::printf("  whisper_pcm_to_mel at release:          %8.2f ms\n", pcmMelMs);
+    std::printf("  finish + extract + whisper_set_mel:     %8.2f ms (%.1f ms spent while recording)\n",
+                handoffMs, mel.stats().computeMs);
+    expect(set, "whisper_set_mel accepts the spectrogram");
+
+    double pcmToEncoder = 0.0, melToEncoder = 0.0;
+    const std::string fromPcm = decode(ctx, clip.data(), clip.size(), 0, pcmToEncoder);
+    whisper_set_mel(ctx, data.data(), static_cast<int>(nLen), static_cast<int>(nMel));
+    const std::string fromMel = decode(ctx, nullptr, 0, static_cast<int>(clip.size() / 16), melToEncoder);
+    std::printf("  whisper_full to encoder start: %.1f ms from samples, %.1f ms from the set mel\n",
+                pcmToEncoder, melToEncoder);
+    std::printf("  from samples: %s\n", fromPcm.c_str());
+    std::printf("  from mel:     %s\n", fromMel.c_str());
+    expect(fromPcm == fromMel, "same transcript both ways");
+
+    whisper_free(ctx);
+}
+
+int main(int argc, char** argv)
+{
+    accuracyChecks();
+    timing();
+    if (argc >= 3) compare(argv[1], argv[2]);
+    else std::printf("\n(no model and clip given: whisper handoff skipped)\n");
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// bench_mapped_model.cpp — model loading through a read-only file mapping.
+//
+//   bench_mapped_model                        loader checks only
+//   bench_mapped_model model.bin speech.wav   checks, then stream vs mapped loading
+//
+// The checks write a 3 MB file of known bytes, map it with MappedModel
+// and read it back through the whisper_model_loader callbacks in odd
+// chunk sizes: every byte must match, eof must hold at the end and only
+// there, short reads must stop at the end of the file, and loader() must
+// start a second load from the beginning.
+//
+// With a model and a recording, the weights are loaded five times each
+// way — whisper_init_from_file_with_params_no_state (buffered stream
+// reads) and whisper_init_with_params_no_state over MappedModel — with
+// the file already in the page cache, as it is for a reload after an
+// idle unload.  It prints the load times, process memory split into
+// private and file-backed (shared) pages while each context is loaded,
+// how much of the mapping was resident, and checks both contexts give
+// the same transcript.
+// Exits non-zero if a check fails.
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "bench_check.h"
+#include "decode_params.h"
+#include "mapped_model.h"
+#include "whisper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+// ------------------------------------------------------------------
+// Process memory, MB: private pages vs file-backed pages (which other
+// processes mapping the same file share).
+// ------------------------------------------------------------------
+struct MemoryUse {
+    double priv   = 0.0;
+    double shared = 0.0;
+};
+
+static MemoryUse memoryUse()
+{
+    MemoryUse m;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS_EX pmc{};
+    pmc.cb = sizeof(pmc);
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof(pmc))) {
+        m.priv   = pmc.PrivateUsage / 1048576.0;
+        m.shared = std::max(0.0, (static_cast<double>(pmc.WorkingSetSize) - static_cast<double>(pmc.PrivateUsage)) / 1048576.0);
+    }
+#else
+    if (FILE* f = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        unsigned long kb = 0;
+        while (std::fgets(line, sizeof(line), f)) {
+            if (std::sscanf(line, "RssAnon: %lu kB", &kb) == 1) m.priv   = kb / 1024.0;
+            if (std::sscanf(line, "RssFile: %lu kB", &kb) == 1) m.shared = kb / 1024.0;
+        }
+        std::fclose(f);
+    }
+#endif
+    return m;
+}
+
+// ------------------------------------------------------------------
+// Loader checks
+// ------------------------------------------------------------------
+
+static void loaderChecks()
+{
+    std::printf("Mapped loader\n");
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "flowon_bench_mapped.bin";
+    const size_t bytes = 3 * 1048576 + 123;
+    std::vector<unsigned char> ref(bytes);
+    uint32_t x = 2463534242u;
+    for (unsigned char& b : ref) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        b = static_cast<unsigned char>(x);
+    }
+    {
+        std::ofstream f(path, std::ios::binary);
+        f.write(reinterpret_cast<const char*>(ref.data()), static_cast<std::streamsize>(ref.size()));
+    }
+
+    MappedModel file;
+    expect(file.open(path) && file.size() == bytes, "maps the whole file");
+
+    std::vector<unsigned char> out(bytes + 64);
+    bool same = true, eofEarly = false;
+    for (int pass = 0; pass < 2; ++pass) {
+        whisper_model_loader l = file.loader();
+        size_t got = 0, chunk = 1;
+        while (!l.eof(l.context)) {
+            const size_t n = l.read(l.context, out.data() + got, std::min(chunk, out.size() - got));
+            if (n == 0) break;
+            got += n;
+            chunk = chunk * 7 % 65521 + 1;   // 1 B .. 64 KB, tensor-header-sized reads included
+            eofEarly |= got < bytes && l.eof(l.context);
+        }
+        same &= got == bytes && std::equal(ref.begin(), ref.end(), out.begin());
+        l.close(l.context);
+    }
+    expect(same, "reads every byte, twice (loader() rewinds)");
+    expect(!eofEarly, "eof only at the end");
+
+    whisper_model_loader l = file.loader();
+    std::vector<unsigned char> big(bytes + 4096);
+    expect(l.read(l.context, big.data(), big.size()) == bytes && l.eof(l.context),
+           "a read past the end stops at the end");
+
+    const MappedModel::Residency r = file.residency();
+    std::printf("  residency: %zu of %zu bytes in memory\n", r.resident, r.mapped);
+    expect(r.mapped == bytes && r.resident > 0, "residency reports the mapping");
+    file.close();
+    expect(!file.isOpen() && file.residency().mapped == 0, "close() unmaps");
+    std::filesystem::remove(path);
+}
+
+// ------------------------------------------------------------------
+// Whisper comparison
+// ------------------------------------------------------------------
+
+static bool loadClip(const char* path, std::vector<float>& pcm)
+{
+    ma_decoder_config cfg = ma_decoder_config_init(ma_format_f32, 1, 16000);
+    ma_uint64 frames = 0;
+    void* data = nullptr;
+    if (ma_decode_file(path, &cfg, &frames, &data) != MA_SUCCESS) return false;
+    pcm.assign(static_cast<float*>(data), static_cast<float*>(data) + frames);
+    ma_free(data, nullptr);
+    return true;
+}
+
+static std::string transcribe(whisper_context* ctx, const std::vector<float>& clip)
+{
+    whisper_state* state = whisper_init_state(ctx);
+    if (!state) return {};
+    const whisper_full_params p = clipDecodeParams(clip.size(), 1);
+    std::string out;
+    if (whisper_full_with_state(ctx, state, p, clip.data(), static_cast<int>(clip.size())) == 0)
+        for (int i = 0; i < whisper_full_n_segments_from_state(state); ++i)
+            out += whisper_full_get_segment_text_from_state(state, i);
+    whisper_free_state(state);
+    return out;
+}
+
+static void compare(const char* modelPath, const char* clipPath)
+{
+    std::vector<float> clip;
+    if (!loadClip(clipPath, clip)) {
+        std::printf("\ncannot decode %s\n", clipPath);
+        ++g_failures;
+        return;
+    }
+    whisper_context_params cp = whisper_context_default_params();
+    cp.use_gpu    = false;
+    cp.flash_attn = true;
+
+    // Warm the page cache, as a reload after an idle unload finds it.
+    if (whisper_context* warm = whisper_init_from_file_with_params_no_state(modelPath, cp)) whisper_free(warm);
+
+    std::printf("\n%s, page cache warm, best of 5\n", modelPath);
+    std::printf("  %-8s %10s %12s %12s\n", "loader", "load", "private", "file-backed");
+    const MemoryUse base = memoryUse();
+    std::string streamText, mappedText;
+    double streamMs = 1e30, mappedMs = 1e30;
+
+    for (int i = 0; i < 5; ++i) {
+        const auto t0 = Clock::now();
+        whisper_context* ctx = whisper_init_from_file_with_params_no_state(modelPath, cp);
+        streamMs = std::min(streamMs, msSince(t0));
+        if (!ctx) {
+            std::printf("cannot load %s\n", modelPath);
+            ++g_failures;
+            return;
+        }
+        if (i == 4) {
+            const MemoryUse m = memoryUse();
+            std::printf("  %-8s %7.0f ms %+9.1f MB %+9.1f MB\n", "stream", streamMs,
+                        m.priv - base.priv, m.shared - base.shared);
+            streamText = transcribe(ctx, clip);
+        }
+        whisper_free(ctx);
+    }
+
+    MappedModel::Residency residency;
+    for (int i = 0; i < 5; ++i) {
+        MappedModel file;
+        const auto t0 = Clock::now();
+        whisper_context* ctx = nullptr;
+        if (file.open(modelPath)) {
+            whisper_model_loader loader = file.loader();
+            ctx = whisper_init_with_params_no_state(&loader, cp);
+        }
+        mappedMs = std::min(mappedMs, msSince(t0));
+        if (!ctx) {
+            std::printf("cannot load %s through a mapping\n", modelPath);
+            ++g_failures;
+            return;
+        }
+        if (i == 4) {
+            residency = file.residency();
+            const MemoryUse m = memoryUse();
+            std::printf("  %-8s %7.0f ms %+9.1f MB %+9.1f MB\n", "mapped", mappedMs,
+                        m.priv - base.priv, m.shared - base.shared);
+            mappedText = transcribe(ctx, clip);
+        }
+        whisper_free(ctx);
+    }
+    std::printf("  mapping: %.1f MB, %.1f MB resident, %.1f MB shared with other processes\n",
+                residency.mapped / 1048576.0, residency.resident / 1048576.0, residency.shared / 1048576.0);
+    std::printf("  transcript: %s\n", mappedText.c_str());
+    expect(!mappedText.empty() && mappedText == streamText, "same transcript from both loaders");
+}
+
+int main(int argc, char** argv)
+{
+    loaderChecks();
+    if (argc >= 3) compare(argv[1], argv[2]);
+    else std::printf("\n(no model and clip given: loader comparison skipped)\n");
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+// bench_noise_suppressor.cpp — cost and effect of the consumer-stage
+// Wiener denoiser, plus the mixed-radix FFT underneath it.
+//
+//   - FFT: checks RealFft against a direct DFT (sizes 320, 400, 480, 512)
+//     and times forward + inverse;
+//   - CPU: ms per second of 16 kHz audio, streamed in 30 ms blocks;
+//   - effect: SNR of speech-band tone bursts in fan-like noise (low-passed
+//     noise + 50 Hz hum) before and after, plus residual noise in the gaps.
+// Exits non-zero if the FFT is wrong, the denoiser costs 1% of a core or
+// more, or it makes the SNR worse.
+#include "bench_check.h"
+#include "fft.h"
+#include "noise_suppressor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+static constexpr double kPi = 3.14159265358979;
+
+static void checkFft()
+{
+    std::mt19937 rng(3);
+    std::normal_distribution<float> nd;
+    for (size_t n : { 320, 400, 480, 512 }) {
+        RealFft f(n);
+        std::vector<float> x(n), re(n / 2 + 1), im(n / 2 + 1), y(n);
+        for (float& v : x) v = nd(rng);
+        f.forward(x.data(), re.data(), im.data());
+
+        double err = 0.0;
+        for (size_t k = 0; k <= n / 2; ++k) {
+            double sr = 0.0, si = 0.0;
+            for (size_t t = 0; t < n; ++t) {
+                const double a = -2.0 * kPi * static_cast<double>(k * t) / static_cast<double>(n);
+                sr += x[t] * std::cos(a);
+                si += x[t] * std::sin(a);
+            }
+            err = std::max({ err, std::fabs(sr - re[k]), std::fabs(si - im[k]) });
+        }
+        f.inverse(re.data(), im.data(), y.data());
+        double rt = 0.0;
+        for (size_t t = 0; t < n; ++t) rt = std::max(rt, static_cast<double>(std::fabs(y[t] - x[t])));
+
+        constexpr int kReps = 20000;
+        const auto t0 = Clock::now();
+        for (int r = 0; r < kReps; ++r) {
+            f.forward(x.data(), re.data(), im.data());
+            f.inverse(re.data(), im.data(), y.data());
+        }
+        const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / kReps;
+
+        const bool ok = err < 1e-3 && rt < 1e-5;
+        std::printf("FFT n=%-4zu max err %.1e  round trip %.1e  %6.2f us fwd+inv  %s\n",
+                    n, err, rt, us, ok ? "OK" : "MISMATCH");
+        if (!ok) ++g_failures;
+    }
+}
+
+int main()
+{
+    checkFft();
+
+    // 20 s: bursts of tones (1 s on / 1 s off) in fan noise at ~5 dB SNR.
+    constexpr size_t kRate = 16000, kLen = kRate * 20;
+    std::mt19937 rng(11);
+    std::normal_distribution<float> nd(0.0f, 1.0f);
+    std::vector<float> clean(kLen), noisy(kLen);
+    float lp = 0.0f;
+    for (size_t i = 0; i < kLen; ++i) {
+        const double t = static_cast<double>(i) / kRate;
+        const bool on = (i / kRate) % 2 == 1;
+        clean[i] = on ? static_cast<float>(0.05 * (std::sin(2 * kPi * 220 * t) + 0.6 * std::sin(2 * kPi * 660 * t)
+                                                  + 0.3 * std::sin(2 * kPi * 1800 * t))) : 0.0f;
+        lp += 0.05f * (nd(rng) - lp);                       // fan rumble
+        noisy[i] = clean[i] + 0.12f * lp + 0.01f * static_cast<float>(std::sin(2 * kPi * 50 * t))
+                 + 0.003f * nd(rng);
+    }
+
+    NoiseSuppressor ns;
+    std::vector<float> out;
+    out.reserve(kLen + 2 * NoiseSuppressor::kHop);
+    std::vector<float> buf(480 + NoiseSuppressor::kHop);
+    const auto t0 = Clock::now();
+    for (size_t off = 0; off < kLen; off += 480) {
+        const size_t n = std::min<size_t>(480, kLen - off);
+        const size_t k = ns.process(noisy.data() + off, n, buf.data());
+        out.insert(out.end(), buf.data(), buf.data() + k);
+    }
+    buf.resize(2 * NoiseSuppressor::kHop);
+    const size_t tail = ns.flush(buf.data());
+    out.insert(out.end(), buf.data(), buf.data() + tail);
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    const double msPerSec = ms / (kLen / static_cast<double>(kRate));
+
+    // Compare over the second half (profile learned), output realigned by one hop.
+    auto snr = [&](const float* y) {
+        double s = 0.0, e = 0.0;
+        for (size_t i = kLen / 2; i < kLen; ++i) {
+            s += clean[i] * clean[i];
+            e += (y[i] - clean[i]) * (y[i] - clean[i]);
+        }
+        return 10.0 * std::log10(s / e);
+    };
+    auto gapDb = [&](const float* y) {
+        double e = 0.0;
+        size_t n = 0;
+        for (size_t i = kLen / 2; i < kLen; ++i)
+            if (clean[i] == 0.0f) { e += y[i] * y[i]; ++n; }
+        return 10.0 * std::log10(e / n);
+    };
+    const float* aligned = out.data() + NoiseSuppressor::kHop;
+
+    std::printf("\nDenoiser: %.3f ms CPU per second of audio (%.3f%% of one core)\n", msPerSec, msPerSec / 10.0);
+    std::printf("  SNR          %6.1f dB -> %6.1f dB\n", snr(noisy.data()), snr(aligned));
+    std::printf("  noise in gaps %6.1f dB -> %6.1f dB\n", gapDb(noisy.data()), gapDb(aligned));
+    std::printf("  length       %zu in -> %zu out (one %zu-sample hop of delay)\n",
+                kLen, out.size(), NoiseSuppressor::kHop);
+
+    if (msPerSec >= 10.0) ++g_failures;
+    if (snr(aligned) <= snr(noisy.data())) ++g_failures;
+    if (out.size() != kLen + NoiseSuppressor::kHop) ++g_failures;
+
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
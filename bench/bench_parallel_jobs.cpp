@@ -0,0 +1,277 @@
+// bench_parallel_jobs.cpp — throughput of 1..N concurrent transcriptions.
+//
+//   bench_parallel_jobs                               stand-in jobs only
+//   bench_parallel_jobs model.bin speech.wav [N]      also real whisper jobs
+//
+// Transcriber runs up to N jobs at once on one copy of the weights, each
+// on its own whisper_state, with the spare cores split over the jobs
+// running.  This measures what that buys for a burst of utterances.
+//
+// Stand-in: each utterance is a ggml-shaped graph — fixed total work per
+// node split over the job's threads, a barrier per node — so a job on
+// many threads pays the synchronisation that makes a few jobs on fewer
+// threads each the better use of the cores.  The jobs go through
+// OrderedJobQueue with P workers, and the completions are checked to
+// arrive once each and in submission order.
+//
+// With a model and a recording (any file miniaudio decodes), the weights
+// are loaded once (whisper_init_from_file_with_params_no_state) and 2N
+// copies of the clip are transcribed with P = 1..N workers, one
+// whisper_state each, threads = (cores - 1) / P.
+// Exits non-zero if a check fails.
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "bench_check.h"
+#include "decode_params.h"
+#include "ordered_job_queue.h"
+#include "whisper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double msBetween(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+static int hardwareThreads()
+{
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Transcriber's budget: one core for the UI, the rest split over the jobs.
+static int threadBudget(int jobs)
+{
+    return std::max(1, (hardwareThreads() - 1) / std::max(1, jobs));
+}
+
+// ------------------------------------------------------------------
+// Stand-in for whisper_full: `nodes` graph nodes, `nodeWork` units each,
+// shared by `threads` threads with a barrier after every node.
+// ------------------------------------------------------------------
+static volatile float g_sink = 0.0f;
+
+static void computeGraph(int threads, int nodes, int nodeWork)
+{
+    std::barrier sync(threads);
+    auto body = [&](int ith) {
+        float acc = 0.0f;
+        const int share = nodeWork / threads + 1;
+        for (int node = 0; node < nodes; ++node) {
+            for (int i = 0; i < share; ++i)
+                acc += std::sqrt(static_cast<float>(i + ith + node));
+            sync.arrive_and_wait();
+        }
+        g_sink = g_sink + acc;
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(body, t);
+    body(0);
+    for (auto& t : pool) t.join();
+}
+
+// Work units that take about `ms` on one thread.
+static int calibrate(double ms)
+{
+    const int probe = 200000;
+    const auto t0 = Clock::now();
+    computeGraph(1, 10, probe);
+    const double perUnit = msBetween(t0, Clock::now()) / (10.0 * probe);
+    return std::max(1, static_cast<int>(ms / perUnit));
+}
+
+struct Utterance {
+    int nodes    = 0;
+    int nodeWork = 0;
+};
+using Queue = OrderedJobQueue<Utterance, uint64_t>;
+
+struct BurstResult {
+    double wallMs    = 0.0;
+    double meanMs    = 0.0;   // submit to completion
+    bool   inOrder   = true;
+    size_t completed = 0;
+};
+
+static BurstResult standInBurst(int workers, int utterances, int nodes, int nodeWork)
+{
+    Queue q;
+    std::mutex m;
+    std::vector<uint64_t> order;
+    std::vector<double>   latency;
+    std::atomic<int>      running{0};
+
+    std::vector<std::thread> pool;
+    for (int w = 0; w < workers; ++w) {
+        pool.emplace_back([&q, &running] {
+            Queue::Job job;
+            while (q.pop(job)) {
+                const int jobs = running.fetch_add(1) + 1;
+                computeGraph(threadBudget(jobs), job.payload.nodes, job.payload.nodeWork);
+                running.fetch_sub(1);
+                q.complete(job, job.id);
+            }
+        });
+    }
+
+    const auto t0 = Clock::now();
+    for (int i = 0; i < utterances; ++i) {
+        const auto submitted = Clock::now();
+        q.push(Utterance{ nodes, nodeWork }, [&, submitted](uint64_t id, uint64_t) {
+            std::lock_guard<std::mutex> lock(m);
+            order.push_back(id);
+            latency.push_back(msBetween(submitted, Clock::now()));
+        }, 1, Clock::now(), 1);
+    }
+    while (q.pending() > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    BurstResult r;
+    r.wallMs = msBetween(t0, Clock::now());
+    q.close();
+    for (auto& t : pool) t.join();
+
+    r.completed = order.size();
+    for (size_t i = 1; i < order.size(); ++i) r.inOrder &= order[i] > order[i - 1];
+    for (double l : latency) r.meanMs += l / static_cast<double>(latency.size());
+    return r;
+}
+
+static void standIn(int maxJobs)
+{
+    const int utterances = 2 * maxJobs;
+    const int nodes      = 300;   // ~one small-model encode + decode
+    const int nodeWork   = calibrate(1.0);
+    std::printf("Stand-in: %d utterances of %d nodes x ~1 ms of work, %d hardware threads\n",
+                utterances, nodes, hardwareThreads());
+    std::printf("  %-8s %-9s %10s %12s %12s\n", "jobs", "threads", "wall", "utt/s", "mean wait");
+
+    bool allDone = true, allOrdered = true;
+    double oneJob = 0.0, best = 0.0;
+    for (int p = 1; p <= maxJobs; ++p) {
+        const BurstResult r = standInBurst(p, utterances, nodes, nodeWork);
+        const double rate = 1000.0 * utterances / r.wallMs;
+        if (p == 1) oneJob = rate;
+        best = std::max(best, rate);
+        allDone    &= r.completed == static_cast<size_t>(utterances);
+        allOrdered &= r.inOrder;
+        std::printf("  %-8d %-9d %8.0f ms %12.2f %9.0f ms\n", p, threadBudget(p), r.wallMs, rate, r.meanMs);
+    }
+    std::printf("  best throughput %.2fx one job at a time\n", best / oneJob);
+    expect(allDone, "every utterance completes once");
+    expect(allOrdered, "completions in submission order with parallel workers");
+}
+
+// ------------------------------------------------------------------
+// Real whisper jobs
+// ------------------------------------------------------------------
+
+static bool loadClip(const char* path, std::vector<float>& pcm)
+{
+    ma_decoder_config cfg = ma_decoder_config_init(ma_format_f32, 1, 16000);
+    ma_uint64 frames = 0;
+    void* data = nullptr;
+    if (ma_decode_file(path, &cfg, &frames, &data) != MA_SUCCESS) return false;
+    pcm.assign(static_cast<float*>(data), static_cast<float*>(data) + frames);
+    ma_free(data, nullptr);
+    return true;
+}
+
+static std::string textOf(whisper_state* state)
+{
+    std::string out;
+    for (int i = 0; i < whisper_full_n_segments_from_state(state); ++i)
+        out += whisper_full_get_segment_text_from_state(state, i);
+    return out;
+}
+
+static void realJobs(const char* modelPath, const char* clipPath, int maxJobs)
+{
+    std::vector<float> clip;
+    if (!loadClip(clipPath, clip)) {
+        std::printf("\ncannot decode %s\n", clipPath);
+        ++g_failures;
+        return;
+    }
+    whisper_context_params cp = whisper_context_default_params();
+    cp.use_gpu = false;
+    whisper_context* ctx = whisper_init_from_file_with_params_no_state(modelPath, cp);
+    if (!ctx) {
+        std::printf("\ncannot load %s\n", modelPath);
+        ++g_failures;
+        return;
+    }
+    std::vector<whisper_state*> states;
+    for (int i = 0; i < maxJobs; ++i) {
+        whisper_state* s = whisper_init_state(ctx);
+        if (!s) break;
+        states.push_back(s);
+    }
+    maxJobs = static_cast<int>(states.size());
+    const int utterances = 2 * maxJobs;
+
+    // Reference transcript and warm-up, one job alone.
+    whisper_full_with_state(ctx, states[0], clipDecodeParams(clip.size(), 1),
+                            clip.data(), static_cast<int>(clip.size()));
+    const std::string reference = textOf(states[0]);
+
+    std::printf("\n%s, %.1f s: %d utterances, one model, up to %d states\n",
+                clipPath, clip.size() / 16000.0, utterances, maxJobs);
+    std::printf("  %-8s %-9s %10s %12s %14s\n", "jobs", "threads", "wall", "utt/s", "mean latency");
+    bool same = true;
+    double oneJob = 0.0, best = 0.0;
+    for (int p = 1; p <= maxJobs; ++p) {
+        std::atomic<int> next{0};
+        std::mutex m;
+        double latencySum = 0.0;
+        const auto t0 = Clock::now();
+        std::vector<std::thread> workers;
+        for (int w = 0; w < p; ++w) {
+            workers.emplace_back([&, w] {
+                while (next.fetch_add(1) < utterances) {
+                    const auto j0 = Clock::now();
+                    whisper_full_with_state(ctx, states[w], clipDecodeParams(clip.size(), p),
+                                            clip.data(), static_cast<int>(clip.size()));
+                    const std::string text = textOf(states[w]);
+                    std::lock_guard<std::mutex> lock(m);
+                    latencySum += msBetween(j0, Clock::now());
+                    same &= text == reference;
+                }
+            });
+        }
+        for (auto& t : workers) t.join();
+        const double wallMs = msBetween(t0, Clock::now());
+        const double rate = 1000.0 * utterances / wallMs;
+        if (p == 1) oneJob = rate;
+        best = std::max(best, rate);
+        std::printf("  %-8d %-9d %8.0f ms %12.2f %11.0f ms\n",
+                    p, threadBudget(p), wallMs, rate, latencySum / utterances);
+    }
+    std::printf("  best throughput %.2fx one job at a time\n", best / oneJob);
+    expect(same, "every concurrent job gives the single-job transcript");
+
+    for (whisper_state* s : states) whisper_free_state(s);
+    whisper_free(ctx);
+}
+
+int main(int argc, char** argv)
+{
+    int maxJobs = std::clamp(hardwareThreads() / 2, 1, 4);
+    if (argc >= 4) maxJobs = std::clamp(std::atoi(argv[3]), 1, 8);
+
+    standIn(maxJobs);
+    if (argc >= 3) realJobs(argv[1], argv[2], maxJobs);
+    else std::printf("\n(no model and clip given: real jobs skipped)\n");
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
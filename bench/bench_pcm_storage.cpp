@@ -0,0 +1,238 @@
+// bench_pcm_storage.cpp — float vs compact int16 recording storage.
+//
+// Replays 15 s and 5 min of 16 kHz speech-like PCM through the storage
+// path AudioManager uses: 30 ms producer writes into a CaptureRing (with
+// floatToInt16 on the way in for the compact ring), a 10 ms consumer pump
+// into a PcmChain, then the handoff copy to one contiguous float buffer
+// that Transcriber gives Whisper.  A second pass leaves the consumer
+// stalled for the whole take and drains the backlog at release, the way
+// drainBuffer does after a hiccup.
+//
+// Reports bytes held by ring + spill + chain, time per stage, and the
+// quantisation SNR of the int16 round trip.  Fails if the compact path is
+// not exactly the quantised source or does not halve the chain.
+//
+//   cmake -B build -DFLOWON_BUILD_BENCHMARKS=ON
+//   cmake --build build --config Release --target bench_pcm_storage
+#include "bench_check.h"
+#include "audio_kernels.h"
+#include "capture_ring.h"
+#include "pcm_chain.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace ak = audio_kernels;
+using Clock = std::chrono::steady_clock;
+
+static constexpr size_t kRate     = 16000;
+static constexpr size_t kPeriod   = 480;      // 30 ms producer callback
+static constexpr size_t kPump     = 160;      // 10 ms consumer pump
+static constexpr size_t kRingSec  = 15;       // as audio_manager.cpp
+static constexpr size_t kSpillSec = 600;
+static constexpr size_t kStaging  = 4096;     // AudioManager::m_toRing / m_fromRing
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static std::vector<float> makeSpeech(size_t n)
+{
+    std::mt19937 rng(77);
+    std::normal_distribution<float> noise(0.0f, 0.002f);
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; ++i) {
+        const float t   = static_cast<float>(i) / kRate;
+        const float env = 0.5f + 0.5f * std::sin(6.2831853f * 3.0f * t);
+        x[i] = noise(rng) + 0.15f * env * (std::sin(6.2831853f * 180.0f * t)
+                                         + 0.5f * std::sin(6.2831853f * 1230.0f * t));
+    }
+    return x;
+}
+
+struct Result {
+    size_t ringBytes   = 0;   // primary ring allocation
+    size_t spillBytes  = 0;   // spill pages actually written (stalled pass)
+    size_t chainBytes  = 0;
+    double writeMs     = 0.0; // producer, whole take
+    double pumpMs      = 0.0; // consumer, whole take
+    double drainMs     = 0.0; // stalled consumer: backlog at release
+    double handoffMs   = 0.0; // chain -> contiguous float
+    std::vector<float> out;
+};
+
+// Storage path for one sample type.  write()/pump() mirror
+// AudioManager::ringWrite/ringRead.
+template <typename T>
+class Path {
+public:
+    Path()
+        : m_ring(kRate * kRingSec, kRate * kSpillSec),
+          m_to(kStaging), m_from(kStaging), m_pump(kPump) {}
+
+    size_t ringBytes() const { return m_ring.capacity() * sizeof(T); }
+
+    void write(const float* x, size_t n)
+    {
+        if constexpr (std::is_same_v<T, float>) {
+            m_ring.write(x, n);
+        } else {
+            for (size_t done = 0; done < n; ) {
+                const size_t k = std::min(kStaging, n - done);
+                ak::floatToInt16(x + done, k, m_to.data());
+                m_ring.write(m_to.data(), k);
+                done += k;
+            }
+        }
+    }
+
+    // Moves up to `max` samples into the chain; returns how many.
+    size_t pump(PcmChain& chain, size_t max)
+    {
+        size_t moved = 0;
+        while (moved < max) {
+            const size_t want = std::min(kPump, max - moved);
+            size_t n;
+            if constexpr (std::is_same_v<T, float>) {
+                n = m_ring.read(m_pump.data(), want);
+            } else {
+                n = m_ring.read(m_from.data(), want);
+                ak::int16ToFloat(m_from.data(), n, m_pump.data());
+            }
+            if (n == 0) break;
+            chain.append(m_pump.data(), n);
+            moved += n;
+            if (n < want) break;
+        }
+        return moved;
+    }
+
+    void reset() { m_ring.reset(); }
+
+private:
+    BasicCaptureRing<T>  m_ring;
+    std::vector<int16_t> m_to, m_from;
+    std::vector<float>   m_pump;
+};
+
+template <typename T>
+static Result run(const std::vector<float>& src, PcmFormat fmt)
+{
+    Result r;
+    Path<T> path;
+    r.ringBytes = path.ringBytes();
+    const size_t total = src.size();
+
+    // Live: producer and consumer interleaved at their real periods.
+    {
+        PcmChain chain(fmt);
+        double wMs = 0.0, pMs = 0.0;
+        for (size_t pos = 0; pos < total; pos += kPeriod) {
+            const size_t n = std::min(kPeriod, total - pos);
+            auto t0 = Clock::now();
+            path.write(src.data() + pos, n);
+            wMs += msSince(t0);
+            t0 = Clock::now();
+            path.pump(chain, kPeriod);
+            pMs += msSince(t0);
+        }
+        auto t0 = Clock::now();
+        path.pump(chain, SIZE_MAX);
+        pMs += msSince(t0);
+
+        r.writeMs    = wMs;
+        r.pumpMs     = pMs;
+        r.chainBytes = chain.bytes();
+
+        r.out.resize(chain.size());
+        t0 = Clock::now();
+        chain.copyTo(r.out.data(), 0, chain.size());
+        r.handoffMs = msSince(t0);
+    }
+
+    // Stalled: the whole take backs up into ring + spill, drained at release.
+    {
+        path.reset();
+        for (size_t pos = 0; pos < total; pos += kPeriod)
+            path.write(src.data() + pos, std::min(kPeriod, total - pos));
+        const size_t spilled = total > kRate * kRingSec ? total - kRate * kRingSec : 0;
+        const size_t page    = BasicCaptureRing<T>::kPageFrames;
+        r.spillBytes = (spilled + page - 1) / page * page * sizeof(T);
+
+        PcmChain chain(fmt);
+        const auto t0 = Clock::now();
+        path.pump(chain, SIZE_MAX);
+        r.drainMs = msSince(t0);
+        if (chain.size() != total) {
+            std::printf("  FAIL: stalled drain returned %zu of %zu samples\n", chain.size(), total);
+            ++g_failures;
+        }
+    }
+    return r;
+}
+
+static double snrDb(const std::vector<float>& ref, const std::vector<float>& got)
+{
+    double sig = 0.0, err = 0.0;
+    for (size_t i = 0; i < ref.size(); ++i) {
+        const double d = static_cast<double>(got[i]) - ref[i];
+        sig += static_cast<double>(ref[i]) * ref[i];
+        err += d * d;
+    }
+    return err > 0.0 ? 10.0 * std::log10(sig / err) : INFINITY;
+}
+
+static double mb(size_t b) { return static_cast<double>(b) / (1024.0 * 1024.0); }
+
+int main()
+{
+    std::printf("ISA: %s\n", ak::isaName());
+    std::printf("%-7s %-6s %8s %8s %8s %9s %9s %9s %10s %8s\n",
+                "take", "format", "ring MB", "spill MB", "chain MB",
+                "write ms", "pump ms", "drain ms", "handoff ms", "SNR dB");
+
+    PcmChain::reservePool(0, 64);
+    for (size_t sec : { size_t{15}, size_t{300} }) {
+        const std::vector<float> src = makeSpeech(kRate * sec);
+
+        const Result f = run<float>(src, PcmFormat::Float32);
+        const Result q = run<int16_t>(src, PcmFormat::Int16);
+
+        // Float path is lossless; int16 must equal the quantised source.
+        std::vector<int16_t> ref16(src.size());
+        std::vector<float>   ref(src.size());
+        ak::floatToInt16(src.data(), src.size(), ref16.data());
+        ak::int16ToFloat(ref16.data(), ref16.size(), ref.data());
+        if (f.out != src) {
+            std::printf("  FAIL: float path altered samples (%zus)\n", sec);
+            ++g_failures;
+        }
+        if (q.out != ref) {
+            std::printf("  FAIL: int16 path differs from quantised source (%zus)\n", sec);
+            ++g_failures;
+        }
+        if (q.chainBytes * 2 > f.chainBytes + PcmPage::kBytes) {
+            std::printf("  FAIL: int16 chain not half the float chain (%zus)\n", sec);
+            ++g_failures;
+        }
+
+        char take[16];
+        std::snprintf(take, sizeof(take), sec < 60 ? "%zus" : "%zumin", sec < 60 ? sec : sec / 60);
+        auto row = [&](const char* fmt, const Result& r, double snr) {
+            std::printf("%-7s %-6s %8.2f %8.2f %8.2f %9.2f %9.2f %9.2f %10.2f %8.1f\n",
+                        take, fmt, mb(r.ringBytes), mb(r.spillBytes), mb(r.chainBytes),
+                        r.writeMs, r.pumpMs, r.drainMs, r.handoffMs, snr);
+        };
+        row("float", f, snrDb(src, f.out));
+        row("int16", q, snrDb(src, q.out));
+    }
+
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
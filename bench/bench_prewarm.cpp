@@ -0,0 +1,308 @@
+// bench_prewarm.cpp — release-to-text after an idle unload, with and without prewarm.
+//
+//   bench_prewarm                        stand-in checks only
+//   bench_prewarm model.bin speech.wav   checks, then the whisper comparison
+//
+// Transcriber::prewarm() queues a load-only job at Background priority
+// when the hotkey goes down, so a model freed by the idle unload is
+// reloaded while the user speaks.  The stand-in runs that through
+// OrderedJobQueue with a sleep for the load: the prewarm must not preempt
+// a running Normal job, the dictation pushed at release must wait for the
+// load in progress instead of loading again, and its release-to-ready
+// time must be what is left of the load.  A prewarm preempted by the
+// dictation completes instead of running again.
+//
+// With a model and a recording, the clip is "spoken" in real time after
+// an unload, then transcribed two ways:
+//
+//   cold     — the weights and state are loaded after the release;
+//   prewarm  — the load starts at the press on another thread, and the
+//              job waits for it at the release.
+//
+// Prints the load time, the release-to-ready wait and the inference time.
+// Exits non-zero if a check fails.
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "bench_check.h"
+#include "decode_params.h"
+#include "ordered_job_queue.h"
+#include "whisper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double msBetween(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+// ------------------------------------------------------------------
+// Stand-in
+// ------------------------------------------------------------------
+
+enum class Kind { Prewarm, Dictation, Other };
+using Queue = OrderedJobQueue<Kind, int>;
+
+// One worker and a "model" that takes loadMs to load, shared by the jobs
+// the way Transcriber's is (exclusive load, then used).
+struct StandIn {
+    Queue                   q;
+    std::mutex              m;
+    bool                    loaded = false;
+    int                     loads  = 0;
+    std::chrono::milliseconds loadTime;
+    Clock::time_point       dictationReady{};
+
+    explicit StandIn(int loadMs) : loadTime(loadMs) {}
+
+    void ensureLoaded()
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if (loaded) return;
+        std::this_thread::sleep_for(loadTime);
+        loaded = true;
+        ++loads;
+    }
+};
+
+static void standIn()
+{
+    std::printf("Stand-in: 300 ms load, 600 ms of speech\n");
+
+    // Prewarm at the press, dictation at the release.
+    {
+        StandIn s(300);
+        std::thread worker([&s] {
+            Queue::Job job;
+            while (s.q.pop(job)) {
+                s.ensureLoaded();
+                if (job.payload == Kind::Dictation) s.dictationReady = Clock::now();
+                s.q.complete(job, 0);
+            }
+        });
+        const auto press = Clock::now();
+        s.q.push(Kind::Prewarm, nullptr, 0, press + std::chrono::milliseconds(1500), 0, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(600));
+        const auto release = Clock::now();
+        s.q.push(Kind::Dictation, nullptr, 2, release + std::chrono::milliseconds(1500), 9600, 0);
+        while (s.q.pending() > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        s.q.close();
+        worker.join();
+        const double waitMs = msBetween(release, s.dictationReady);
+        std::printf("  prewarm: release to ready %.1f ms\n", waitMs);
+        expect(s.loads == 1, "the model is loaded once");
+        expect(waitMs < 50.0, "load done while speaking; ready at release");
+    }
+
+    // A release shortly after the press: the dictation waits for the
+    // load in progress, and only for what is left of it.
+    {
+        StandIn s(300);
+        std::thread worker([&s] {
+            Queue::Job job;
+            while (s.q.pop(job)) {
+                s.ensureLoaded();
+                if (job.payload == Kind::Dictation) s.dictationReady = Clock::now();
+                s.q.complete(job, 0);
+            }
+        });
+        const auto press = Clock::now();
+        s.q.push(Kind::Prewarm, nullptr, 0, press + std::chrono::milliseconds(1500), 0, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const auto release = Clock::now();
+        s.q.push(Kind::Dictation, nullptr, 2, release + std::chrono::milliseconds(1500), 1600, 0);
+        while (s.q.pending() > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        s.q.close();
+        worker.join();
+        const double waitMs = msBetween(release, s.dictationReady);
+        std::printf("  short take: release to ready %.1f ms (cold would be ~300 ms)\n", waitMs);
+        expect(s.loads == 1, "short take: still one load");
+        expect(waitMs < 260.0, "short take: waits only for the rest of the load");
+    }
+
+    // A prewarm pushed while a Normal job runs must not preempt it.
+    {
+        Queue q;
+        std::shared_ptr<CancelToken> running;
+        std::mutex m;
+        std::condition_variable cv;
+        std::thread worker([&] {
+            Queue::Job job;
+            while (q.pop(job)) {
+                if (job.payload == Kind::Other) {
+                    {
+                        std::lock_guard<std::mutex> lock(m);
+                        running = job.cancel;
+                    }
+                    cv.notify_one();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                }
+                q.complete(job, 0);
+            }
+        });
+        q.push(Kind::Other, nullptr, 1, Clock::now() + std::chrono::seconds(1), 0, 0);
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&] { return running != nullptr; });
+        }
+        q.push(Kind::Prewarm, nullptr, 0, Clock::now() + std::chrono::milliseconds(1500), 0, 1);
+        while (q.pending() > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        q.close();
+        worker.join();
+        expect(!running->requested(), "prewarm does not preempt a running job");
+    }
+
+    // A dictation pushed above the prewarm while it loads preempts it; the
+    // load cannot stop, so the prewarm completes rather than running again.
+    {
+        StandIn s(300);
+        int prewarmRuns = 0;
+        bool preempted = false;
+        std::thread worker([&] {
+            Queue::Job job;
+            while (s.q.pop(job)) {
+                s.ensureLoaded();
+                if (job.payload == Kind::Prewarm) {
+                    ++prewarmRuns;
+                    preempted |= job.cancel->reason() == CancelToken::Reason::Preempted;
+                }
+                if (job.payload == Kind::Dictation) s.dictationReady = Clock::now();
+                if (job.cancel->reason() == CancelToken::Reason::Preempted
+                    && job.payload != Kind::Prewarm && s.q.requeue(job))
+                    continue;
+                s.q.complete(job, 0);
+            }
+        });
+        s.q.push(Kind::Prewarm, nullptr, 0, Clock::now() + std::chrono::milliseconds(1500), 0, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const auto release = Clock::now();
+        s.q.push(Kind::Dictation, nullptr, 2, release + std::chrono::milliseconds(1500), 1600, 0);
+        while (s.q.pending() > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        s.q.close();
+        worker.join();
+        const double waitMs = msBetween(release, s.dictationReady);
+        std::printf("  preempted prewarm: release to ready %.1f ms\n", waitMs);
+        expect(preempted && prewarmRuns == 1, "a preempted prewarm completes, no rerun");
+        expect(s.loads == 1 && waitMs < 260.0, "preempted: one load, dictation next");
+    }
+}
+
+// ------------------------------------------------------------------
+// Whisper comparison
+// ------------------------------------------------------------------
+
+static bool loadClip(const char* path, std::vector<float>& pcm)
+{
+    ma_decoder_config cfg = ma_decoder_config_init(ma_format_f32, 1, 16000);
+    ma_uint64 frames = 0;
+    void* data = nullptr;
+    if (ma_decode_file(path, &cfg, &frames, &data) != MA_SUCCESS) return false;
+    pcm.assign(static_cast<float*>(data), static_cast<float*>(data) + frames);
+    ma_free(data, nullptr);
+    return true;
+}
+
+struct Loaded {
+    whisper_context* ctx   = nullptr;
+    whisper_state*   state = nullptr;
+    double           ms    = 0.0;
+};
+
+static Loaded load(const char* modelPath)
+{
+    whisper_context_params cp = whisper_context_default_params();
+    cp.use_gpu    = false;
+    cp.flash_attn = true;
+    Loaded l;
+    const auto t0 = Clock::now();
+    l.ctx = whisper_init_from_file_with_params_no_state(modelPath, cp);
+    if (l.ctx) l.state = whisper_init_state(l.ctx);
+    l.ms = msBetween(t0, Clock::now());
+    return l;
+}
+
+static void unload(Loaded& l)
+{
+    if (l.state) whisper_free_state(l.state);
+    if (l.ctx)   whisper_free(l.ctx);
+    l = Loaded{};
+}
+
+static std::string transcribe(const Loaded& l, const std::vector<float>& clip)
+{
+    const whisper_full_params p = clipDecodeParams(clip.size(), 1);
+    std::string out;
+    if (whisper_full_with_state(l.ctx, l.state, p, clip.data(), static_cast<int>(clip.size())) == 0)
+        for (int i = 0; i < whisper_full_n_segments_from_state(l.state); ++i)
+            out += whisper_full_get_segment_text_from_state(l.state, i);
+    return out;
+}
+
+static void compare(const char* modelPath, const char* clipPath)
+{
+    std::vector<float> clip;
+    if (!loadClip(clipPath, clip)) {
+        std::printf("\ncannot decode %s\n", clipPath);
+        ++g_failures;
+        return;
+    }
+    const auto speech = std::chrono::milliseconds(clip.size() / 16);
+    {
+        Loaded warm = load(modelPath);   // page cache, as after an idle unload
+        if (!warm.state) {
+            std::printf("\ncannot load %s\n", modelPath);
+            ++g_failures;
+            return;
+        }
+        unload(warm);
+    }
+    std::printf("\n%s, %.1f s spoken in real time after an unload\n", clipPath, clip.size() / 16000.0);
+    std::printf("  %-8s %10s %16s %12s %16s\n", "", "load", "release->ready", "inference", "release->text");
+
+    // Cold: everything after the release.
+    std::this_thread::sleep_for(speech);
+    const auto coldRelease = Clock::now();
+    Loaded cold = load(modelPath);
+    const auto coldReady = Clock::now();
+    const std::string coldText = transcribe(cold, clip);
+    const auto coldDone = Clock::now();
+    unload(cold);
+    std::printf("  %-8s %7.0f ms %13.0f ms %9.0f ms %13.0f ms\n", "cold", cold.ms,
+                msBetween(coldRelease, coldReady), msBetween(coldReady, coldDone), msBetween(coldRelease, coldDone));
+
+    // Prewarm: the load overlaps the speech.
+    Loaded warm;
+    std::thread loader([&] { warm = load(modelPath); });
+    std::this_thread::sleep_for(speech);
+    const auto warmRelease = Clock::now();
+    loader.join();
+    const auto warmReady = Clock::now();
+    const std::string warmText = transcribe(warm, clip);
+    const auto warmDone = Clock::now();
+    std::printf("  %-8s %7.0f ms %13.0f ms %9.0f ms %13.0f ms\n", "prewarm", warm.ms,
+                msBetween(warmRelease, warmReady), msBetween(warmReady, warmDone), msBetween(warmRelease, warmDone));
+    unload(warm);
+
+    expect(msBetween(warmRelease, warmDone) < msBetween(coldRelease, coldDone),
+           "prewarm shortens release-to-text");
+    expect(!warmText.empty() && warmText == coldText, "same transcript");
+}
+
+int main(int argc, char** argv)
+{
+    standIn();
+    if (argc >= 3) compare(argv[1], argv[2]);
+    else std::printf("\n(no model and clip given: whisper comparison skipped)\n");
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+// bench_recording_journal.cpp — crash recovery and cost of the recording journal.
+//
+// Feeds 60 s of 16 kHz speech-like PCM into a RecordingJournal in 10 ms
+// blocks (the consumer-stage cadence) at 20x real time, then:
+//
+//   - "crashes": reads the file back with recover() while the journal is
+//     still open and unfinished — exactly what a process dying at that
+//     point leaves behind, since the mapped pages belong to the OS;
+//   - tears the newest header slot and checks recovery falls back to the
+//     previous one, and that a damaged sample fails the CRC;
+//   - checks finish() wipes the samples and leaves nothing to recover.
+//
+// Reports the producer-side cost per block and the writer's copy/CRC and
+// flush time per second of audio.  Exits non-zero on any failed check.
+#include "bench_check.h"
+#include "recording_journal.h"
+#include "audio_kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace ak = audio_kernels;
+using Clock = std::chrono::steady_clock;
+
+static constexpr uint32_t kRate    = 16000;
+static constexpr size_t   kBlock   = 160;     // 10 ms
+static constexpr size_t   kSeconds = 60;
+static constexpr int      kSpeedup = 20;
+
+static std::vector<float> makeSpeech(size_t n)
+{
+    std::mt19937 rng(99);
+    std::normal_distribution<float> noise(0.0f, 0.002f);
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; ++i) {
+        const float t = static_cast<float>(i) / kRate;
+        x[i] = noise(rng) + 0.12f * (0.5f + 0.5f * std::sin(6.2831853f * 2.5f * t))
+                                  * std::sin(6.2831853f * 210.0f * t);
+    }
+    return x;
+}
+
+static std::vector<float> quantised(const std::vector<float>& x, size_t n)
+{
+    std::vector<int16_t> q(n);
+    std::vector<float>   y(n);
+    ak::floatToInt16(x.data(), n, q.data());
+    ak::int16ToFloat(q.data(), n, y.data());
+    return y;
+}
+
+static std::vector<float> toVector(const PcmChain& pcm)
+{
+    std::vector<float> v(pcm.size());
+    pcm.copyTo(v.data(), 0, pcm.size());
+    return v;
+}
+
+// Flips bytes in the file at `offset` (journal closed).
+static void corrupt(const std::filesystem::path& path, size_t offset)
+{
+    std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekg(static_cast<std::streamoff>(offset));
+    char c = 0;
+    f.read(&c, 1);
+    c = static_cast<char>(c ^ 0x5A);
+    f.seekp(static_cast<std::streamoff>(offset));
+    f.write(&c, 1);
+}
+
+int main()
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "flowon_bench.journal";
+    std::filesystem::remove(path);
+
+    const size_t total = size_t{kRate} * kSeconds;
+    const std::vector<float> src = makeSpeech(total);
+
+    RecordingJournal journal;
+    if (!journal.open(path, kRate, 315)) {
+        std::printf("cannot map %s\n", path.string().c_str());
+        return 1;
+    }
+    journal.begin();
+
+    // Producer: 10 ms blocks, paced at kSpeedup x real time.
+    double appendUs = 0.0, worstUs = 0.0;
+    const auto start = Clock::now();
+    const auto period = std::chrono::microseconds(10000 / kSpeedup);
+    for (size_t pos = 0, i = 0; pos < total; pos += kBlock, ++i) {
+        std::this_thread::sleep_until(start + period * i);
+        const auto t0 = Clock::now();
+        journal.append(src.data() + pos, std::min(kBlock, total - pos));
+        const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        appendUs += us;
+        worstUs   = std::max(worstUs, us);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));   // > one writer pass
+    const RecordingJournal::Stats st = journal.stats();
+
+    std::printf("Recovery\n");
+    {
+        PcmChain pcm;
+        RecordingJournal::Recovered info;
+        const bool ok = RecordingJournal::recover(path, pcm, info);
+        expect(ok, "unfinished recording recovered while still open");
+        expect(ok && pcm.size() == total && toVector(pcm) == quantised(src, total),
+               "recovered samples equal the quantised input");
+        expect(ok && info.sampleRate == kRate && !info.lossy && !info.truncated,
+               "header: 16 kHz, not lossy, not truncated");
+    }
+
+    // One more block makes a newer header; tearing it must fall back to the
+    // previous slot, which still describes a CRC-valid prefix.
+    journal.append(src.data(), kBlock);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    journal.close();
+    {
+        PcmChain pcm;
+        RecordingJournal::Recovered info;
+        const bool full = RecordingJournal::recover(path, pcm, info) && pcm.size() == total + kBlock;
+        expect(full, "recording survives close() without finish()");
+
+        std::ifstream f(path, std::ios::binary);
+        unsigned char head[128];
+        f.read(reinterpret_cast<char*>(head), sizeof(head));
+        f.close();
+        // The newest slot is whichever holds the larger sequence (bytes 8..15).
+        uint64_t s0 = 0, s1 = 0;
+        std::memcpy(&s0, head + 8, 8);
+        std::memcpy(&s1, head + 64 + 8, 8);
+        corrupt(path, (s0 > s1 ? 0 : 64) + 24);   // a byte of its sample count
+        const bool prev = RecordingJournal::recover(path, pcm, info);
+        expect(prev && pcm.size() == total && toVector(pcm) == quantised(src, total),
+               "torn newest header falls back to the previous one");
+
+        corrupt(path, 4096 + 2 * 1000);
+        expect(!RecordingJournal::recover(path, pcm, info), "damaged sample fails the CRC");
+        corrupt(path, 4096 + 2 * 1000);
+    }
+
+    // Reopen keeps the unfinished recording; finish() wipes it.
+    journal.open(path, kRate, 315);
+    journal.finish();
+    journal.close();
+    {
+        PcmChain pcm;
+        RecordingJournal::Recovered info;
+        expect(!RecordingJournal::recover(path, pcm, info), "nothing to recover after finish()");
+
+        std::ifstream f(path, std::ios::binary);
+        std::vector<int16_t> s(total);
+        f.seekg(4096);
+        f.read(reinterpret_cast<char*>(s.data()), static_cast<std::streamsize>(s.size() * sizeof(int16_t)));
+        expect(std::all_of(s.begin(), s.end(), [](int16_t v) { return v == 0; }),
+               "finish() zeroed the samples on disk");
+    }
+    std::filesystem::remove(path);
+
+    const double blocks = static_cast<double>(total / kBlock);
+    std::printf("\nOverhead (%zu s of audio at %dx real time, %s)\n", kSeconds, kSpeedup, ak::isaName());
+    std::printf("  append (consumer side):   %.3f us/block mean, %.1f us worst\n", appendUs / blocks, worstUs);
+    std::printf("  writer copy + CRC:        %.3f ms per s of audio (%llu passes)\n",
+                st.writeMs / kSeconds, static_cast<unsigned long long>(st.batches));
+    std::printf("  flush to disk:            %.3f ms per s of audio\n", st.flushMs / kSeconds);
+    std::printf("  dropped:                  %llu samples\n", static_cast<unsigned long long>(st.dropped));
+    if (st.dropped != 0) ++g_failures;
+
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
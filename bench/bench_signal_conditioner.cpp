@@ -0,0 +1,340 @@
+// bench_signal_conditioner.cpp — golden-output checks and cost of the
+// consumer-stage input conditioning (80 Hz high-pass + look-ahead AGC).
+//
+//   - high-pass: coefficients against the reference design, DC removal,
+//     passband / stopband gain on steady sines;
+//   - AGC: exact kDelay latency, quiet and loud speech brought to the
+//     target level, no sample over the ceiling on a sudden shout, the gain
+//     held (not pumped up) through silence;
+//   - both: bit-identical output for any block size, and process + flush
+//     returning exactly as many samples as went in;
+//   - noisy room: noise + quiet speech takes at several noise levels; the
+//     VAD's SpeechEnd must not move and the trailing noise not be lifted
+//     over the noise ceiling;
+//   - golden: summary numbers of the chain's output on a fixed signal
+//     (no RNG — sines and a linear congruential hiss), so a behavioural
+//     change shows up here before anyone hears it;
+//   - CPU: ms per second of 16 kHz audio, streamed in 30 ms blocks.
+// Exits non-zero on any failure.
+#include "bench_check.h"
+#include "signal_conditioner.h"
+#include "audio_kernels.h"
+#include "feature_extractor.h"
+#include "vad_engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+static constexpr double kPi   = 3.14159265358979;
+static constexpr float  kRate = 16000.0f;
+
+static double db(double ratio) { return 20.0 * std::log10(std::max(ratio, 1e-12)); }
+
+static std::vector<float> sine(size_t n, double hz, double amp, double offset = 0.0)
+{
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; ++i)
+        x[i] = static_cast<float>(offset + amp * std::sin(2.0 * kPi * hz * static_cast<double>(i) / kRate));
+    return x;
+}
+
+// Deterministic "speech": voiced bursts (220 Hz harmonics under a syllable
+// envelope) at the given level, 400 ms pauses of hiss (peak-to-peak
+// `hiss`; 0.002 is ~0.0006 RMS), plus a DC offset.
+static std::vector<float> speechLike(size_t n, float level, uint32_t seed = 1, float hissPp = 0.002f)
+{
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const float hiss = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * hissPp;
+        const double t   = static_cast<double>(i) / kRate;
+        const bool   on  = std::fmod(t, 1.6) < 1.2;
+        const double env = 0.6 + 0.4 * std::sin(2.0 * kPi * 4.0 * t);
+        const double v   = std::sin(2 * kPi * 220 * t) + 0.5 * std::sin(2 * kPi * 440 * t)
+                         + 0.25 * std::sin(2 * kPi * 1320 * t);
+        x[i] = 0.01f + hiss + (on ? static_cast<float>(level * 1.2 * env * v) : 0.0f);
+    }
+    return x;
+}
+
+// Whole-signal run through HPF + AGC in `block`-sized pieces, flushed.
+static std::vector<float> runChain(const std::vector<float>& in, size_t block)
+{
+    Biquad hpf = Biquad::highPass(80.0f, kRate);
+    LookaheadAgc agc;
+    std::vector<float> tmp(block), out(in.size() + LookaheadAgc::kDelay + LookaheadAgc::kHop);
+    size_t produced = 0;
+    for (size_t i = 0; i < in.size(); i += block) {
+        const size_t n = std::min(block, in.size() - i);
+        hpf.process(in.data() + i, tmp.data(), n);
+        produced += agc.process(tmp.data(), n, out.data() + produced);
+    }
+    produced += agc.flush(out.data() + produced);
+    out.resize(produced);
+    return out;
+}
+
+static void checkHighPass()
+{
+    std::printf("High-pass (80 Hz, Q 0.707)\n");
+    const Biquad f = Biquad::highPass(80.0f, kRate);
+    // Reference values from the RBJ cookbook formulas in double precision.
+    const bool coeffs = std::fabs(f.b0 - 0.97803048f) < 1e-6f && std::fabs(f.b1 + 1.95606096f) < 1e-6f
+                     && std::fabs(f.a1 + 1.95557824f) < 1e-6f && std::fabs(f.a2 - 0.95654368f) < 1e-6f;
+    expect(coeffs, "coefficients match reference design");
+
+    auto gainDb = [](double hz, double offset = 0.0) {
+        Biquad h = Biquad::highPass(80.0f, kRate);
+        std::vector<float> x = sine(16000, hz, 0.1, offset), y(x.size());
+        h.process(x.data(), y.data(), x.size());
+        return db(audio_kernels::rms(y.data() + 8000, 8000) / (0.1 / std::sqrt(2.0)));
+    };
+    const double g20 = gainDb(20), g50 = gainDb(50), g1k = gainDb(1000), g4k = gainDb(4000);
+    std::printf("  gain: 20 Hz %.1f dB, 50 Hz %.1f dB, 1 kHz %.2f dB, 4 kHz %.2f dB\n", g20, g50, g1k, g4k);
+    expect(g20 < -23.0, "20 Hz rumble attenuated > 23 dB");
+    expect(g50 < -8.0 && g50 > -9.0, "50 Hz hum at -8.3 dB (Butterworth)");
+    expect(std::fabs(g1k) < 0.05 && std::fabs(g4k) < 0.05, "speech band flat within 0.05 dB");
+
+    Biquad h = Biquad::highPass(80.0f, kRate);
+    std::vector<float> dc(16000, 0.25f), y(dc.size());
+    h.process(dc.data(), y.data(), dc.size());
+    expect(audio_kernels::peakAbs(y.data() + 1600, 16000 - 1600) < 1e-3f, "0.25 DC offset gone after 100 ms");
+}
+
+static void checkAgc()
+{
+    std::printf("Look-ahead AGC\n");
+    using Agc = LookaheadAgc;
+
+    // Latency: a tone already at target level passes at unity, kDelay late.
+    {
+        Agc agc;
+        std::vector<float> x = sine(32000, 1000, 0.1 * std::sqrt(2.0)), y(x.size() + Agc::kHop);
+        const size_t n = agc.process(x.data(), x.size(), y.data());
+        float err = 0.0f;
+        for (size_t i = 16000; i < n; ++i) err = std::max(err, std::fabs(y[i] - x[i - Agc::kDelay]));
+        expect(n == x.size() - Agc::kDelay && err < 2e-3f, "target-level tone: unity gain, exactly 30 ms late");
+    }
+
+    // Quiet and loud talkers land on the target (in a quiet room, so the
+    // noise floor leaves the quiet one all the gain it needs).
+    for (float level : { 0.015f, 0.4f }) {
+        Agc agc;
+        std::vector<float> x = speechLike(16000 * 8, level, 1, 0.0002f), y(x.size() + Agc::kHop);
+        Biquad h = Biquad::highPass(80.0f, kRate);
+        h.process(x.data(), x.data(), x.size());
+        const size_t n = agc.process(x.data(), x.size(), y.data());
+        // RMS over the voiced parts of the last 3.2 s.
+        double sum = 0.0; size_t cnt = 0;
+        for (size_t i = n - 16000 * 16 / 5; i < n; ++i) {
+            if (std::fmod(static_cast<double>(i) / kRate, 1.6) >= 1.2) continue;
+            sum += static_cast<double>(y[i]) * y[i];
+            ++cnt;
+        }
+        const double outDb = db(std::sqrt(sum / cnt) / 0.1);
+        char what[80];
+        std::snprintf(what, sizeof(what), "speech at %.3f rms -> %+.1f dB from target", level, outDb);
+        expect(std::fabs(outDb) < 2.0, what);
+    }
+
+    // A shout right after quiet speech: the cut is in place before it lands.
+    {
+        Agc agc;
+        std::vector<float> x = speechLike(16000 * 4, 0.015f);
+        std::vector<float> loud = sine(8000, 300, 0.9);
+        x.insert(x.end(), loud.begin(), loud.end());
+        std::vector<float> y(x.size() + Agc::kDelay + Agc::kHop);
+        size_t n = agc.process(x.data(), x.size(), y.data());
+        n += agc.flush(y.data() + n);
+        const float peak = audio_kernels::peakAbs(y.data(), n);
+        char what[80];
+        std::snprintf(what, sizeof(what), "0.9 shout after quiet speech: peak %.3f <= 0.95", peak);
+        expect(n == x.size() && peak <= 0.95f + 1e-4f, what);
+    }
+
+    // The same quiet talker in an ordinary room: the gain stops where the
+    // hiss would reach the noise ceiling.
+    {
+        Agc agc;
+        std::vector<float> x = speechLike(16000 * 8, 0.015f), y(x.size() + Agc::kHop);
+        Biquad h = Biquad::highPass(80.0f, kRate);
+        h.process(x.data(), x.data(), x.size());
+        agc.process(x.data(), x.size(), y.data());
+        const float noise = agc.noiseFloor() * agc.gain();
+        char what[80];
+        std::snprintf(what, sizeof(what), "hiss %.4f rms: gain %.2f, floor lifted to %.4f", agc.noiseFloor(),
+                      agc.gain(), noise);
+        expect(noise <= Agc::Params{}.noiseCeiling * 1.01f && agc.gain() > 2.0f, what);
+    }
+
+    // Long silence after speech must not crank the gain up.
+    {
+        Agc agc;
+        std::vector<float> x = speechLike(16000 * 3, 0.05f);
+        Biquad h = Biquad::highPass(80.0f, kRate);
+        h.process(x.data(), x.data(), x.size());
+        x.resize(16000 * 13, 0.0f);
+        std::vector<float> y(x.size() + Agc::kHop);
+        agc.process(x.data(), 16000 * 3, y.data());
+        const float before = agc.gain();
+        agc.process(x.data() + 16000 * 3, 16000 * 10, y.data());
+        expect(std::fabs(agc.gain() - before) < 0.05f * before, "10 s of silence: gain held");
+    }
+}
+
+static void checkStreaming()
+{
+    std::printf("Streaming\n");
+    const std::vector<float> x = speechLike(16000 * 5 + 77, 0.03f);
+    const std::vector<float> ref = runChain(x, x.size());
+    bool same = true;
+    for (size_t block : { 1, 7, 160, 333, 480 }) {
+        const std::vector<float> y = runChain(x, block);
+        same = same && y == ref;
+    }
+    expect(same, "bit-identical for block sizes 1, 7, 160, 333, 480");
+
+    bool lengths = true;
+    for (size_t len : { 0, 1, 159, 160, 161, 479, 480, 481, 640, 16003 }) {
+        const std::vector<float> in(len, 0.1f);
+        lengths = lengths && runChain(in, 100).size() == len;
+    }
+    expect(lengths, "process + flush returns every sample (0 .. 16003)");
+
+    // A second recording on the same AGC: the first block already sits at
+    // the learnt level instead of ramping up from unity again.
+    LookaheadAgc agc;
+    std::vector<float> hp(x.size()), y(x.size() + LookaheadAgc::kHop);
+    Biquad h = Biquad::highPass(80.0f, kRate);
+    h.process(x.data(), hp.data(), x.size());
+    agc.process(hp.data(), hp.size(), y.data());
+    const float learnt = agc.gain();
+    agc.resetStream();
+    expect(agc.gain() == learnt && learnt > 2.0f, "resetStream keeps the learnt gain");
+}
+
+static void checkGolden()
+{
+    std::printf("Golden output\n");
+    const std::vector<float> x = speechLike(16000 * 6, 0.02f, 7);
+    const std::vector<float> y = runChain(x, 480);
+    double sum = 0.0, sumAbs = 0.0;
+    for (float v : y) { sum += v; sumAbs += std::fabs(v); }
+    const float rms  = audio_kernels::rms(y.data(), y.size());
+    const float peak = audio_kernels::peakAbs(y.data(), y.size());
+    const float early = audio_kernels::rms(y.data() + 1600, 8000);   // while the level settles
+    std::printf("  n %zu  sum %.6f  sum|x| %.4f  rms %.7f  peak %.7f  early rms %.7f\n",
+                y.size(), sum, sumAbs, rms, peak, early);
+
+    // Captured from the reference implementation; tolerances allow for
+    // FMA contraction and summation order across compilers.
+    constexpr double kSumAbs = 2167.4465, kRms = 0.0359533, kPeak = 0.1356950, kEarly = 0.0128269;
+    auto close = [](double a, double b) { return std::fabs(a - b) <= 1e-4 * std::fabs(b); };
+    expect(y.size() == x.size() && std::fabs(sum) / y.size() < 1e-4, "length preserved, DC removed");
+    expect(close(sumAbs, kSumAbs) && close(rms, kRms) && close(peak, kPeak) && close(early, kEarly),
+           "matches recorded golden values");
+}
+
+// Room noise at a given RMS, Gaussian-ish (sum of four uniforms), no RNG.
+static std::vector<float> roomNoise(size_t n, float rms, uint32_t seed)
+{
+    std::vector<float> x(n);
+    for (float& v : x) {
+        float sum = 0.0f;
+        for (int k = 0; k < 4; ++k) {
+            seed = seed * 1664525u + 1013904223u;
+            sum += static_cast<float>(seed >> 8) / 16777216.0f - 0.5f;
+        }
+        v = sum * rms * std::sqrt(3.0f);   // four uniforms: variance 1/3
+    }
+    return x;
+}
+
+// SpeechEnd frame of one take, or SIZE_MAX.
+static size_t speechEnd(const std::vector<float>& take, VadEngine& vad)
+{
+    FeatureExtractor fx;
+    vad.resetSession();
+    size_t end = SIZE_MAX;
+    for (size_t off = 0; off < take.size(); off += 480) {
+        const size_t added = fx.push(take.data() + off, std::min<size_t>(480, take.size() - off));
+        const auto&  all   = fx.frames();
+        for (size_t i = all.size() - added; i < all.size(); ++i)
+            if (vad.process(all[i]) == VadEvent::SpeechEnd && end == SIZE_MAX) end = i;
+        fx.setVoicedThreshold(vad.voicedThreshold());
+    }
+    return end;
+}
+
+static void checkNoisyRoom()
+{
+    // Three takes in a row per room — 1 s of noise, 3 s of quiet speech (~0.02 RMS),
+    // 3 s of noise — through the chain and straight to the VAD.  The
+    // conditioned takes must end where the raw ones do (within 100 ms), and the trailing noise must not come out louder than
+    // the noise ceiling or the room, whichever is higher.
+    std::printf("Noisy room, VAD SpeechEnd (3 takes each)\n");
+    for (float sigma : { 0.001f, 0.002f, 0.003f, 0.006f }) {
+        Biquad hpf = Biquad::highPass(80.0f, kRate);
+        LookaheadAgc agc;
+        VadEngine rawVad, condVad;
+        bool   same  = true;
+        float  worst = 0.0f;
+        double moved = 0.0;
+        for (uint32_t take = 0; take < 3; ++take) {
+            std::vector<float> x = roomNoise(16000 * 7, sigma, 11 + take);
+            const std::vector<float> speech = speechLike(16000 * 3, 0.03f, 3 + take, 0.0f);
+            for (size_t i = 0; i < speech.size(); ++i) x[16000 + i] += speech[i] - 0.01f;   // no DC
+
+            std::vector<float> tmp(x.size()), y(x.size() + LookaheadAgc::kDelay + LookaheadAgc::kHop);
+            hpf.process(x.data(), tmp.data(), x.size());
+            size_t n = agc.process(tmp.data(), tmp.size(), y.data());
+            n += agc.flush(y.data() + n);
+            y.resize(n);
+
+            const size_t rawEnd  = speechEnd(x, rawVad);
+            const size_t condEnd = speechEnd(y, condVad);
+            const double delta   = rawEnd == SIZE_MAX || condEnd == SIZE_MAX ? INFINITY   // never ended
+                                 : (static_cast<double>(condEnd) - static_cast<double>(rawEnd)) * 10.0;
+            same  = same && std::fabs(delta) <= 100.0;
+            moved = std::max(moved, std::fabs(delta));
+            worst = std::max(worst, audio_kernels::rms(y.data() + y.size() - 16000, 16000));
+        }
+        char what[96];
+        std::snprintf(what, sizeof(what), "noise %.3f: SpeechEnd moved <= %.0f ms, tail %.4f rms, gain %.2f",
+                      sigma, moved, worst, agc.gain());
+        expect(same && worst <= std::max(LookaheadAgc::Params{}.noiseCeiling, sigma) * 1.15f, what);
+    }
+}
+
+int main()
+{
+    checkHighPass();
+    checkAgc();
+    checkStreaming();
+    checkGolden();
+    checkNoisyRoom();
+
+    // CPU: 60 s streamed in 30 ms blocks, as the consumer stage does.
+    const std::vector<float> x = speechLike(16000 * 60, 0.03f);
+    std::vector<float> tmp(480), out(480 + LookaheadAgc::kHop);
+    Biquad hpf = Biquad::highPass(80.0f, kRate);
+    LookaheadAgc agc;
+    constexpr int kReps = 5;
+    const auto t0 = Clock::now();
+    for (int r = 0; r < kReps; ++r)
+        for (size_t i = 0; i + 480 <= x.size(); i += 480) {
+            hpf.process(x.data() + i, tmp.data(), 480);
+            agc.process(tmp.data(), 480, out.data());
+        }
+    const double msPerSec = std::chrono::duration<double, std::milli>(Clock::now() - t0).count() / kReps / 60.0;
+    std::printf("\nCPU: %.3f ms per second of audio (%.3f%% of one core)\n", msPerSec, msPerSec / 10.0);
+    expect(msPerSec < 2.0, "conditioning costs < 0.2% of a core");
+
+    std::printf("\n%s\n", g_failures == 0 ? "All checks OK" : "FAILURES");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+// bench_streaming.cpp — streaming vs batch transcription: release-to-text latency.
+//
+//   bench_streaming                        local-agreement checks only
+//   bench_streaming model.bin speech.wav   checks, then the latency comparison
+//
+// The checks feed scripted pass hypotheses through LocalAgreement: words
+// commit only when two consecutive passes agree, commits never change,
+// repeats of the committed tail are dropped, and stale words are ignored.
+//
+// With a model and a recording (any file miniaudio decodes; resampled to
+// 16 kHz mono), the clip is transcribed two ways:
+//
+//   batch      — nothing happens until release, then whisper_full over the
+//                whole clip (today's path);
+//   streaming  — the clip is played in real time into StreamingDecoder,
+//                which runs a pass whenever a second of new audio is due;
+//                at release the pass in flight is cancelled and only the
+//                uncommitted tail is decoded, prompted with the committed
+//                text.
+//
+// Release-to-text is the time from the last sample to the final text.
+// Exits non-zero if a check fails.
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "bench_check.h"
+#include "decode_params.h"
+#include "local_agreement.h"
+#include "streaming_decoder.h"
+#include "whisper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+// ------------------------------------------------------------------
+// Local agreement
+// ------------------------------------------------------------------
+
+// " the quick brown" with one word per 0.4 s from `from` seconds.
+static std::vector<TimedWord> words(std::initializer_list<const char*> list, double from = 0.0)
+{
+    std::vector<TimedWord> out;
+    size_t t = static_cast<size_t>(from * 16000);
+    for (const char* w : list) {
+        out.push_back(TimedWord{ std::string(" ") + w, t, t + 6400 });
+        t += 6400;
+    }
+    return out;
+}
+
+static void agreementChecks()
+{
+    std::printf("Local agreement\n");
+    LocalAgreement la;
+
+    expect(la.insert(words({ "the", "quick" })) == 0 && la.committedText().empty(),
+           "first pass commits nothing");
+    expect(la.insert(words({ "the", "quick", "brown" })) == 2 && la.committedText() == "the quick",
+           "second pass commits the agreed prefix");
+    expect(la.tentativeText() == "brown", "disagreeing tail stays tentative");
+
+    // Re-decoded from the committed point: a repeat of "quick" plus the rest.
+    la.insert(words({ "quick", "brown", "fox", "jumps" }, 0.4));
+    expect(la.committedText() == "the quick brown", "repeat of the committed tail is dropped");
+
+    // The next pass revises the last word; only agreed words commit.
+    la.insert(words({ "fox", "jumped", "over" }, 1.2));
+    expect(la.committedText() == "the quick brown fox", "revised word is not committed");
+    expect(la.tentativeText() == "jumped over", "tentative follows the newest pass");
+
+    // Words ending before the committed audio are ignored.
+    la.insert(words({ "the", "quick", "brown", "fox", "jumped", "over", "the" }, 0.0));
+    expect(la.committedText() == "the quick brown fox jumped over", "stale words from an old window ignored");
+
+    // Punctuation and case do not block agreement.
+    LocalAgreement p;
+    p.insert({ TimedWord{ " Hello,", 0, 6400 }, TimedWord{ " world", 6400, 12800 } });
+    p.insert({ TimedWord{ " hello", 0, 6400 }, TimedWord{ " World.", 6400, 12800 } });
+    expect(p.committedText() == "hello World.", "case and punctuation ignored when comparing");
+    expect(p.committedEnd() == 12800, "committed end is the last word's end");
+    expect(p.prompt(8) == "World.", "prompt keeps whole words from the end");
+}
+
+// ------------------------------------------------------------------
+// Whisper comparison
+// ------------------------------------------------------------------
+
+static std::string decode(whisper_context* ctx, whisper_state* state, const float* x, size_t n,
+                          const std::string& prompt = {})
+{
+    if (n < 4000) return {};
+    whisper_full_params p = clipDecodeParams(n, 1);
+    if (!prompt.empty()) p.initial_prompt = prompt.c_str();
+    if (whisper_full_with_state(ctx, state, p, x, static_cast<int>(n)) != 0) return {};
+    std::string out;
+    for (int i = 0; i < whisper_full_n_segments_from_state(state); ++i)
+        out += whisper_full_get_segment_text_from_state(state, i);
+    return out;
+}
+
+static bool loadClip(const char* path, std::vector<float>& pcm)
+{
+    ma_decoder_config cfg = ma_decoder_config_init(ma_format_f32, 1, 16000);
+    ma_uint64 frames = 0;
+    void* data = nullptr;
+    if (ma_decode_file(path, &cfg, &frames, &data) != MA_SUCCESS) return false;
+    pcm.assign(static_cast<float*>(data), static_cast<float*>(data) + frames);
+    ma_free(data, nullptr);
+    return true;
+}
+
+// Cancels `token` at `at` unless disarmed first — the hotkey release
+// arriving while a pass is running.
+class ReleaseTimer {
+public:
+    ReleaseTimer(CancelToken& token, Clock::time_point at)
+        : m_thread([this, &token, at] {
+              std::unique_lock<std::mutex> lock(m_m);
+              if (!m_cv.wait_until(lock, at, [this] { return m_disarmed; }))
+                  token.request(CancelToken::Reason::Cancelled);
+          }) {}
+    ~ReleaseTimer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_m);
+            m_disarmed = true;
+        }
+        m_cv.notify_one();
+        m_thread.join();
+    }
+
+private:
+    std::mutex              m_m;
+    std::condition_variable m_cv;
+    bool                    m_disarmed = false;
+    std::thread             m_thread;
+};
+
+static void compare(const char* modelPath, const char* clipPath)
+{
+    std::vector<float> clip;
+    if (!loadClip(clipPath, clip)) {
+        std::printf("\ncannot decode %s\n", clipPath);
+        ++g_failures;
+        return;
+    }
+    whisper_context_params cp = whisper_context_default_params();
+    cp.use_gpu = false;
+    whisper_context* ctx = whisper_init_from_file_with_params(modelPath, cp);
+    if (!ctx) {
+        std::printf("\ncannot load %s\n", modelPath);
+        ++g_failures;
+        return;
+    }
+    whisper_state* state = whisper_init_state(ctx);
+    const double clipSec = static_cast<double>(clip.size()) / 16000.0;
+    std::printf("\n%s, %.1f s, %d threads\n", clipPath, clipSec,
+                std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1));
+
+    decode(ctx, state, clip.data(), std::min<size_t>(clip.size(), 32000));   // warm-up
+
+    // Batch: everything after release.
+    const auto b0 = Clock::now();
+    const std::string batchText = decode(ctx, state, clip.data(), clip.size());
+    const double batchMs = msSince(b0);
+
+    // Streaming: real-time playback into the decoder, passes as they fall due.
+    StreamingDecoder decoder;
+    whisper_full_params passBase = baseDecodeParams(1);   // as Transcriber::runPass
+    passBase.max_tokens = 128;
+    const auto start   = Clock::now();
+    const auto release = start + std::chrono::microseconds(static_cast<long long>(clipSec * 1e6));
+    size_t fed = 0;
+    double overrunMs = 0.0;
+    uint32_t cancelled = 0;
+    while (fed < clip.size()) {
+        const size_t due = std::min(clip.size(),
+            static_cast<size_t>(msSince(start) * 16.0));
+        if (due > fed) {
+            decoder.append(clip.data() + fed, due - fed);
+            fed = due;
+        }
+        if (fed < clip.size() && decoder.passDue()) {
+            CancelToken token;
+            ReleaseTimer timer(token, release);
+            decoder.pass(ctx, state, passBase, token);
+            if (token.requested()) {
+                ++cancelled;
+                overrunMs = std::max(0.0, std::chrono::duration<double, std::milli>(Clock::now() - release).count());
+            }
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    std::this_thread::sleep_until(release);
+    // Release: the pass in flight (if any) was cancelled above; decode the tail.
+    const auto r0   = Clock::now();
+    const StreamingDecoder::Tail snapshot = decoder.tail();
+    const size_t from = snapshot.begin;
+    std::string streamText = snapshot.committed;
+    const std::string tail = decode(ctx, state, clip.data() + from, clip.size() - from, snapshot.prompt);
+    if (!tail.empty()) {
+        if (!streamText.empty() && tail.front() != ' ') streamText += ' ';
+        streamText += tail;
+    }
+    const double streamMs = msSince(r0) + overrunMs;
+
+    const StreamingDecoder::Stats st = decoder.stats();
+    std::printf("  batch:     %8.0f ms release-to-text\n", batchMs);
+    std::printf("  streaming: %8.0f ms release-to-text (tail %.2f s of %.2f s; %u passes, %.0f ms total, %u cancelled at release)\n",
+                streamMs, static_cast<double>(clip.size() - from) / 16000.0, clipSec,
+                st.passes, st.passMs, cancelled);
+    std::printf("  batch text:     %s\n", batchText.c_str());
+    std::printf("  streaming text: %s\n", streamText.c_str());
+    expect(streamMs < batchMs || clipSec < 3.0, "streaming is faster after release (clips >= 3 s)");
+
+    whisper_free_state(state);
+    whisper_free(ctx);
+}
+
+int main(int argc, char** argv)
+{
+    agreementChecks();
+    if (argc >= 3) compare(argv[1], argv[2]);
+    else std::printf("\n(no model and clip given: latency comparison skipped)\n");
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
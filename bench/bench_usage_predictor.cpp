@@ -0,0 +1,189 @@
+// bench_usage_predictor.cpp — predictive warm-up vs the fixed idle timer.
+//
+//   bench_usage_predictor
+//
+// Simulates a user minute by minute for five weeks: dictating often from
+// 9 to 12 in an editor and from 14 to 17 in a mail client, rarely
+// otherwise, never at night.  UsagePredictor learns from the first three
+// weeks; the last two are scored twice:
+//
+//   fixed       — load on use, unload after 120 s without one (today);
+//   predictive  — the same, plus the predictor's advice every minute:
+//                 Preload loads and holds the model, Prefetch warms the
+//                 page cache, Evict unloads 30 s after the last use.
+//
+// Prints cold starts (dictations that had to load the model), how many of
+// those read the file from disk, hours with the weights loaded, and the
+// predictor's warm-up hit rate.  Checks the likelihood shape (busy hours,
+// anticipation before an hour starts, the app factor), a save/load round
+// trip, and that prediction cuts cold starts.
+// Exits non-zero if a check fails.
+#include "bench_check.h"
+#include "usage_predictor.h"
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+// ------------------------------------------------------------------
+// Synthetic user
+// ------------------------------------------------------------------
+
+static uint64_t g_rng = 0x9E3779B97F4A7C15ull;
+
+static double uniform()
+{
+    g_rng ^= g_rng << 13; g_rng ^= g_rng >> 7; g_rng ^= g_rng << 17;
+    return static_cast<double>(g_rng >> 11) / 9007199254740992.0;
+}
+
+static const char* appAt(int minuteOfDay)
+{
+    const int h = minuteOfDay / 60;
+    if (h >= 9 && h < 12)  return "code.exe";
+    if (h >= 14 && h < 17) return "outlook.exe";
+    return "explorer.exe";
+}
+
+// Dictations per minute.
+static double rateAt(int minuteOfDay)
+{
+    const int h = minuteOfDay / 60;
+    if (h >= 9 && h < 12)  return 0.08;
+    if (h >= 14 && h < 17) return 0.05;
+    if (h >= 7 && h < 22)  return 0.003;
+    return 0.0;
+}
+
+// ------------------------------------------------------------------
+// Policies
+// ------------------------------------------------------------------
+
+struct Policy {
+    bool     loaded      = false;
+    bool     cached      = false;   // model file in the page cache
+    uint64_t lastUse     = 0;       // minute
+    uint64_t coldStarts  = 0;
+    uint64_t diskLoads   = 0;       // cold starts that also read the disk
+    uint64_t uses        = 0;
+    uint64_t loadedMin   = 0;
+
+    void use(uint64_t minute)
+    {
+        ++uses;
+        if (!loaded) {
+            ++coldStarts;
+            if (!cached) ++diskLoads;
+        }
+        loaded  = true;
+        cached  = true;
+        lastUse = minute;
+    }
+};
+
+static constexpr int kTrainDays = 21;
+static constexpr int kScoreDays = 14;
+
+static void simulate()
+{
+    std::printf("Simulated user, %d days of training, %d scored\n", kTrainDays, kScoreDays);
+    UsagePredictor predictor;
+    Policy fixed, predictive;
+
+    for (uint64_t minute = 0; minute < static_cast<uint64_t>(kTrainDays + kScoreDays) * 1440; ++minute) {
+        const int  mod     = static_cast<int>(minute % 1440);
+        const bool scoring = minute >= static_cast<uint64_t>(kTrainDays) * 1440;
+        const std::string app = appAt(mod);
+        const uint64_t nowMs = minute * 60000;
+
+        // The page cache forgets the file after a few hours unused.
+        for (Policy* p : { &fixed, &predictive })
+            if (!p->loaded && minute - p->lastUse > 240) p->cached = false;
+
+        // Predictive policy acts before this minute's dictation.
+        bool hold = false;
+        if (scoring) {
+            predictor.expire(nowMs);
+            switch (predictor.advise(mod, app)) {
+            case UsagePredictor::Advice::Preload:
+                if (!predictive.loaded) {
+                    predictive.loaded = predictive.cached = true;
+                    predictor.warmedUp(nowMs);
+                }
+                hold = true;
+                break;
+            case UsagePredictor::Advice::Prefetch:
+                predictive.cached = true;
+                break;
+            case UsagePredictor::Advice::Evict:
+                if (predictive.loaded && minute - predictive.lastUse >= 1) predictive.loaded = false;
+                break;
+            case UsagePredictor::Advice::Normal:
+                break;
+            }
+        }
+
+        const bool dictates = uniform() < rateAt(mod);
+        if (dictates) {
+            predictor.recordUse(mod, app, nowMs, !scoring || predictive.loaded);
+            if (scoring) {
+                fixed.use(minute);
+                predictive.use(minute);
+            }
+        }
+        predictor.observe(mod, app, 1.0);
+
+        if (!scoring) continue;
+        if (fixed.loaded && minute - fixed.lastUse >= 2) fixed.loaded = false;
+        if (predictive.loaded && !hold && minute - predictive.lastUse >= 2) predictive.loaded = false;
+        fixed.loadedMin      += fixed.loaded;
+        predictive.loadedMin += predictive.loaded;
+    }
+
+    std::printf("  %-12s %8s %12s %12s %16s\n", "policy", "uses", "cold starts", "from disk", "loaded h/day");
+    for (const auto& [name, p] : { std::pair<const char*, const Policy*>{ "fixed", &fixed },
+                                   std::pair<const char*, const Policy*>{ "predictive", &predictive } })
+        std::printf("  %-12s %8llu %12llu %12llu %16.1f\n", name,
+                    static_cast<unsigned long long>(p->uses), static_cast<unsigned long long>(p->coldStarts),
+                    static_cast<unsigned long long>(p->diskLoads), p->loadedMin / 60.0 / kScoreDays);
+    const UsagePredictor::Stats& s = predictor.stats();
+    std::printf("  warm-ups %u: %u hits, %u misses (%.0f%% hit rate)\n",
+                s.warmUps, s.hits, s.misses, 100.0 * s.hitRate());
+
+    expect(predictive.coldStarts < fixed.coldStarts, "prediction cuts cold starts");
+    expect(predictive.diskLoads <= fixed.diskLoads, "no more loads from disk than the fixed timer");
+    expect(s.hitRate() >= 0.5, "at least half of the warm-ups are used");
+
+    // Likelihood shape.
+    const double busy    = predictor.likelihood(10 * 60, "code.exe");
+    const double night   = predictor.likelihood(3 * 60, "explorer.exe");
+    const double early   = predictor.likelihood(8 * 60 + 30, "explorer.exe");
+    const double justPre = predictor.likelihood(8 * 60 + 57, "explorer.exe");
+    const double otherApp = predictor.likelihood(10 * 60, "explorer.exe");
+    std::printf("  P(dictation in %.0f min): 10:00 editor %.2f, 10:00 explorer %.2f, 08:30 %.3f, 08:57 %.3f, 03:00 %.3f\n",
+                UsagePredictor::kHorizonMin, busy, otherApp, early, justPre, night);
+    expect(busy > 0.2 && night < 0.01, "busy hours likely, nights not");
+    expect(justPre > early, "a busy hour is anticipated before it starts");
+    expect(busy > otherApp, "the usual app raises the likelihood");
+
+    // Persistence.
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "flowon_bench_usage.json";
+    UsagePredictor reloaded;
+    const bool io = predictor.save(path) && reloaded.load(path);
+    expect(io && std::fabs(reloaded.likelihood(10 * 60, "code.exe") - busy) < 1e-9
+              && reloaded.stats().hits == s.hits && reloaded.stats().misses == s.misses,
+           "save/load round trip keeps counts and scores");
+    std::filesystem::remove(path);
+
+    UsagePredictor fresh;
+    expect(fresh.advise(10 * 60, "code.exe") == UsagePredictor::Advice::Normal,
+           "no history: configured timeouts");
+}
+
+int main()
+{
+    simulate();
+    std::printf("\n%s\n", g_failures == 0 ? "OK" : "FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
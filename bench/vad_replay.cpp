@@ -0,0 +1,112 @@
+// vad_replay.cpp — replays PCM through FeatureExtractor + VadEngine.
+//
+//   vad_replay                 synthetic noise/speech/noise signal
+//   vad_replay clip.wav ...    any file miniaudio can decode (resampled to 16 kHz mono)
+//
+// Prints every SpeechStart/SpeechEnd with its frame time.  Each input is
+// replayed with several block sizes (the consumer stage sees whatever the
+// ring holds at each 10 ms wake-up); the events must be identical every
+// time.  Exits non-zero if they are not, or if the synthetic signal's
+// events land outside the expected windows.
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+#include "feature_extractor.h"
+#include "vad_engine.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+using Events = std::vector<std::pair<VadEvent, size_t>>;
+
+static Events replay(const std::vector<float>& pcm, size_t block)
+{
+    FeatureExtractor fx;
+    VadEngine        vad;
+    Events           out;
+    for (size_t off = 0; off < pcm.size(); off += block) {
+        const size_t n     = std::min(block, pcm.size() - off);
+        const size_t added = fx.push(pcm.data() + off, n);
+        const auto&  all   = fx.frames();
+        for (size_t i = all.size() - added; i < all.size(); ++i) {
+            const VadEvent ev = vad.process(all[i]);
+            if (ev != VadEvent::None) out.emplace_back(ev, i);
+        }
+        fx.setVoicedThreshold(vad.voicedThreshold());
+    }
+    return out;
+}
+
+static bool decode(const char* path, std::vector<float>& pcm)
+{
+    ma_decoder_config cfg = ma_decoder_config_init(ma_format_f32, 1, 16000);
+    ma_decoder dec;
+    if (ma_decoder_init_file(path, &cfg, &dec) != MA_SUCCESS) return false;
+    float buf[4096];
+    ma_uint64 got = 0;
+    while (ma_decoder_read_pcm_frames(&dec, buf, 4096, &got) == MA_SUCCESS && got > 0)
+        pcm.insert(pcm.end(), buf, buf + got);
+    ma_decoder_uninit(&dec);
+    return true;
+}
+
+// 1 s room noise, 2 s voiced bursts, 2.5 s room noise.
+static std::vector<float> synthetic()
+{
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, 0.002f);
+    std::vector<float> x(16000 * 11 / 2);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = noise(rng);
+        if (i >= 16000 && i < 48000)
+            x[i] += 0.1f * std::sin(static_cast<float>(i) * 0.09f)
+                  * (0.6f + 0.4f * std::sin(static_cast<float>(i) * 0.002f));
+    }
+    return x;
+}
+
+static bool run(const char* name, const std::vector<float>& pcm, Events& events)
+{
+    events = replay(pcm, 160);
+    bool same = true;
+    for (size_t block : { 1, 97, 480, 1600, 16000 })
+        same = same && replay(pcm, block) == events;
+
+    std::printf("%s: %.2f s, %zu events%s\n", name, pcm.size() / 16000.0, events.size(),
+                same ? "" : "  BLOCK-SIZE DEPENDENT");
+    for (const auto& e : events)
+        std::printf("  %8.2f s  %s\n", e.second * 0.01,
+                    e.first == VadEvent::SpeechStart ? "speech start" : "speech end");
+    return same;
+}
+
+int main(int argc, char** argv)
+{
+    int failures = 0;
+    Events events;
+
+    if (argc < 2) {
+        if (!run("synthetic", synthetic(), events)) ++failures;
+        // Start within 200 ms of onset; end 1.5 s (+/- 100 ms) after offset.
+        const bool ok = events.size() == 2
+            && events[0].first == VadEvent::SpeechStart
+            && events[0].second >= 100 && events[0].second <= 120
+            && events[1].first == VadEvent::SpeechEnd
+            && events[1].second >= 440 && events[1].second <= 460;
+        if (!ok) { std::printf("  UNEXPECTED EVENTS\n"); ++failures; }
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        std::vector<float> pcm;
+        if (!decode(argv[i], pcm)) {
+            std::printf("%s: cannot decode\n", argv[i]);
+            ++failures;
+            continue;
+        }
+        if (!run(argv[i], pcm, events)) ++failures;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,575 @@
+// audio_kernels.cpp
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define FLOWON_KERNELS_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define FLOWON_KERNELS_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define FLOWON_KERNELS_NEON 1
+#endif
+
+namespace audio_kernels {
+
+static constexpr float kInt16Scale = 32768.0f;
+static constexpr float kInt16Inv   = 1.0f / 32768.0f;
+
+// ------------------------------------------------------------------
+// Scalar reference implementations
+// ------------------------------------------------------------------
+namespace scalar {
+
+float sumSquares(const float* x, size_t n)
+{
+    float s = 0.0f;
+    for (size_t i = 0; i < n; ++i) s += x[i] * x[i];
+    return s;
+}
+
+float dot(const float* a, const float* b, size_t n)
+{
+    float s = 0.0f;
+    for (size_t i = 0; i < n; ++i) s += a[i] * b[i];
+    return s;
+}
+
+float peakAbs(const float* x, size_t n)
+{
+    float p = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        const float a = std::fabs(x[i]);
+        if (a > p) p = a;
+    }
+    return p;
+}
+
+size_t findFirstAbove(const float* x, size_t n, float threshold)
+{
+    for (size_t i = 0; i < n; ++i)
+        if (std::fabs(x[i]) > threshold) return i;
+    return n;
+}
+
+size_t findLastAbove(const float* x, size_t n, float threshold)
+{
+    for (size_t i = n; i > 0; --i)
+        if (std::fabs(x[i - 1]) > threshold) return i - 1;
+    return n;
+}
+
+size_t countAtOrAbove(const float* x, size_t n, float threshold)
+{
+    size_t c = 0;
+    for (size_t i = 0; i < n; ++i)
+        c += std::fabs(x[i]) >= threshold ? 1 : 0;
+    return c;
+}
+
+size_t countZeroCrossings(const float* x, size_t n)
+{
+    size_t c = 0;
+    for (size_t i = 1; i < n; ++i)
+        c += std::signbit(x[i]) != std::signbit(x[i - 1]) ? 1 : 0;
+    return c;
+}
+
+void floatToInt16(const float* x, size_t n, int16_t* out)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const float v = std::min(std::max(x[i] * kInt16Scale, -32768.0f), 32767.0f);
+        out[i] = static_cast<int16_t>(std::nearbyint(v));
+    }
+}
+
+void int16ToFloat(const int16_t* x, size_t n, float* out)
+{
+    for (size_t i = 0; i < n; ++i) out[i] = static_cast<float>(x[i]) * kInt16Inv;
+}
+
+} // namespace scalar
+
+// ------------------------------------------------------------------
+// AVX2 — 8 lanes, two accumulators to hide FMA/add latency
+// ------------------------------------------------------------------
+#if defined(FLOWON_KERNELS_AVX2)
+
+static inline __m256 abs8(__m256 v)
+{
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+// MSVC's /arch:AVX2 implies FMA3; GCC/Clang need -mfma to say so.
+static inline __m256 madd8(__m256 a, __m256 b, __m256 c)
+{
+#if defined(__FMA__) || defined(_MSC_VER)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+static inline float hsum8(__m256 v)
+{
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+    return _mm_cvtss_f32(lo);
+}
+
+static inline float hmax8(__m256 v)
+{
+    __m128 lo = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    lo = _mm_max_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_max_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+    return _mm_cvtss_f32(lo);
+}
+
+float sumSquares(const float* x, size_t n)
+{
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256 v0 = _mm256_loadu_ps(x + i);
+        const __m256 v1 = _mm256_loadu_ps(x + i + 8);
+        a0 = madd8(v0, v0, a0);
+        a1 = madd8(v1, v1, a1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v = _mm256_loadu_ps(x + i);
+        a0 = madd8(v, v, a0);
+    }
+    return hsum8(_mm256_add_ps(a0, a1)) + scalar::sumSquares(x + i, n - i);
+}
+
+float dot(const float* a, const float* b, size_t n)
+{
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        a0 = madd8(_mm256_loadu_ps(a + i),     _mm256_loadu_ps(b + i),     a0);
+        a1 = madd8(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), a1);
+    }
+    for (; i + 8 <= n; i += 8)
+        a0 = madd8(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), a0);
+    return hsum8(_mm256_add_ps(a0, a1)) + scalar::dot(a + i, b + i, n - i);
+}
+
+float peakAbs(const float* x, size_t n)
+{
+    __m256 m0 = _mm256_setzero_ps(), m1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        m0 = _mm256_max_ps(m0, abs8(_mm256_loadu_ps(x + i)));
+        m1 = _mm256_max_ps(m1, abs8(_mm256_loadu_ps(x + i + 8)));
+    }
+    for (; i + 8 <= n; i += 8)
+        m0 = _mm256_max_ps(m0, abs8(_mm256_loadu_ps(x + i)));
+    const float v    = hmax8(_mm256_max_ps(m0, m1));
+    const float tail = scalar::peakAbs(x + i, n - i);
+    return v > tail ? v : tail;
+}
+
+size_t findFirstAbove(const float* x, size_t n, float threshold)
+{
+    const __m256 t = _mm256_set1_ps(threshold);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const int mask = _mm256_movemask_ps(
+            _mm256_cmp_ps(abs8(_mm256_loadu_ps(x + i)), t, _CMP_GT_OQ));
+        if (mask) {
+            unsigned bit = 0;
+            while (!(mask & (1 << bit))) ++bit;
+            return i + bit;
+        }
+    }
+    const size_t r = scalar::findFirstAbove(x + i, n - i, threshold);
+    return r == n - i ? n : i + r;
+}
+
+size_t findLastAbove(const float* x, size_t n, float threshold)
+{
+    const __m256 t = _mm256_set1_ps(threshold);
+    size_t i = n;
+    for (; i >= 8; i -= 8) {
+        const int mask = _mm256_movemask_ps(
+            _mm256_cmp_ps(abs8(_mm256_loadu_ps(x + i - 8)), t, _CMP_GT_OQ));
+        if (mask) {
+            int bit = 7;
+            while (!(mask & (1 << bit))) --bit;
+            return i - 8 + static_cast<size_t>(bit);
+        }
+    }
+    const size_t r = scalar::findLastAbove(x, i, threshold);
+    return r == i ? n : r;
+}
+
+size_t countAtOrAbove(const float* x, size_t n, float threshold)
+{
+    // Compare masks are all-ones (-1 as int32); subtracting them counts hits.
+    const __m256 t = _mm256_set1_ps(threshold);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 ge = _mm256_cmp_ps(abs8(_mm256_loadu_ps(x + i)), t, _CMP_GE_OQ);
+        acc = _mm256_sub_epi32(acc, _mm256_castps_si256(ge));
+    }
+    alignas(32) int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    size_t c = 0;
+    for (int k = 0; k < 8; ++k) c += static_cast<uint32_t>(lanes[k]);
+    return c + scalar::countAtOrAbove(x + i, n - i, threshold);
+}
+
+size_t countZeroCrossings(const float* x, size_t n)
+{
+    // Sign bits of x[i] and x[i-1] differ exactly where their XOR has the
+    // top bit set; shift it down and add it up per lane.
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 1;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 d = _mm256_xor_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(x + i - 1));
+        acc = _mm256_add_epi32(acc, _mm256_srli_epi32(_mm256_castps_si256(d), 31));
+    }
+    alignas(32) int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    size_t c = 0;
+    for (int k = 0; k < 8; ++k) c += static_cast<uint32_t>(lanes[k]);
+    return c + (i < n ? scalar::countZeroCrossings(x + i - 1, n - i + 1) : 0);
+}
+
+void floatToInt16(const float* x, size_t n, int16_t* out)
+{
+    const __m256 s = _mm256_set1_ps(kInt16Scale), lo = _mm256_set1_ps(-32768.0f), hi = _mm256_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256i a = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(x + i), s), lo), hi));
+        const __m256i b = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(x + i + 8), s), lo), hi));
+        // packs works per 128-bit lane; put the quarters back in order.
+        const __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), p);
+    }
+    scalar::floatToInt16(x + i, n - i, out + i);
+}
+
+void int16ToFloat(const int16_t* x, size_t n, float* out)
+{
+    const __m256 s = _mm256_set1_ps(kInt16Inv);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), s));
+    }
+    scalar::int16ToFloat(x + i, n - i, out + i);
+}
+
+const char* isaName() { return "avx2"; }
+
+// ------------------------------------------------------------------
+// SSE2 — 4 lanes
+// ------------------------------------------------------------------
+#elif defined(FLOWON_KERNELS_SSE2)
+
+static inline __m128 abs4(__m128 v)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+static inline float hsum4(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+static inline float hmax4(__m128 v)
+{
+    v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+float sumSquares(const float* x, size_t n)
+{
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128 v0 = _mm_loadu_ps(x + i);
+        const __m128 v1 = _mm_loadu_ps(x + i + 4);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(v0, v0));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(v1, v1));
+    }
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(x + i);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(v, v));
+    }
+    return hsum4(_mm_add_ps(a0, a1)) + scalar::sumSquares(x + i, n - i);
+}
+
+float dot(const float* a, const float* b, size_t n)
+{
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(a + i),     _mm_loadu_ps(b + i)));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    for (; i + 4 <= n; i += 4)
+        a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    return hsum4(_mm_add_ps(a0, a1)) + scalar::dot(a + i, b + i, n - i);
+}
+
+float peakAbs(const float* x, size_t n)
+{
+    __m128 m = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        m = _mm_max_ps(m, abs4(_mm_loadu_ps(x + i)));
+    const float v    = hmax4(m);
+    const float tail = scalar::peakAbs(x + i, n - i);
+    return v > tail ? v : tail;
+}
+
+size_t findFirstAbove(const float* x, size_t n, float threshold)
+{
+    const __m128 t = _mm_set1_ps(threshold);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const int mask = _mm_movemask_ps(_mm_cmpgt_ps(abs4(_mm_loadu_ps(x + i)), t));
+        if (mask) {
+            unsigned bit = 0;
+            while (!(mask & (1 << bit))) ++bit;
+            return i + bit;
+        }
+    }
+    const size_t r = scalar::findFirstAbove(x + i, n - i, threshold);
+    return r == n - i ? n : i + r;
+}
+
+size_t findLastAbove(const float* x, size_t n, float threshold)
+{
+    const __m128 t = _mm_set1_ps(threshold);
+    size_t i = n;
+    for (; i >= 4; i -= 4) {
+        const int mask = _mm_movemask_ps(_mm_cmpgt_ps(abs4(_mm_loadu_ps(x + i - 4)), t));
+        if (mask) {
+            int bit = 3;
+            while (!(mask & (1 << bit))) --bit;
+            return i - 4 + static_cast<size_t>(bit);
+        }
+    }
+    const size_t r = scalar::findLastAbove(x, i, threshold);
+    return r == i ? n : r;
+}
+
+size_t countAtOrAbove(const float* x, size_t n, float threshold)
+{
+    const __m128 t = _mm_set1_ps(threshold);
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 ge = _mm_cmpge_ps(abs4(_mm_loadu_ps(x + i)), t);
+        acc = _mm_sub_epi32(acc, _mm_castps_si128(ge));
+    }
+    alignas(16) int32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    size_t c = 0;
+    for (int k = 0; k < 4; ++k) c += static_cast<uint32_t>(lanes[k]);
+    return c + scalar::countAtOrAbove(x + i, n - i, threshold);
+}
+
+size_t countZeroCrossings(const float* x, size_t n)
+{
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 1;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 d = _mm_xor_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(x + i - 1));
+        acc = _mm_add_epi32(acc, _mm_srli_epi32(_mm_castps_si128(d), 31));
+    }
+    alignas(16) int32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    size_t c = 0;
+    for (int k = 0; k < 4; ++k) c += static_cast<uint32_t>(lanes[k]);
+    return c + (i < n ? scalar::countZeroCrossings(x + i - 1, n - i + 1) : 0);
+}
+
+void floatToInt16(const float* x, size_t n, int16_t* out)
+{
+    const __m128 s = _mm_set1_ps(kInt16Scale), lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i a = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(x + i), s), lo), hi));
+        const __m128i b = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(x + i + 4), s), lo), hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(a, b));
+    }
+    scalar::floatToInt16(x + i, n - i, out + i);
+}
+
+void int16ToFloat(const int16_t* x, size_t n, float* out)
+{
+    // No sign-extending widen before SSE4.1: duplicate into the high half
+    // and arithmetic-shift back down.
+    const __m128 s = _mm_set1_ps(kInt16Inv);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(out + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), s));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), s));
+    }
+    scalar::int16ToFloat(x + i, n - i, out + i);
+}
+
+const char* isaName() { return "sse2"; }
+
+// ------------------------------------------------------------------
+// NEON — 4 lanes
+// ------------------------------------------------------------------
+#elif defined(FLOWON_KERNELS_NEON)
+
+float sumSquares(const float* x, size_t n)
+{
+    float32x4_t a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float32x4_t v0 = vld1q_f32(x + i);
+        const float32x4_t v1 = vld1q_f32(x + i + 4);
+        a0 = vmlaq_f32(a0, v0, v0);
+        a1 = vmlaq_f32(a1, v1, v1);
+    }
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t v = vld1q_f32(x + i);
+        a0 = vmlaq_f32(a0, v, v);
+    }
+    return vaddvq_f32(vaddq_f32(a0, a1)) + scalar::sumSquares(x + i, n - i);
+}
+
+float dot(const float* a, const float* b, size_t n)
+{
+    float32x4_t a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a0 = vmlaq_f32(a0, vld1q_f32(a + i),     vld1q_f32(b + i));
+        a1 = vmlaq_f32(a1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    for (; i + 4 <= n; i += 4)
+        a0 = vmlaq_f32(a0, vld1q_f32(a + i), vld1q_f32(b + i));
+    return vaddvq_f32(vaddq_f32(a0, a1)) + scalar::dot(a + i, b + i, n - i);
+}
+
+float peakAbs(const float* x, size_t n)
+{
+    float32x4_t m = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        m = vmaxq_f32(m, vabsq_f32(vld1q_f32(x + i)));
+    const float v    = vmaxvq_f32(m);
+    const float tail = scalar::peakAbs(x + i, n - i);
+    return v > tail ? v : tail;
+}
+
+size_t findFirstAbove(const float* x, size_t n, float threshold)
+{
+    const float32x4_t t = vdupq_n_f32(threshold);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        if (vmaxvq_u32(vcgtq_f32(vabsq_f32(vld1q_f32(x + i)), t)))
+            return i + scalar::findFirstAbove(x + i, 4, threshold);
+    }
+    const size_t r = scalar::findFirstAbove(x + i, n - i, threshold);
+    return r == n - i ? n : i + r;
+}
+
+size_t findLastAbove(const float* x, size_t n, float threshold)
+{
+    const float32x4_t t = vdupq_n_f32(threshold);
+    size_t i = n;
+    for (; i >= 4; i -= 4) {
+        if (vmaxvq_u32(vcgtq_f32(vabsq_f32(vld1q_f32(x + i - 4)), t)))
+            return i - 4 + scalar::findLastAbove(x + i - 4, 4, threshold);
+    }
+    const size_t r = scalar::findLastAbove(x, i, threshold);
+    return r == i ? n : r;
+}
+
+size_t countAtOrAbove(const float* x, size_t n, float threshold)
+{
+    const float32x4_t t = vdupq_n_f32(threshold);
+    uint32x4_t acc = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        acc = vsubq_u32(acc, vcgeq_f32(vabsq_f32(vld1q_f32(x + i)), t));
+    return vaddvq_u32(acc) + scalar::countAtOrAbove(x + i, n - i, threshold);
+}
+
+size_t countZeroCrossings(const float* x, size_t n)
+{
+    uint32x4_t acc = vdupq_n_u32(0);
+    size_t i = 1;
+    for (; i + 4 <= n; i += 4) {
+        const uint32x4_t d = veorq_u32(vreinterpretq_u32_f32(vld1q_f32(x + i)),
+                                       vreinterpretq_u32_f32(vld1q_f32(x + i - 1)));
+        acc = vaddq_u32(acc, vshrq_n_u32(d, 31));
+    }
+    return vaddvq_u32(acc) + (i < n ? scalar::countZeroCrossings(x + i - 1, n - i + 1) : 0);
+}
+
+void floatToInt16(const float* x, size_t n, int16_t* out)
+{
+    const float32x4_t s = vdupq_n_f32(kInt16Scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // Round to nearest even, then saturating narrow.
+        const int32x4_t a = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(x + i), s));
+        const int32x4_t b = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(x + i + 4), s));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+    scalar::floatToInt16(x + i, n - i, out + i);
+}
+
+void int16ToFloat(const int16_t* x, size_t n, float* out)
+{
+    const float32x4_t s = vdupq_n_f32(kInt16Inv);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const int16x8_t v = vld1q_s16(x + i);
+        vst1q_f32(out + i,     vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), s));
+        vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), s));
+    }
+    scalar::int16ToFloat(x + i, n - i, out + i);
+}
+
+const char* isaName() { return "neon"; }
+
+// ------------------------------------------------------------------
+// No SIMD available — forward to the reference versions
+// ------------------------------------------------------------------
+#else
+
+float  sumSquares(const float* x, size_t n)                       { return scalar::sumSquares(x, n); }
+float  dot(const float* a, const float* b, size_t n)              { return scalar::dot(a, b, n); }
+float  peakAbs(const float* x, size_t n)                          { return scalar::peakAbs(x, n); }
+size_t findFirstAbove(const float* x, size_t n, float threshold)  { return scalar::findFirstAbove(x, n, threshold); }
+size_t findLastAbove(const float* x, size_t n, float threshold)   { return scalar::findLastAbove(x, n, threshold); }
+size_t countAtOrAbove(const float* x, size_t n, float threshold)  { return scalar::countAtOrAbove(x, n, threshold); }
+size_t countZeroCrossings(const float* x, size_t n)               { return scalar::countZeroCrossings(x, n); }
+void   floatToInt16(const float* x, size_t n, int16_t* out)       { scalar::floatToInt16(x, n, out); }
+void   int16ToFloat(const int16_t* x, size_t n, float* out)       { scalar::int16ToFloat(x, n, out); }
+const char* isaName() { return "scalar"; }
+
+#endif
+
+float rms(const float* x, size_t n)
+{
+    return n > 0 ? std::sqrt(sumSquares(x, n) / static_cast<float>(n)) : 0.0f;
+}
+
+} // namespace audio_kernels
@@ -0,0 +1,56 @@
+#pragma once
+// audio_kernels.h — vectorised PCM analysis primitives.
+//
+// Every scan over captured audio (consumer-stage analysis, silence trimming,
+// resampling, int16 storage) goes through these.  The active implementation is picked at compile time:
+// AVX2 (the project builds with /arch:AVX2), SSE2, NEON, or plain scalar.
+// The scalar versions are always available as the reference.
+#include <cstddef>
+#include <cstdint>
+
+namespace audio_kernels {
+
+// Sum of x[i]^2.
+float  sumSquares(const float* x, size_t n);
+
+// Sum of a[i] * b[i] — FIR taps against a history window.
+float  dot(const float* a, const float* b, size_t n);
+
+// sqrt(sumSquares / n); 0 for an empty buffer.
+float  rms(const float* x, size_t n);
+
+// max |x[i]|; 0 for an empty buffer.
+float  peakAbs(const float* x, size_t n);
+
+// Index of the first / last sample with |x| > threshold, or n if none.
+size_t findFirstAbove(const float* x, size_t n, float threshold);
+size_t findLastAbove (const float* x, size_t n, float threshold);
+
+// Number of samples with |x| >= threshold.
+size_t countAtOrAbove(const float* x, size_t n, float threshold);
+
+// Number of sign changes between neighbouring samples (i = 1 .. n-1).
+size_t countZeroCrossings(const float* x, size_t n);
+
+// PCM sample conversion for compact int16 storage.  floatToInt16 scales by
+// 32768, rounds to nearest (ties to even) and saturates; int16ToFloat is
+// its exact inverse on every representable value.
+void   floatToInt16(const float* x, size_t n, int16_t* out);
+void   int16ToFloat(const int16_t* x, size_t n, float* out);
+
+// Name of the compiled-in implementation ("avx2", "sse2", "neon", "scalar").
+const char* isaName();
+
+namespace scalar {
+float  sumSquares    (const float* x, size_t n);
+float  dot           (const float* a, const float* b, size_t n);
+float  peakAbs       (const float* x, size_t n);
+size_t findFirstAbove(const float* x, size_t n, float threshold);
+size_t findLastAbove (const float* x, size_t n, float threshold);
+size_t countAtOrAbove(const float* x, size_t n, float threshold);
+size_t countZeroCrossings(const float* x, size_t n);
+void   floatToInt16  (const float* x, size_t n, int16_t* out);
+void   int16ToFloat  (const int16_t* x, size_t n, float* out);
+} // namespace scalar
+
+} // namespace audio_kernels
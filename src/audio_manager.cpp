@@ -1,121 +1,471 @@
 // audio_manager.cpp
-// MINIAUDIO_IMPLEMENTATION must be defined in exactly one translation unit.
-#define MINIAUDIO_IMPLEMENTATION
 #include "audio_manager.h"
-#include "overlay.h"        // for g_overlayPtr->pushRMS
-
-#include "miniaudio.h"
-#include "readerwriterqueue.h"
+#include "capture_ring.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 
 // ------------------------------------------------------------------
-// Forward-declared global overlay pointer (defined in main.cpp).
-// The audio callback runs on a time-critical thread; calling pushRMS
-// is a single atomic store — safe from any thread.
+// Each AudioManager owns a wait-free SPSC block ring (see init()): 15
+// seconds of 16 kHz PCM per channel.  The audio thread publishes each
+// period with one bulk copy; the consumer pulls everything out the same
+// way.  Once the ring is full the callback spills into preallocated 1 s
+// overflow pages, so long dictations are kept whole; samples are only
+// dropped past the hard cap below.
 // ------------------------------------------------------------------
-extern Overlay* g_overlayPtr;
+static constexpr size_t kRingSec     = 15;
+static constexpr size_t kMaxSpillSec = 300;   // hard cap: 5 min beyond the ring (~19 MB per channel)
 
-// ------------------------------------------------------------------
-// Lock-free ring buffer: 30 seconds of 16 kHz mono PCM = 480 000 floats.
-// Declared static so it lives for the duration of the process.
-// ------------------------------------------------------------------
-static moodycamel::ReaderWriterQueue<float> g_ring(16000 * 15);  // 15 s ring buffer
+// Consumer wake-up period while recording — one block at 16 kHz.
+static constexpr auto kPumpInterval = std::chrono::milliseconds(10);
 
-// Internal helper struct so we can pass *this* through the C callback.
-struct DeviceHolder {
-    ma_device    device;
-    AudioManager* owner;
-};
+// Longest the main thread waits for the callback to acknowledge a gate
+// change — several periods; past that the device has stalled anyway.
+static constexpr auto kGateAckTimeout = std::chrono::milliseconds(200);
 
-static void data_callback(ma_device* dev, void* /*output*/,
-                          const void* input, ma_uint32 frameCount)
+static int64_t nowNs()
 {
-    auto* h = static_cast<DeviceHolder*>(dev->pUserData);
-    h->owner->onAudioData(static_cast<const float*>(input), frameCount);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
 // ------------------------------------------------------------------
 
 void AudioManager::onAudioData(const float* data, size_t frames)
 {
-    float sumSq = 0.0f;
-    for (size_t i = 0; i < frames; ++i) {
-        sumSq += data[i] * data[i];
-        if (!g_ring.try_enqueue(data[i]))
-            m_dropped.fetch_add(1, std::memory_order_relaxed);
+    // Real-time thread: publish the period and nothing else.  RMS, VAD
+    // features and silence bookkeeping run on the consumer thread.
+    const uint32_t gate = m_gate.load(std::memory_order_acquire);
+
+    if (gate & 1) {
+        if (gate != m_seenGate) {
+            // First period of a new recording: pre-roll goes in first.
+            m_seenGate = gate;
+            stitchPreroll();
+            m_firstSampleNs.store(nowNs(), std::memory_order_relaxed);
+        }
+        const size_t samples = frames * m_channels;
+        const size_t written = ringWrite(data, samples);
+        if (written < samples)
+            m_dropped.fetch_add(static_cast<int>((samples - written + m_channels - 1) / m_channels),
+                                std::memory_order_relaxed);
+    } else {
+        m_seenGate = gate;
+        pushPreroll(data, frames * m_channels);
+    }
+
+    m_gateAck.store(gate, std::memory_order_release);
+}
+
+void AudioManager::pushPreroll(const float* data, size_t samples)
+{
+    const size_t cap = m_preroll.size();
+    if (cap == 0) return;
+    if (samples >= cap) {
+        std::copy(data + samples - cap, data + samples, m_preroll.begin());
+        m_prerollPos  = 0;
+        m_prerollFill = cap;
+        return;
+    }
+    const size_t first = std::min(samples, cap - m_prerollPos);
+    std::copy(data, data + first, m_preroll.begin() + m_prerollPos);
+    std::copy(data + first, data + samples, m_preroll.begin());
+    m_prerollPos  = (m_prerollPos + samples) % cap;
+    m_prerollFill = std::min(cap, m_prerollFill + samples);
+}
+
+void AudioManager::stitchPreroll()
+{
+    // Oldest sample sits at m_prerollPos once the buffer has wrapped.
+    const size_t cap   = m_preroll.size();
+    const size_t start = m_prerollFill < cap ? 0 : m_prerollPos;
+    const size_t first = std::min(m_prerollFill, cap - start);
+    size_t written = ringWrite(m_preroll.data() + start, first);
+    written += ringWrite(m_preroll.data(), m_prerollFill - first);
+
+    m_prerollStitched.store(written / m_channels, std::memory_order_relaxed);
+    m_prerollPos  = 0;
+    m_prerollFill = 0;
+}
+
+size_t AudioManager::ringWrite(const float* data, size_t samples)
+{
+    if (!m_ring16) return m_ring->write(data, samples);
+
+    // Quantise through a fixed scratch buffer — no allocation here.
+    size_t written = 0;
+    while (written < samples) {
+        const size_t n = std::min(m_toRing.size(), samples - written);
+        audio_kernels::floatToInt16(data + written, n, m_toRing.data());
+        const size_t k = m_ring16->write(m_toRing.data(), n);
+        written += k;
+        if (k == 0) break;   // full; k < n alone may be a channel resync
+    }
+    return written;
+}
+
+size_t AudioManager::ringRead(float* dst, size_t samples)
+{
+    if (!m_ring16) return m_ring->read(dst, samples);
+
+    size_t read = 0;
+    while (read < samples) {
+        const size_t n = std::min(m_fromRing.size(), samples - read);
+        const size_t k = m_ring16->read(m_fromRing.data(), n);
+        audio_kernels::int16ToFloat(m_fromRing.data(), k, dst + read);
+        read += k;
+        if (k < n) break;
     }
+    return read;
+}
+
+void AudioManager::waitForGateAck(uint32_t gate)
+{
+    const auto deadline = std::chrono::steady_clock::now() + kGateAckTimeout;
+    while (m_gateAck.load(std::memory_order_acquire) != gate
+           && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+// ------------------------------------------------------------------
+// Consumer stage
+// ------------------------------------------------------------------
+void AudioManager::analyze(const float* data, size_t frames)
+{
+    const size_t added = m_features.push(data, frames);
+    if (added > 0) {
+        const std::vector<FeatureFrame>& all = m_features.frames();
+
+        // Every frame goes through the VAD, in order — decisions land on
+        // the frame that caused them regardless of how late this pass ran.
+        for (size_t i = all.size() - added; i < all.size(); ++i) {
+            const VadEvent ev = m_vad.process(all[i]);
+            if (ev != VadEvent::None && m_vadCallback)
+                m_vadCallback(ev, i, m_session.load(std::memory_order_relaxed));
+        }
+        m_features.setVoicedThreshold(m_vad.voicedThreshold());
 
-    const float rms = (frames > 0) ? std::sqrt(sumSq / static_cast<float>(frames)) : 0.0f;
-    m_rms.store(rms, std::memory_order_relaxed);
+        // Meter reads the newest frame rather than rescanning PCM.
+        const float rms = std::sqrt(all.back().energy);
+        m_rms.store(rms, std::memory_order_relaxed);
 
-    if (g_overlayPtr)
-        g_overlayPtr->pushRMS(rms);
+        if (m_levelCallback)
+            m_levelCallback(rms);
+    }
 
     if (m_callback)
         m_callback(data, frames);
 }
 
-bool AudioManager::init(SampleCallback cb)
+void AudioManager::deliver(const float* data, size_t frames)
 {
-    m_callback = cb;
-    m_recordBuffer.reserve(16000 * 15);   // pre-alloc for 15 s
+    // DC and rumble go before the denoiser learns its profile from them.
+    if (m_condActive) {
+        m_hpf.process(data, m_filtered.data(), frames);
+        data = m_filtered.data();
+    }
+    if (m_nsActive) {
+        frames = m_ns.process(data, frames, m_denoised.data());
+        data   = m_denoised.data();
+    }
+    level(data, frames);
+}
 
-    auto* h  = new DeviceHolder();
-    h->owner = this;
+void AudioManager::level(const float* data, size_t frames)
+{
+    // Gain goes last so it follows the speech, not the noise just removed.
+    if (m_condActive) {
+        frames = m_agc.process(data, frames, m_leveled.data());
+        data   = m_leveled.data();
+    }
+    if (frames == 0) return;
+    m_recording.append(data, frames);
+    analyze(data, frames);
+}
 
-    ma_device_config cfg       = ma_device_config_init(ma_device_type_capture);
-    cfg.capture.format         = ma_format_f32;
-    cfg.capture.channels       = 1;
-    cfg.sampleRate             = 16000;
-    cfg.dataCallback           = data_callback;
-    cfg.pUserData              = h;
-    cfg.periodSizeInFrames     = 480;     // 30 ms chunks — lower latency
+void AudioManager::pump()
+{
+    // A new physical input has different levels per channel.
+    const uint32_t route = m_source->routeGeneration();
+    if (route != m_routeSeen) {
+        m_routeSeen = route;
+        m_routeChanges.fetch_add(1, std::memory_order_relaxed);
+        if (m_mixer) m_mixer->resetStats();
+    }
+
+    if (m_mixer || m_resampler || m_nsActive || m_condActive || m_ring16) {
+        // Channels are mixed down and native-rate capture is converted to
+        // 16 kHz here rather than on the real-time thread, then conditioned,
+        // one staging block at a time.  Compact samples are widened to float
+        // for the analysis and narrowed again as they are appended.
+        for (;;) {
+            const size_t want = m_native.size() - m_carry;
+            const size_t n    = ringRead(m_native.data() + m_carry, want);
+            const size_t have = m_carry + n;
+            const size_t frames = have / m_channels;
+            if (frames > 0) {
+                const float* mono = m_native.data();
+                if (m_mixer) {
+                    m_mixer->process(m_native.data(), frames, m_mixed.data());
+                    mono = m_mixed.data();
+                }
+                if (m_resampler) {
+                    const size_t k = m_resampler->process(mono, frames, m_resampled.data());
+                    deliver(m_resampled.data(), k);
+                } else {
+                    deliver(mono, frames);
+                }
+            }
+            // A read can end mid-frame (spill pages are not whole frames);
+            // keep the rest.  The ring resumes in channel phase after a
+            // drop, so the carry always completes the right frame.
+            m_carry = have - frames * m_channels;
+            std::copy(m_native.begin() + frames * m_channels, m_native.begin() + have, m_native.begin());
+            if (n < want) break;
+        }
+        return;
+    }
 
-    if (ma_device_init(nullptr, &cfg, &h->device) != MA_SUCCESS) {
-        delete h;
+    // Read straight into the chain's tail page, then analyse the same
+    // samples while they are still hot in cache.
+    for (;;) {
+        std::span<float> t = m_recording.tail();
+        const size_t n = m_ring->read(t.data(), t.size());
+        if (n > 0) {
+            m_recording.commit(n);
+            analyze(t.data(), n);
+        }
+        if (n < t.size()) break;
+    }
+}
+
+void AudioManager::consumerLoop()
+{
+    while (!m_quit.load(std::memory_order_acquire)) {
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            if (m_capturing.load(std::memory_order_acquire))
+                m_wake.wait_for(lock, kPumpInterval);
+            else
+                m_wake.wait(lock, [this] {
+                    return m_capturing.load(std::memory_order_acquire)
+                        || m_quit.load(std::memory_order_acquire);
+                });
+        }
+        if (!m_capturing.load(std::memory_order_acquire)) continue;
+
+        std::lock_guard<std::mutex> lock(m_pumpMutex);
+        if (m_capturing.load(std::memory_order_acquire))
+            pump();
+    }
+}
+
+bool AudioManager::init(SampleCallback cb, std::unique_ptr<AudioSource> source)
+{
+    m_callback = cb;
+    PcmChain::reservePool(kRingSec, 60);   // first 15 s of pages; cache up to 60
+    m_features.reset();
+
+    m_source = source ? std::move(source) : makeDeviceSource();
+    if (!m_source->open(m_requestedRate, m_requestedChannels, 30,   // 30 ms chunks — lower latency
+            [this](const float* data, size_t frames) { onAudioData(data, frames); })) {
+        m_source.reset();
         return false;
     }
 
-    m_device = h;
+    // Anything but 16 kHz mono is mixed down and converted on the consumer
+    // side.  The ring and spill pages hold native-rate interleaved samples,
+    // so at 48 kHz they cover a third of the time — ample, as the consumer
+    // drains them every 10 ms.
+    m_captureRate = m_source->sampleRate();
+    m_channels    = std::max<uint32_t>(1, m_source->channels());
+    const size_t ringSamples  = size_t{kWhisperRate} * kRingSec * m_channels;
+    const size_t spillSamples = size_t{kWhisperRate} * kMaxSpillSec * m_channels;
+    if (m_compact) {
+        m_ring16 = std::make_unique<CaptureRing16>(ringSamples, spillSamples, m_channels);
+        m_toRing.assign(4096, 0);
+        m_fromRing.assign(4096, 0);
+    } else {
+        m_ring = std::make_unique<CaptureRing>(ringSamples, spillSamples, m_channels);
+    }
+    m_recording = PcmChain(m_compact ? PcmFormat::Int16 : PcmFormat::Float32);
+    const size_t frames = m_captureRate / 10;                               // 100 ms
+    m_native.assign(frames * m_channels, 0.0f);
+    m_carry = 0;
+    if (m_channels > 1) {
+        m_mixer = std::make_unique<ChannelMixer>(m_channels, m_captureRate / 100, m_channelMode);
+        m_mixed.assign(frames, 0.0f);
+    }
+    if (m_captureRate != kWhisperRate) {
+        m_resampler = std::make_unique<Resampler>(m_captureRate, kWhisperRate);
+        m_resampled.assign(std::max(m_resampler->maxOutput(frames) + 1, m_resampler->maxFlush()), 0.0f);
+    }
+    m_routeSeen = m_source->routeGeneration();
+    const size_t block = std::max(frames, m_resampled.size());
+    m_filtered.assign(block, 0.0f);
+    m_denoised.assign(block + NoiseSuppressor::kHop, 0.0f);
+    m_leveled.assign(m_denoised.size() + LookaheadAgc::kDelay + LookaheadAgc::kHop, 0.0f);
+
+    m_quit.store(false, std::memory_order_release);
+    m_consumer = std::thread([this] { consumerLoop(); });
+
+    // Armed mode: run the source from now on, feeding only the pre-roll
+    // until a recording opens the gate.  Falls back to cold starts if it
+    // won't run.
+    if (m_prerollMs > 0) {
+        m_preroll.assign(m_captureRate / 1000 * m_prerollMs * m_channels, 0.0f);
+        m_armed = m_source->start();
+    }
     return true;
 }
 
 bool AudioManager::startCapture()
 {
-    m_recordBuffer.clear();
-    resetDropCounter();
+    {
+        std::lock_guard<std::mutex> lock(m_pumpMutex);
+        m_recording.clear();
+        m_features.reset();
+        m_vad.resetSession();
+        m_features.setVoicedThreshold(m_vad.voicedThreshold());
+        if (m_mixer)     m_mixer->beginUtterance();
+        if (m_resampler) m_resampler->reset();
+        m_nsActive = m_nsEnabled.load(std::memory_order_acquire);
+        if (m_nsActive) m_ns.resetStream();
+        m_condActive = m_condEnabled.load(std::memory_order_acquire);
+        if (m_condActive) {
+            m_hpf.reset();
+            m_agc.resetStream();
+        }
+        m_session.fetch_add(1, std::memory_order_acq_rel);
+        resetDropCounter();
 
-    // Drain any stale samples left from a previous (cancelled) session.
-    float dummy;
-    while (g_ring.try_dequeue(dummy)) {}
+        // Drain any stale samples left from a previous (cancelled) session
+        // and hand every overflow page back to the audio thread.  The gate
+        // is closed, so the callback isn't touching the ring.
+        if (m_ring16) m_ring16->reset();
+        else          m_ring->reset();
+        m_carry = 0;
+    }
+
+    m_prerollStitched.store(0, std::memory_order_relaxed);
+    m_firstSampleNs.store(0, std::memory_order_relaxed);
+    m_startNs.store(nowNs(), std::memory_order_relaxed);
+    m_gate.fetch_add(1, std::memory_order_acq_rel);   // -> odd: recording
 
-    auto* h = static_cast<DeviceHolder*>(m_device);
-    return ma_device_start(&h->device) == MA_SUCCESS;
+    if (!m_armed && !m_source->start()) {
+        m_gate.fetch_add(1, std::memory_order_acq_rel);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_capturing.store(true, std::memory_order_release);
+    }
+    m_wake.notify_one();
+    return true;
 }
 
 void AudioManager::stopCapture()
 {
-    auto* h = static_cast<DeviceHolder*>(m_device);
-    if (h) ma_device_stop(&h->device);
+    if (!m_source) return;
+    const uint32_t gate = m_gate.load(std::memory_order_acquire);
+    if (!(gate & 1)) return;   // not recording
+    m_gate.store(gate + 1, std::memory_order_release);   // -> even: pre-roll only
+
+    // Armed: the device keeps running; wait out the period in flight so the
+    // ring is quiet before drainBuffer / the next startCapture touch it.
+    if (m_armed) waitForGateAck(gate + 1);
+    else         m_source->stop();
 }
 
-std::vector<float> AudioManager::drainBuffer()
+double AudioManager::getStartLatencyMs() const
 {
-    float s;
-    while (g_ring.try_dequeue(s))
-        m_recordBuffer.push_back(s);
-    // Move instead of copy — avoids duplicating up to 1.9 MB of PCM
-    std::vector<float> out = std::move(m_recordBuffer);
-    m_recordBuffer.reserve(16000 * 15);   // re-allocate for next session
-    return out;
+    const int64_t first = m_firstSampleNs.load(std::memory_order_relaxed);
+    if (first == 0) return -1.0;
+    return static_cast<double>(first - m_startNs.load(std::memory_order_relaxed)) / 1e6;
+}
+
+PcmChain AudioManager::drainBuffer()
+{
+    // Park the consumer; taking the pump lock waits out an in-flight pass.
+    m_capturing.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(m_pumpMutex);
+
+    // The device is stopped, so the audio thread's partial overflow page
+    // can be published; only the last few milliseconds are left to move.
+    if (m_ring16) m_ring16->flushSpill();
+    else          m_ring->flushSpill();
+    pump();
+    // Tails held back by each stage, in chain order: the resampler's
+    // through the denoiser and AGC, then theirs.
+    if (m_resampler) {
+        const size_t n = m_resampler->flush(m_resampled.data());
+        deliver(m_resampled.data(), n);
+    }
+    if (m_nsActive) {
+        const size_t n = m_ns.flush(m_denoised.data());
+        level(m_denoised.data(), n);
+    }
+    if (m_condActive) {
+        const size_t n = m_agc.flush(m_leveled.data());
+        if (n > 0) {
+            m_recording.append(m_leveled.data(), n);
+            analyze(m_leveled.data(), n);
+        }
+    }
+    m_features.finish();
+
+    // Hand the pages over — the next session borrows fresh ones from the pool
+    return std::move(m_recording);
+}
+
+FeatureSummary AudioManager::getFeatureSummary() const
+{
+    std::lock_guard<std::mutex> lock(m_pumpMutex);
+    return m_features.summary();
+}
+
+void AudioManager::getLoudRange(size_t& begin, size_t& end) const
+{
+    std::lock_guard<std::mutex> lock(m_pumpMutex);
+    m_features.loudRange(begin, end);
+}
+
+std::vector<CaptureGap> AudioManager::getCaptureGaps() const
+{
+    if (!m_ring && !m_ring16) return {};
+    std::vector<CaptureGap> gaps = m_ring16 ? m_ring16->gaps() : m_ring->gaps();
+    for (CaptureGap& g : gaps) {
+        g.atSample /= m_channels;
+        g.dropped   = (g.dropped + m_channels - 1) / m_channels;
+    }
+    return gaps;
+}
+
+std::vector<AudioManager::ChannelInfo> AudioManager::getChannelInfo() const
+{
+    std::lock_guard<std::mutex> lock(m_pumpMutex);
+    if (!m_mixer) return { ChannelInfo{ 0.0f, 1.0f } };
+    std::vector<ChannelInfo> info(m_mixer->channels());
+    for (size_t c = 0; c < info.size(); ++c)
+        info[c] = ChannelInfo{ m_mixer->snrDb(c), m_mixer->weight(c) };
+    return info;
 }
 
 void AudioManager::shutdown()
 {
-    if (m_device) {
-        auto* h = static_cast<DeviceHolder*>(m_device);
-        ma_device_uninit(&h->device);
-        delete h;
-        m_device = nullptr;
+    if (m_consumer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_capturing.store(false, std::memory_order_release);
+            m_quit.store(true, std::memory_order_release);
+        }
+        m_wake.notify_one();
+        m_consumer.join();
+    }
+    if (m_source) {
+        m_source->close();
+        m_source.reset();
     }
 }
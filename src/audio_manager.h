@@ -2,40 +2,221 @@
 #include <vector>
 #include <atomic>
 #include <functional>
-
-// Forward-declared so overlay.h never needs to be #included here
-class Overlay;
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "capture_ring.h"
+#include "pcm_chain.h"
+#include "feature_extractor.h"
+#include "vad_engine.h"
+#include "audio_source.h"
+#include "resampler.h"
+#include "noise_suppressor.h"
+#include "signal_conditioner.h"
+#include "channel_mixer.h"
 
 class AudioManager {
 public:
     using SampleCallback = std::function<void(const float*, size_t)>;
+    // (event, frame index within the recording, capture session id)
+    using VadCallback    = std::function<void(VadEvent, size_t, uint32_t)>;
+    using LevelCallback  = std::function<void(float)>;
+
+    // Peak amplitude below which a frame counts as silence for trimming.
+    static constexpr float kSilenceThreshold = 0.005f;
+    // Rate of the recording handed to Whisper, whatever the device runs at.
+    static constexpr uint32_t kWhisperRate = 16000;
+
+    // Rate to open the source at; 0 (default) = its native rate, converted
+    // to 16 kHz on the consumer thread.  Call before init().
+    void setCaptureRate(uint32_t hz) { m_requestedRate = hz; }
+    uint32_t captureRate() const { return m_captureRate; }
+
+    // Channels to capture; 0 (default) = all the device has.  With more than
+    // one, the consumer picks (Select) or SNR-blends (Blend) the best
+    // channel per utterance; the recording is always mono.  Call before init().
+    void setCaptureChannels(uint32_t n) { m_requestedChannels = n; }
+    void setChannelMode(ChannelMixer::Mode m) { m_channelMode = m; }
+    uint32_t captureChannels() const { return m_channels; }
+
+    // init() opens the source (the default microphone if none is given),
+    // mono, and starts the consumer thread.  The recording is always 16 kHz.  cb is called from the
+    // consumer thread with each block as it is appended to the recording.
+    bool init(SampleCallback cb, std::unique_ptr<AudioSource> source = nullptr);
+
+    // Receives the RMS of every 10 ms feature frame while recording, on the
+    // consumer thread (the overlay meter).  Set before init().
+    void setLevelCallback(LevelCallback cb) { m_levelCallback = std::move(cb); }
 
-    // init() opens the microphone at 16 kHz mono.
-    // cb is called from the miniaudio thread; keep it very short.
-    bool init(SampleCallback cb);
+    // Always-armed mode: keep the device running between recordings and
+    // hold the last `ms` of audio in a pre-roll buffer that is stitched onto
+    // the front of the next recording, so neither device start-up nor the
+    // first syllable is lost.  0 (default) starts the device on the hotkey.
+    // Call before init().  Note the microphone stays open while armed.
+    void setPrerollMs(size_t ms) { m_prerollMs = ms; }
+    bool isArmed() const { return m_armed; }
+
+    // Compact storage: the capture ring and the recording pages hold int16
+    // instead of float — half the memory and cache traffic.  Samples are
+    // converted back to float (SIMD) only when the transcriber gathers
+    // them for Whisper.  Call before init().
+    void setCompactPcm(bool on) { m_compact = on; }
+
+    // Wiener-filter noise suppression in the consumer stage.  Takes effect
+    // at the next startCapture(); safe to call from any thread.
+    void setNoiseSuppression(bool on) { m_nsEnabled.store(on, std::memory_order_release); }
+
+    // Input conditioning: 80 Hz high-pass ahead of the denoiser and a
+    // look-ahead AGC after it, so trimming, the VAD and Whisper see speech
+    // at a steady level.  Adds 30 ms of delay inside the consumer stage.
+    // Takes effect at the next startCapture(); off by default.
+    void setConditioning(bool on) { m_condEnabled.store(on, std::memory_order_release); }
+
+    // True once a finite source (file, synthetic) has delivered everything.
+    bool sourceFinished() const { return m_source && m_source->finished(); }
 
     bool startCapture();    // Arms recording; drains any stale ring buffer
     void stopCapture();
 
-    // Transfer all buffered samples since last startCapture() and return them.
+    // Transfer all buffered samples since last startCapture() and return them
+    // as a page chain (no length cap).  The consumer thread has already
+    // moved almost everything; this only pulls the last few milliseconds.
     // Call once from the main thread immediately after stopCapture().
-    std::vector<float> drainBuffer();
+    PcmChain drainBuffer();
+
+    // Running per-10 ms feature summary of the last drained recording (or
+    // the live one while recording).  O(1): a snapshot taken under the
+    // consumer lock, never a rescan.
+    FeatureSummary getFeatureSummary() const;
+
+    // Sample range [begin, end) spanned by loud frames; empty if none.
+    void getLoudRange(size_t& begin, size_t& end) const;
+
+    // Speech start/end events from the VAD, raised on the consumer thread
+    // at the exact 10 ms frame that triggered them.  The callback runs with
+    // the consumer lock held — post a message, don't call back in here.
+    // Set before init().
+    void setVadCallback(VadCallback cb) { m_vadCallback = std::move(cb); }
+
+    // Incremented by every startCapture(); lets a receiver discard events
+    // that were queued for an earlier recording.
+    uint32_t session() const { return m_session.load(std::memory_order_acquire); }
+
+    // Start-up instrumentation for the current/last recording: time from
+    // startCapture() to the first live sample reaching the ring (-1 if none
+    // arrived yet), and how much pre-roll was stitched before it.
+    double getStartLatencyMs() const;
+    size_t getPrerollMs() const
+    {
+        return m_captureRate ? m_prerollStitched.load(std::memory_order_relaxed) * 1000 / m_captureRate : 0;
+    }
+
+    // Holes in the last drained recording, in capture-rate frames — only
+    // non-empty when the spill cap was exceeded.  One entry per overflow page that followed a drop.
+    std::vector<CaptureGap> getCaptureGaps() const;
+
+    // Per-channel SNR and mix weight as of the last drained recording, and
+    // how many times the input device has been switched since init().
+    struct ChannelInfo {
+        float snrDb  = 0.0f;
+        float weight = 0.0f;
+    };
+    std::vector<ChannelInfo> getChannelInfo() const;
+    uint32_t getRouteChanges() const { return m_routeChanges.load(std::memory_order_relaxed); }
 
     void shutdown();
 
-    // RMS of the last audio chunk — updated from the audio thread;
-    // safe to read from any thread via relaxed load.
+    // RMS of the latest 10 ms feature frame — updated from the consumer
+    // thread; safe to read from any thread via relaxed load.
     float getRMS()            const { return m_rms.load(std::memory_order_relaxed); }
+    // Frames lost because the ring and every overflow page were full.
     int   getDroppedSamples() const { return m_dropped.load(std::memory_order_relaxed); }
     void  resetDropCounter()        { m_dropped.store(0, std::memory_order_relaxed); }
 
-    // Called internally from the miniaudio callback — do not call directly.
+    // Called internally from the source's callback — do not call directly.
     void onAudioData(const float* data, size_t frames);
 
 private:
-    void*          m_device   = nullptr;   // DeviceHolder* — opaque
+    void consumerLoop();
+    void pump();                          // ring -> recording + analysis; m_pumpMutex held
+    void analyze(const float* data, size_t frames);
+    void deliver(const float* data, size_t frames);   // 16 kHz -> (high-pass, denoise) -> level()
+    void level(const float* data, size_t frames);     // (AGC) -> recording + analysis
+    void waitForGateAck(uint32_t gate);   // until the callback has acted on `gate`
+    void pushPreroll(const float* data, size_t samples);  // audio thread only
+    void stitchPreroll();                                 // audio thread only
+    size_t ringWrite(const float* data, size_t samples);  // audio thread only
+    size_t ringRead(float* dst, size_t samples);          // consumer only
+
+    std::unique_ptr<AudioSource> m_source;
+    uint32_t                     m_requestedRate     = 0;
+    uint32_t                     m_captureRate       = kWhisperRate;
+    uint32_t                     m_requestedChannels = 0;
+    uint32_t                     m_channels          = 1;
+    ChannelMixer::Mode           m_channelMode       = ChannelMixer::Mode::Select;
+
+    // Interleaved capture-rate samples from the callback to the consumer.
+    // Owned per instance, sized in init() for the delivered channel count;
+    // exactly one of the two exists.
+    bool                           m_compact = false;
+    std::unique_ptr<CaptureRing>   m_ring;
+    std::unique_ptr<CaptureRing16> m_ring16;
+    std::vector<int16_t>           m_toRing;     // audio thread: quantised period
+    std::vector<int16_t>           m_fromRing;   // consumer: int16 staging
+
+    std::unique_ptr<ChannelMixer> m_mixer;      // null for mono capture
+    std::unique_ptr<Resampler>   m_resampler;   // null when capturing at 16 kHz
+    std::vector<float>           m_native;      // consumer staging, capture rate, interleaved
+    size_t                       m_carry = 0;   // samples of a partial frame left in m_native
+    std::vector<float>           m_mixed;       // consumer staging, capture rate, mono
+    std::vector<float>           m_resampled;   // consumer staging, 16 kHz
+    std::vector<float>           m_filtered;    // consumer staging, 16 kHz
+    std::vector<float>           m_denoised;    // consumer staging, 16 kHz
+    std::vector<float>           m_leveled;     // consumer staging, 16 kHz
+    std::atomic<bool>            m_nsEnabled{false};
+    bool                         m_nsActive = false;   // latched per recording
+    NoiseSuppressor              m_ns;                 // profile persists across recordings
+    std::atomic<bool>            m_condEnabled{false};
+    bool                         m_condActive = false; // latched per recording
+    Biquad                       m_hpf = Biquad::highPass(80.0f, static_cast<float>(kWhisperRate));
+    LookaheadAgc                 m_agc;                // level and gain persist across recordings
     SampleCallback m_callback;
-    std::atomic<int>   m_dropped{0};
-    std::atomic<float> m_rms{0.0f};
-    std::vector<float> m_recordBuffer;    // pre-allocated, 15 s max at 16 kHz
+    VadCallback    m_vadCallback;
+    LevelCallback  m_levelCallback;
+    std::atomic<int>      m_dropped{0};
+    std::atomic<float>    m_rms{0.0f};
+    std::atomic<uint32_t> m_session{0};
+    std::atomic<uint32_t> m_routeChanges{0};
+    uint32_t              m_routeSeen = 0;   // consumer: source route generation last seen
+
+    // Recording gate shared with the audio callback: odd = recording.  The
+    // callback echoes the value it acted on into m_gateAck at the end of
+    // each period, so the main thread knows when the ring is quiet.
+    std::atomic<uint32_t> m_gate{0};
+    std::atomic<uint32_t> m_gateAck{0};
+    std::atomic<int64_t>  m_startNs{0};
+    std::atomic<int64_t>  m_firstSampleNs{0};
+    std::atomic<size_t>   m_prerollStitched{0};
+    size_t                m_prerollMs = 0;
+    bool                  m_armed     = false;
+
+    // Audio-thread only: pre-roll circular buffer and the last gate seen.
+    std::vector<float> m_preroll;
+    size_t             m_prerollPos  = 0;
+    size_t             m_prerollFill = 0;
+    uint32_t           m_seenGate    = 0;
+
+    // Consumer stage: pulls blocks out of the ring every 10 ms while
+    // recording.  m_pumpMutex guards m_recording, m_features, m_vad and
+    // the mix / resample / denoise / conditioning state.
+    std::thread             m_consumer;
+    mutable std::mutex      m_pumpMutex;
+    std::mutex              m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<bool>       m_capturing{false};
+    std::atomic<bool>       m_quit{false};
+    PcmChain                m_recording;  // pages borrowed from the shared pool
+    FeatureExtractor        m_features{kSilenceThreshold};
+    VadEngine               m_vad;
 };
@@ -0,0 +1,407 @@
+// audio_source.cpp
+// MINIAUDIO_IMPLEMENTATION must be defined in exactly one translation unit.
+#define MINIAUDIO_IMPLEMENTATION
+#include "audio_source.h"
+#include "miniaudio.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// ------------------------------------------------------------------
+// Live capture device
+// ------------------------------------------------------------------
+static int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class DeviceSource : public AudioSource {
+public:
+    ~DeviceSource() override { close(); }
+
+    bool open(uint32_t sampleRate, uint32_t channels, uint32_t periodMs, DataCallback cb) override
+    {
+        m_cb       = std::move(cb);
+        m_periodMs = periodMs;
+
+        // sampleRate / channels 0 open the device in its native format — no
+        // conversion on the real-time thread.
+        if (!initDevice(sampleRate, channels)) return false;
+
+        // The format is pinned from here on: a replacement device is
+        // converted to it by miniaudio, so nothing downstream re-plans.
+        m_rate     = m_device.sampleRate;
+        m_channels = m_device.capture.channels;
+        m_zeros.assign(static_cast<size_t>(m_rate / 10) * m_channels, 0.0f);   // 100 ms
+        m_quit.store(false, std::memory_order_release);
+        m_recovery = std::thread([this] { recoveryLoop(); });
+        return true;
+    }
+
+    uint32_t sampleRate() const override { return m_rate; }
+    uint32_t channels()   const override { return m_channels; }
+
+    bool start() override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wantRunning.store(true, std::memory_order_release);
+        // While recovering, the replacement device is started as it comes up.
+        if (m_lost.load(std::memory_order_acquire)) return true;
+        if (m_open && ma_device_start(&m_device) == MA_SUCCESS) return true;
+
+        // The device may have gone while stopped: try the current default.
+        reopen();
+        return m_open && ma_device_start(&m_device) == MA_SUCCESS;
+    }
+
+    void stop() override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wantRunning.store(false, std::memory_order_release);
+        if (m_open) ma_device_stop(&m_device);
+        m_lastNs = 0;   // a deliberate stop is not a gap
+    }
+
+    void close() override
+    {
+        if (m_recovery.joinable()) {
+            m_quit.store(true, std::memory_order_release);
+            m_wake.notify_one();
+            m_recovery.join();
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wantRunning.store(false, std::memory_order_release);
+        if (m_open) {
+            ma_device_uninit(&m_device);
+            m_open = false;
+        }
+    }
+
+    uint32_t routeGeneration() const override { return m_route.load(std::memory_order_acquire); }
+
+    const char* name() const override { return "device"; }
+
+private:
+    // Longest silence inserted for a switch; beyond that the timeline
+    // simply resumes.
+    static constexpr int64_t kMaxFillMs = 2000;
+
+    bool initDevice(uint32_t sampleRate, uint32_t channels)
+    {
+        ma_device_config cfg         = ma_device_config_init(ma_device_type_capture);
+        cfg.capture.format           = ma_format_f32;
+        cfg.capture.channels         = channels;
+        cfg.sampleRate               = sampleRate;
+        cfg.dataCallback             = dataCallback;
+        cfg.notificationCallback     = notificationCallback;
+        cfg.pUserData                = this;
+        cfg.periodSizeInMilliseconds = m_periodMs;
+
+        m_open = ma_device_init(nullptr, &cfg, &m_device) == MA_SUCCESS;
+        return m_open;
+    }
+
+    static void dataCallback(ma_device* dev, void* /*output*/,
+                             const void* input, ma_uint32 frameCount)
+    {
+        auto* self = static_cast<DeviceSource*>(dev->pUserData);
+        const int64_t now = nowNs();
+
+        // First period after a switch: cover the time the stream was down
+        // with silence so the recording keeps its timeline.
+        const uint32_t route = self->m_route.load(std::memory_order_acquire);
+        if (route != self->m_seenRoute) {
+            self->m_seenRoute = route;
+            if (self->m_lastNs != 0) {
+                const int64_t downNs = std::min<int64_t>(now - self->m_lastNs, kMaxFillMs * 1000000);
+                int64_t missing = downNs * self->m_rate / 1000000000 - frameCount;
+                const size_t chunk = self->m_zeros.size() / self->m_channels;
+                while (missing > 0) {
+                    const size_t n = static_cast<size_t>(std::min<int64_t>(missing, chunk));
+                    self->m_cb(self->m_zeros.data(), n);
+                    missing -= static_cast<int64_t>(n);
+                }
+            }
+        }
+
+        self->m_cb(static_cast<const float*>(input), frameCount);
+        self->m_lastNs = now;
+    }
+
+    static void notificationCallback(const ma_device_notification* n)
+    {
+        auto* self = static_cast<DeviceSource*>(n->pDevice->pUserData);
+        switch (n->type) {
+        case ma_device_notification_type_rerouted:
+            // The backend followed a new default device by itself.
+            self->m_route.fetch_add(1, std::memory_order_acq_rel);
+            break;
+        case ma_device_notification_type_stopped:
+            // Stopped without being asked: the device went away.  Can't
+            // re-init from inside a miniaudio callback — hand it over.
+            if (self->m_wantRunning.load(std::memory_order_acquire)
+                && !self->m_recovering.load(std::memory_order_acquire)) {
+                self->m_lost.store(true, std::memory_order_release);
+                self->m_wake.notify_one();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void recoveryLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_quit.load(std::memory_order_acquire)) {
+            // Timed wait: the notification doesn't take the mutex.
+            m_wake.wait_for(lock, std::chrono::milliseconds(250));
+            if (!m_lost.load(std::memory_order_acquire) || m_quit.load(std::memory_order_acquire))
+                continue;
+
+            // Retried every wake-up until an input appears.
+            if (reopen()) {
+                m_lost.store(false, std::memory_order_release);
+                if (m_wantRunning.load(std::memory_order_acquire))
+                    ma_device_start(&m_device);
+            }
+        }
+    }
+
+    // Replaces the device with whatever is now the default input, in the
+    // pinned format.  m_mutex held.
+    bool reopen()
+    {
+        m_recovering.store(true, std::memory_order_release);
+        if (m_open) {
+            ma_device_uninit(&m_device);
+            m_open = false;
+        }
+        if (initDevice(m_rate, m_channels))
+            m_route.fetch_add(1, std::memory_order_acq_rel);
+        m_recovering.store(false, std::memory_order_release);
+        return m_open;
+    }
+
+    ma_device          m_device{};
+    bool               m_open     = false;
+    uint32_t           m_periodMs = 30;
+    uint32_t           m_rate     = 0;
+    uint32_t           m_channels = 0;
+    DataCallback       m_cb;
+
+    // Device switching.  m_mutex serialises start/stop/close against the
+    // recovery thread; the audio callback never takes it.
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::thread             m_recovery;
+    std::atomic<bool>       m_quit{false};
+    std::atomic<bool>       m_wantRunning{false};
+    std::atomic<bool>       m_lost{false};
+    std::atomic<bool>       m_recovering{false};
+    std::atomic<uint32_t>   m_route{0};
+
+    // Audio-thread only.
+    std::vector<float> m_zeros;
+    uint32_t           m_seenRoute = 0;
+    int64_t            m_lastNs    = 0;
+};
+
+// ------------------------------------------------------------------
+// Shared base for sources that generate PCM on their own thread, either
+// paced to wall-clock periods or back to back.
+// ------------------------------------------------------------------
+class ThreadedSource : public AudioSource {
+public:
+    explicit ThreadedSource(bool realtime) : m_realtime(realtime) {}
+    ~ThreadedSource() override { stop(); }
+
+    bool open(uint32_t sampleRate, uint32_t channels, uint32_t periodMs, DataCallback cb) override
+    {
+        m_rate     = sampleRate;
+        m_channels = std::max<uint32_t>(1, channels);
+        m_period   = std::max<uint32_t>(1, sampleRate * periodMs / 1000);
+        m_cb       = std::move(cb);
+        m_buf.assign(static_cast<size_t>(m_period) * m_channels, 0.0f);
+        return true;
+    }
+
+    uint32_t sampleRate() const override { return m_rate; }
+    uint32_t channels()   const override { return m_channels; }
+
+    bool start() override
+    {
+        if (m_thread.joinable()) return true;
+        m_run.store(true, std::memory_order_release);
+        m_thread = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() override
+    {
+        m_run.store(false, std::memory_order_release);
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    void close() override { stop(); }
+
+    bool finished() const override { return m_finished.load(std::memory_order_acquire); }
+
+protected:
+    // Fills `frames` interleaved frames into out; returns how many were
+    // produced.  Fewer than `frames` means the source is exhausted.
+    virtual size_t generate(float* out, size_t frames) = 0;
+
+    uint32_t m_rate     = 16000;
+    uint32_t m_channels = 1;
+    uint32_t m_period   = 480;
+
+private:
+    void run()
+    {
+        using Clock = std::chrono::steady_clock;
+        const auto period = std::chrono::nanoseconds(1000000000LL * m_period / m_rate);
+        auto next = Clock::now();
+
+        while (m_run.load(std::memory_order_acquire) && !finished()) {
+            if (m_realtime) {
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+            const size_t n = generate(m_buf.data(), m_period);
+            if (n > 0) m_cb(m_buf.data(), n);
+            if (n < m_period) m_finished.store(true, std::memory_order_release);
+        }
+    }
+
+    bool               m_realtime;
+    DataCallback       m_cb;
+    std::vector<float> m_buf;
+    std::thread        m_thread;
+    std::atomic<bool>  m_run{false};
+    std::atomic<bool>  m_finished{false};
+};
+
+// ------------------------------------------------------------------
+// File replay
+// ------------------------------------------------------------------
+class FileSource : public ThreadedSource {
+public:
+    FileSource(std::string path, bool realtime, bool loop)
+        : ThreadedSource(realtime), m_path(std::move(path)), m_loop(loop) {}
+
+    ~FileSource() override { close(); }
+
+    bool open(uint32_t sampleRate, uint32_t channels, uint32_t periodMs, DataCallback cb) override
+    {
+        ma_decoder_config cfg = ma_decoder_config_init(ma_format_f32, channels, sampleRate);
+        m_open = ma_decoder_init_file(m_path.c_str(), &cfg, &m_decoder) == MA_SUCCESS;
+        if (!m_open) return false;
+        return ThreadedSource::open(m_decoder.outputSampleRate, m_decoder.outputChannels, periodMs,
+                                    std::move(cb));
+    }
+
+    void close() override
+    {
+        ThreadedSource::close();
+        if (m_open) {
+            ma_decoder_uninit(&m_decoder);
+            m_open = false;
+        }
+    }
+
+    const char* name() const override { return "file"; }
+
+protected:
+    size_t generate(float* out, size_t frames) override
+    {
+        size_t done = 0;
+        while (done < frames) {
+            ma_uint64 got = 0;
+            ma_decoder_read_pcm_frames(&m_decoder, out + done * m_channels, frames - done, &got);
+            done += static_cast<size_t>(got);
+            if (got > 0) continue;
+            if (!m_loop || ma_decoder_seek_to_pcm_frame(&m_decoder, 0) != MA_SUCCESS) break;
+        }
+        return done;
+    }
+
+private:
+    std::string m_path;
+    bool        m_loop;
+    bool        m_open = false;
+    ma_decoder  m_decoder{};
+};
+
+// ------------------------------------------------------------------
+// Synthetic signal
+// ------------------------------------------------------------------
+class SyntheticSource : public ThreadedSource {
+public:
+    SyntheticSource(const SyntheticSignal& s, bool realtime)
+        : ThreadedSource(realtime), m_sig(s), m_rng(s.seed) {}
+
+    ~SyntheticSource() override { stop(); }
+
+    bool open(uint32_t sampleRate, uint32_t channels, uint32_t periodMs, DataCallback cb) override
+    {
+        return ThreadedSource::open(sampleRate ? sampleRate : 48000, channels ? channels : m_sig.channels,
+                                    periodMs, std::move(cb));
+    }
+
+    const char* name() const override { return "synthetic"; }
+
+protected:
+    size_t generate(float* out, size_t frames) override
+    {
+        const uint64_t total = static_cast<uint64_t>(m_sig.totalMs) * m_rate / 1000;
+        const uint64_t cycle = static_cast<uint64_t>(m_sig.silenceMs + m_sig.speechMs) * m_rate / 1000;
+        const uint64_t quiet = static_cast<uint64_t>(m_sig.silenceMs) * m_rate / 1000;
+        const float    w     = 2.0f * 3.14159265f * m_sig.toneHz / static_cast<float>(m_rate);
+        std::normal_distribution<float> noise(0.0f, m_sig.noise);
+
+        size_t i = 0;
+        for (; i < frames; ++i, ++m_pos) {
+            if (total > 0 && m_pos >= total) break;
+            const float tone = cycle > 0 && m_pos % cycle >= quiet
+                             ? m_sig.amplitude * std::sin(w * static_cast<float>(m_pos % m_rate)) : 0.0f;
+            for (uint32_t c = 0; c < m_channels; ++c) {
+                const uint32_t away = c > m_sig.bestChannel ? c - m_sig.bestChannel : m_sig.bestChannel - c;
+                out[i * m_channels + c] = noise(m_rng) * std::pow(m_sig.noiseStep, static_cast<float>(away)) + tone;
+            }
+        }
+        return i;
+    }
+
+private:
+    SyntheticSignal m_sig;
+    std::mt19937    m_rng;
+    uint64_t        m_pos = 0;
+};
+
+} // namespace
+
+std::unique_ptr<AudioSource> makeDeviceSource()
+{
+    return std::make_unique<DeviceSource>();
+}
+
+std::unique_ptr<AudioSource> makeFileSource(const std::string& path, bool realtime, bool loop)
+{
+    return std::make_unique<FileSource>(path, realtime, loop);
+}
+
+std::unique_ptr<AudioSource> makeSyntheticSource(const SyntheticSignal& signal, bool realtime)
+{
+    return std::make_unique<SyntheticSource>(signal, realtime);
+}
@@ -0,0 +1,81 @@
+#pragma once
+// audio_source.h — where captured PCM comes from.
+//
+// AudioManager drives the capture pipeline from an AudioSource.  The live
+// microphone is one implementation; file replay and a synthetic generator
+// are the others, so the full capture path (ring, consumer stage, features,
+// VAD) can be exercised deterministically without audio hardware.
+//
+// Every source delivers 32-bit float interleaved PCM in periods of
+// `periodMs`, from a thread of its own — the same cadence
+// AudioManager::onAudioData sees from the device.  Asking for sample rate or
+// channel count 0 means "whatever the source runs at natively";
+// sampleRate() and channels() report what is actually delivered.
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+class AudioSource {
+public:
+    // (interleaved samples, frames)
+    using DataCallback = std::function<void(const float*, size_t)>;
+
+    virtual ~AudioSource() = default;
+
+    // Prepares the source; no callbacks until start().
+    virtual bool open(uint32_t sampleRate, uint32_t channels, uint32_t periodMs, DataCallback cb) = 0;
+
+    // Format of the delivered PCM; valid after open().  Fixed for the life
+    // of the source, even across a device switch.
+    virtual uint32_t sampleRate() const = 0;
+    virtual uint32_t channels()   const = 0;
+
+    // start() resumes delivery.  stop() is synchronous: once it returns no
+    // callback is running or will run until the next start().
+    virtual bool start() = 0;
+    virtual void stop()  = 0;
+    virtual void close() = 0;
+
+    // True once a finite source has delivered its last sample.
+    virtual bool finished() const { return false; }
+
+    // Bumped (from any thread) whenever the physical input behind the
+    // source changes — a headset plugged in, a dock removed — so the
+    // consumer can re-learn per-channel levels.  Any time the stream was
+    // down during the switch is filled with silence, never skipped.
+    virtual uint32_t routeGeneration() const { return 0; }
+
+    virtual const char* name() const = 0;
+};
+
+// Default capture device (miniaudio).  Follows the system default input:
+// when it changes or the current device disappears, capture moves to the
+// new default in the same delivered format, without stopping.
+std::unique_ptr<AudioSource> makeDeviceSource();
+
+// WAV / FLAC / MP3 replay through miniaudio's decoder, converted to the
+// requested rate (0 = the file's own).  realtime = paced like a device; otherwise as fast as the
+// consumer can take it.  At end of file the source either loops or goes
+// quiet and reports finished().
+std::unique_ptr<AudioSource> makeFileSource(const std::string& path, bool realtime, bool loop = false);
+
+// Deterministic test signal: low-level noise with tone bursts standing in
+// for speech.  Alternates silenceMs / speechMs for totalMs (0 = forever).
+// Its "native" rate is 48 kHz, like most USB microphones.  With several
+// channels the tone is the same on each and the noise grows by noiseStep
+// per channel of distance from bestChannel — a small mic array.
+struct SyntheticSignal {
+    uint32_t seed        = 1;
+    float    noise       = 0.002f;    // noise standard deviation
+    float    amplitude   = 0.1f;      // burst amplitude
+    float    toneHz      = 220.0f;
+    uint32_t silenceMs   = 1000;
+    uint32_t speechMs    = 2000;
+    uint32_t totalMs     = 0;
+    uint32_t channels    = 1;         // native channel count
+    uint32_t bestChannel = 0;         // quietest channel
+    float    noiseStep   = 2.0f;      // noise factor per channel away from it
+};
+std::unique_ptr<AudioSource> makeSyntheticSource(const SyntheticSignal& signal, bool realtime);
@@ -0,0 +1,88 @@
+#pragma once
+// cancel_token.h — cooperative cancellation of a running transcription job.
+//
+// One token per job, shared by whoever asks the job to stop (the UI, or the
+// job queue when a more urgent job arrives) and the thread running it.  The
+// runner polls requested() between stages, and whisper.cpp polls it from
+// whisper_full_params::abort_callback between compute-graph nodes, so a
+// cancelled job gives its cores back within a few milliseconds.
+//
+// Both timestamps are kept so the worker can log how long a request took to
+// be noticed and to take effect.
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+class CancelToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Reason : int {
+        None      = 0,
+        Cancelled = 1,   // drop the job; it completes with an empty result
+        Preempted = 2,   // yield to a more urgent job, then run again
+    };
+
+    // Any thread.  Cancelled overrides Preempted; otherwise the first
+    // request wins.
+    void request(Reason why)
+    {
+        int64_t unset = 0;
+        m_requestedNs.compare_exchange_strong(unset, nowNs(), std::memory_order_relaxed);
+        if (why == Reason::Cancelled) {
+            m_reason.store(static_cast<int>(why), std::memory_order_release);
+        } else {
+            int none = 0;
+            m_reason.compare_exchange_strong(none, static_cast<int>(why), std::memory_order_release);
+        }
+    }
+
+    bool   requested() const { return m_reason.load(std::memory_order_acquire) != 0; }
+    Reason reason()    const { return static_cast<Reason>(m_reason.load(std::memory_order_acquire)); }
+
+    // Before the job is run (again).  Only the thread that owns the job.
+    void reset()
+    {
+        m_reason.store(0, std::memory_order_relaxed);
+        m_requestedNs.store(0, std::memory_order_relaxed);
+        m_observedNs.store(0, std::memory_order_relaxed);
+    }
+
+    // Matches ggml_abort_callback: bool (*)(void* data), data = the token.
+    // Also records when the request was first seen by the compute threads.
+    static bool abortCallback(void* token)
+    {
+        auto* self = static_cast<CancelToken*>(token);
+        if (!self->requested()) return false;
+        int64_t unset = 0;
+        self->m_observedNs.compare_exchange_strong(unset, nowNs(), std::memory_order_relaxed);
+        return true;
+    }
+
+    // Milliseconds from the request to `t` (or to the first abortCallback()
+    // that saw it); negative if there was no request or it was never seen.
+    double msSinceRequest(Clock::time_point t) const
+    {
+        const int64_t at = m_requestedNs.load(std::memory_order_relaxed);
+        if (at == 0) return -1.0;
+        return static_cast<double>(toNs(t) - at) / 1e6;
+    }
+    double msUntilObserved() const
+    {
+        const int64_t at   = m_requestedNs.load(std::memory_order_relaxed);
+        const int64_t seen = m_observedNs.load(std::memory_order_relaxed);
+        if (at == 0 || seen == 0) return -1.0;
+        return static_cast<double>(seen - at) / 1e6;
+    }
+
+private:
+    static int64_t toNs(Clock::time_point t)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+    static int64_t nowNs() { return toNs(Clock::now()); }
+
+    std::atomic<int>     m_reason{0};
+    std::atomic<int64_t> m_requestedNs{0};
+    std::atomic<int64_t> m_observedNs{0};
+};
@@ -0,0 +1,334 @@
+#pragma once
+// capture_ring.h — wait-free SPSC ring of fixed-size PCM blocks.
+//
+// Replaces the per-sample moodycamel::ReaderWriterQueue<float>: the audio
+// thread publishes a whole callback period with at most two memcpy calls and
+// one release store, and the consumer drains everything available the same
+// way.  Producer and consumer indices live on separate cache lines so the
+// two threads never false-share.
+//
+// Templated on the sample type: float, or int16 for compact storage.
+//
+// When the primary ring fills up the producer spills into preallocated
+// overflow pages instead of dropping.  Once a session has spilled, every
+// later sample goes to pages too (until reset()), so the consumer simply
+// reads the ring dry and then the pages in order.  Samples are dropped only
+// when every page is in use; each such gap is reported against the page
+// that follows it.  For interleaved multi-channel capture the ring keeps
+// the stored stream in channel phase across a gap: writing resumes on the
+// channel the stored samples end on.
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// A hole in the captured stream: `dropped` samples are missing immediately
+// before stream position `atSample`.
+struct CaptureGap {
+    size_t atSample = 0;
+    size_t dropped  = 0;
+};
+
+template <typename T>
+class BasicCaptureRing {
+public:
+    static constexpr size_t kBlockFrames = 160;                 // 10 ms at 16 kHz
+    static constexpr size_t kPageFrames  = kBlockFrames * 100;  // 1 s overflow page
+    static constexpr size_t kCacheLine   = 64;
+
+    // Capacity is rounded up to a whole number of blocks; the spill cap to a
+    // whole number of pages.  Everything is allocated here — the audio
+    // thread never allocates.  Spill pages are left uninitialised so they
+    // cost address space, not working set, until a session actually spills.
+    // `channels`: samples per interleaved frame of what is written.
+    explicit BasicCaptureRing(size_t minFrames, size_t maxSpillFrames = 0, size_t channels = 1)
+        : m_capacity(((minFrames + kBlockFrames - 1) / kBlockFrames) * kBlockFrames),
+          m_channels(channels > 0 ? channels : 1)
+    {
+        m_data = std::make_unique<T[]>(m_capacity);
+
+        const size_t pages = (maxSpillFrames + kPageFrames - 1) / kPageFrames;
+        m_pages.resize(pages);
+        m_pageStore.reset(new T[pages * kPageFrames]);
+        m_free.init(pages);
+        m_filled.init(pages);
+        for (size_t i = 0; i < pages; ++i) {
+            m_pages[i].data = m_pageStore.get() + i * kPageFrames;
+            m_free.push(static_cast<uint32_t>(i));
+        }
+    }
+
+    BasicCaptureRing(const BasicCaptureRing&)            = delete;
+    BasicCaptureRing& operator=(const BasicCaptureRing&) = delete;
+
+    size_t capacity() const { return m_capacity; }
+
+    // ---- Producer side (audio thread) --------------------------------
+
+    // Stores `frames` samples, spilling to overflow pages once the ring is
+    // full.  Returns the number stored — less than `frames` only when the
+    // ring is full and no overflow page is free, or right after that, when
+    // the samples up to the channel the stored stream ends on are dropped
+    // too.  Wait-free.
+    size_t write(const T* src, size_t frames)
+    {
+        // A drop can end mid-frame; skip ahead to the next sample of the
+        // channel stored last, so every later frame stays in phase.
+        size_t skip = 0;
+        if (m_channels > 1) {
+            skip = std::min((m_storedPhase + m_channels - m_offeredPhase) % m_channels, frames);
+            m_offeredPhase = (m_offeredPhase + frames) % m_channels;
+            if (m_spilling) m_pendingDrops += skip;
+        }
+        const size_t n = store(src + skip, frames - skip);
+        if (m_channels > 1) m_storedPhase = (m_storedPhase + n) % m_channels;
+        return n;
+    }
+
+    // ---- Consumer side -----------------------------------------------
+
+    // Samples readable right now: the ring plus every published page.
+    // A page still being filled by the producer is not counted.
+    size_t readAvailable() const
+    {
+        size_t n = m_head.load(std::memory_order_acquire)
+                 - m_tail.load(std::memory_order_relaxed);
+        if (m_readPage != kNoPage)
+            n += m_pages[m_readPage].frames - m_readPos;
+        m_filled.forEach([&](uint32_t idx) { n += m_pages[idx].frames; });
+        return n;
+    }
+
+    // Copies up to `maxFrames` samples into dst, ring first, then overflow
+    // pages in the order they were filled.  Returns the count read.
+    size_t read(T* dst, size_t maxFrames)
+    {
+        size_t n = readRing(dst, maxFrames);
+        while (n < maxFrames) {
+            if (m_readPage == kNoPage) {
+                if (!m_filled.pop(m_readPage)) break;
+                m_readPos = 0;
+                const SpillPage& p = m_pages[m_readPage];
+                if (p.droppedBefore > 0)
+                    m_gaps.push_back({ m_consumed + n, p.droppedBefore });
+            }
+            SpillPage& p = m_pages[m_readPage];
+            const size_t take = std::min(p.frames - m_readPos, maxFrames - n);
+            std::memcpy(dst + n, p.data + m_readPos, take * sizeof(T));
+            m_readPos += take;
+            n         += take;
+            if (m_readPos == p.frames) {
+                m_free.push(m_readPage);
+                m_readPage = kNoPage;
+            }
+        }
+        m_consumed += n;
+        return n;
+    }
+
+    // Gaps (cap reached) seen by the consumer since the last reset().
+    const std::vector<CaptureGap>& gaps() const { return m_gaps; }
+
+    // Publishes the producer's partially filled page so the consumer can
+    // read it.  Only call while the producer is stopped (device stopped).
+    void flushSpill()
+    {
+        if (m_writePage != kNoPage && m_pages[m_writePage].frames > 0) {
+            m_filled.push(m_writePage);
+            m_writePage = kNoPage;
+        }
+        if (m_pendingDrops > 0) {
+            m_gaps.push_back({ m_consumed + readAvailable(), m_pendingDrops });
+            m_pendingDrops = 0;
+        }
+    }
+
+    // Discards everything and returns all pages to the free list, ready for
+    // a new session.  Only call while the producer is stopped.
+    void reset()
+    {
+        clear();
+        if (m_readPage != kNoPage) { m_free.push(m_readPage); m_readPage = kNoPage; }
+        if (m_writePage != kNoPage) { m_free.push(m_writePage); m_writePage = kNoPage; }
+        uint32_t idx;
+        while (m_filled.pop(idx)) m_free.push(idx);
+        m_spilling     = false;
+        m_pendingDrops = 0;
+        m_storedPhase  = 0;
+        m_offeredPhase = 0;
+        m_consumed     = 0;
+        m_gaps.clear();
+    }
+
+private:
+    static constexpr uint32_t kNoPage = UINT32_MAX;
+
+    struct SpillPage {
+        T*     data          = nullptr;
+        size_t frames        = 0;   // valid samples in data
+        size_t droppedBefore = 0;   // samples lost just before this page
+    };
+
+    // Fixed-capacity SPSC FIFO of page indices.  Sized to hold every page,
+    // so push() can never fail.
+    struct IndexFifo {
+        void init(size_t n) { m_slots.reset(new uint32_t[n + 1]); m_size = n + 1; }
+
+        void push(uint32_t v)
+        {
+            const size_t h = m_h.load(std::memory_order_relaxed);
+            m_slots[h] = v;
+            m_h.store((h + 1) % m_size, std::memory_order_release);
+        }
+        bool pop(uint32_t& v)
+        {
+            const size_t t = m_t.load(std::memory_order_relaxed);
+            if (t == m_h.load(std::memory_order_acquire)) return false;
+            v = m_slots[t];
+            m_t.store((t + 1) % m_size, std::memory_order_release);
+            return true;
+        }
+        template <typename Fn> void forEach(Fn fn) const
+        {
+            const size_t h = m_h.load(std::memory_order_acquire);
+            for (size_t t = m_t.load(std::memory_order_relaxed); t != h; t = (t + 1) % m_size)
+                fn(m_slots[t]);
+        }
+
+        std::unique_ptr<uint32_t[]> m_slots;
+        size_t m_size = 0;
+        alignas(kCacheLine) std::atomic<size_t> m_h{0};
+        alignas(kCacheLine) std::atomic<size_t> m_t{0};
+    };
+
+    size_t store(const T* src, size_t frames)
+    {
+        size_t n = 0;
+        if (!m_spilling) {
+            n = writeRing(src, frames);
+            if (n == frames || m_pages.empty()) return n;
+            m_spilling = true;
+        }
+        return n + writeSpill(src + n, frames - n);
+    }
+
+    size_t writeRing(const T* src, size_t frames)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        size_t freeFrames = m_capacity - (head - m_cachedTail);
+        if (freeFrames < frames) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            freeFrames   = m_capacity - (head - m_cachedTail);
+        }
+        const size_t n = frames < freeFrames ? frames : freeFrames;
+        if (n == 0) return 0;
+
+        copyIn(head, src, n);
+        m_head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    size_t writeSpill(const T* src, size_t frames)
+    {
+        size_t stored = 0;
+        while (stored < frames) {
+            if (m_writePage == kNoPage) {
+                if (!m_free.pop(m_writePage)) {
+                    m_pendingDrops += frames - stored;   // hard cap reached
+                    break;
+                }
+                SpillPage& fresh   = m_pages[m_writePage];
+                fresh.frames        = 0;
+                fresh.droppedBefore = m_pendingDrops;
+                m_pendingDrops      = 0;
+            }
+            SpillPage& p = m_pages[m_writePage];
+            const size_t n = std::min(kPageFrames - p.frames, frames - stored);
+            std::memcpy(p.data + p.frames, src + stored, n * sizeof(T));
+            p.frames += n;
+            stored   += n;
+            if (p.frames == kPageFrames) {
+                m_filled.push(m_writePage);
+                m_writePage = kNoPage;
+            }
+        }
+        return stored;
+    }
+
+    size_t readRing(T* dst, size_t maxFrames)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t avail = m_cachedHead - tail;
+        if (avail < maxFrames) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            avail        = m_cachedHead - tail;
+        }
+        const size_t n = maxFrames < avail ? maxFrames : avail;
+        if (n == 0) return 0;
+
+        copyOut(tail, dst, n);
+        m_tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // Discards everything currently readable in the primary ring.
+    void clear()
+    {
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        m_tail.store(m_cachedHead, std::memory_order_release);
+    }
+
+    void copyIn(size_t pos, const T* src, size_t n)
+    {
+        const size_t off   = pos % m_capacity;
+        const size_t first = (m_capacity - off) < n ? (m_capacity - off) : n;
+        std::memcpy(m_data.get() + off, src, first * sizeof(T));
+        if (n > first)
+            std::memcpy(m_data.get(), src + first, (n - first) * sizeof(T));
+    }
+
+    void copyOut(size_t pos, T* dst, size_t n) const
+    {
+        const size_t off   = pos % m_capacity;
+        const size_t first = (m_capacity - off) < n ? (m_capacity - off) : n;
+        std::memcpy(dst, m_data.get() + off, first * sizeof(T));
+        if (n > first)
+            std::memcpy(dst + first, m_data.get(), (n - first) * sizeof(T));
+    }
+
+    // Read-only after construction — shared by both sides.
+    size_t                 m_capacity = 0;
+    size_t                 m_channels = 1;
+    std::unique_ptr<T[]>   m_data;
+    std::unique_ptr<T[]>   m_pageStore;
+    std::vector<SpillPage> m_pages;
+    IndexFifo              m_free;     // consumer -> producer
+    IndexFifo              m_filled;   // producer -> consumer
+
+    // Producer-owned line: write index + cached copy of the read index,
+    // plus the spill state only the audio thread touches.
+    alignas(kCacheLine) std::atomic<size_t> m_head{0};
+    size_t   m_cachedTail   = 0;
+    bool     m_spilling     = false;
+    uint32_t m_writePage    = kNoPage;
+    size_t   m_pendingDrops = 0;
+    size_t   m_storedPhase  = 0;   // channel of the next sample stored
+    size_t   m_offeredPhase = 0;   // channel of the next sample passed to write()
+
+    // Consumer-owned line: read index + cached copy of the write index.
+    alignas(kCacheLine) std::atomic<size_t> m_tail{0};
+    size_t   m_cachedHead = 0;
+    uint32_t m_readPage   = kNoPage;
+    size_t   m_readPos    = 0;
+    size_t   m_consumed   = 0;
+    std::vector<CaptureGap> m_gaps;
+};
+
+// 32-bit float samples, as delivered by the device.
+using CaptureRing   = BasicCaptureRing<float>;
+// Compact int16 storage (AudioManager's compact PCM option): half the
+// memory and cache traffic per second of audio.
+using CaptureRing16 = BasicCaptureRing<int16_t>;
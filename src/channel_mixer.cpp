@@ -0,0 +1,153 @@
+// channel_mixer.cpp
+#include "channel_mixer.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+// A frame counts as speech on a channel when its energy is this far above
+// that channel's floor (6 dB).
+static constexpr float  kSpeechRatio  = 4.0f;
+// Floor tracking: drops quickly to any quieter frame, creeps up by a fixed
+// factor per louder one (~1 dB/s, so a sentence barely moves it); faster
+// for the first half second so a new device settles at once.
+static constexpr float  kFloorDown    = 0.2f;
+static constexpr float  kFloorUp      = 1.0023f;
+static constexpr float  kFloorUpEarly = 1.05f;
+static constexpr size_t kEarlyFrames  = 50;
+static constexpr float  kSpeechAlpha  = 0.05f;
+// Select: a challenger must beat the current channel by 3 dB.
+static constexpr float  kSwitchRatio  = 2.0f;
+// Blend: channels more than 10 dB below the best get no weight.
+static constexpr float  kBlendRange   = 0.1f;
+static constexpr float  kMinEnergy    = 1e-10f;
+
+ChannelMixer::ChannelMixer(size_t channels, size_t frameLen, Mode mode)
+    : m_channels(std::max<size_t>(1, channels)), m_frameLen(std::max<size_t>(1, frameLen)), m_mode(mode)
+{
+    m_stats.resize(m_channels);
+    m_weight.assign(m_channels, 0.0f);
+    m_target.assign(m_channels, 0.0f);
+    m_step.assign(m_channels, 0.0f);
+    m_scratch.assign(m_frameLen, 0.0f);
+    m_weight[0] = m_target[0] = 1.0f;
+}
+
+void ChannelMixer::beginUtterance()
+{
+    m_speechFrames = 0;
+}
+
+void ChannelMixer::resetStats()
+{
+    for (Stats& s : m_stats) s = Stats{};
+    m_frames       = 0;
+    m_speechFrames = 0;
+}
+
+float ChannelMixer::snrDb(size_t ch) const
+{
+    const Stats& s = m_stats[ch];
+    return 10.0f * std::log10(std::max(s.speech, kMinEnergy) / std::max(s.floor, kMinEnergy));
+}
+
+void ChannelMixer::process(const float* x, size_t frames, float* out)
+{
+    if (m_channels == 1) {
+        std::copy(x, x + frames, out);
+        return;
+    }
+
+    const size_t ch = m_channels;
+    while (frames > 0) {
+        // Up to the next frame boundary, so stats and ramps stay aligned.
+        const size_t n = std::min(frames, m_frameLen - m_pos);
+        std::fill(out, out + n, 0.0f);
+
+        for (size_t c = 0; c < ch; ++c) {
+            float* d = m_scratch.data();
+            for (size_t i = 0; i < n; ++i) d[i] = x[i * ch + c];
+            m_stats[c].acc += audio_kernels::sumSquares(d, n);
+
+            // Mix this channel in; a weight still ramping moves per sample.
+            float w = m_weight[c];
+            if (m_ramp > 0) {
+                const size_t r = std::min(n, m_ramp);
+                const float  s = m_step[c];
+                for (size_t i = 0; i < r; ++i) { w += s; out[i] += w * d[i]; }
+                if (r == m_ramp) w = m_target[c];
+                for (size_t i = r; i < n; ++i) out[i] += w * d[i];
+            } else if (w != 0.0f) {
+                for (size_t i = 0; i < n; ++i) out[i] += w * d[i];
+            }
+            m_weight[c] = w;
+        }
+        m_ramp -= std::min(n, m_ramp);
+
+        x      += n * ch;
+        out    += n;
+        frames -= n;
+        m_pos  += n;
+        if (m_pos == m_frameLen) {
+            endFrame();
+            m_pos = 0;
+        }
+    }
+}
+
+void ChannelMixer::endFrame()
+{
+    const float inv     = 1.0f / static_cast<float>(m_frameLen);
+    const float upRate  = m_frames < kEarlyFrames ? kFloorUpEarly : kFloorUp;
+    bool speech = false;
+
+    for (Stats& s : m_stats) {
+        const float e = std::max(s.acc * inv, kMinEnergy);
+        s.acc = 0.0f;
+        if (s.floor == 0.0f) s.floor = e;
+        if (e > s.floor * kSpeechRatio) {
+            s.speech += (e - s.speech) * kSpeechAlpha;
+            speech = true;
+        }
+        if (e < s.floor) s.floor += (e - s.floor) * kFloorDown;
+        else             s.floor  = std::min(e, s.floor * upRate);
+    }
+    ++m_frames;
+
+    if (speech && m_speechFrames < kLockFrames) {
+        ++m_speechFrames;
+        decideWeights();
+    }
+}
+
+void ChannelMixer::decideWeights()
+{
+    std::vector<float>& t = m_target;
+    std::vector<float> snr(m_channels);
+    size_t best = 0;
+    for (size_t c = 0; c < m_channels; ++c) {
+        const Stats& s = m_stats[c];
+        snr[c] = std::max(s.speech, kMinEnergy) / std::max(s.floor, kMinEnergy);
+        if (snr[c] > snr[best]) best = c;
+    }
+
+    if (m_mode == Mode::Select) {
+        // Hysteresis: keep the current channel unless clearly beaten.
+        if (snr[best] < snr[m_best] * kSwitchRatio) best = m_best;
+        std::fill(t.begin(), t.end(), 0.0f);
+        t[best] = 1.0f;
+    } else {
+        // Weight by SNR (maximal-ratio style), normalised to unity sum.
+        float sum = 0.0f;
+        for (size_t c = 0; c < m_channels; ++c) {
+            t[c] = snr[c] >= snr[best] * kBlendRange ? snr[c] : 0.0f;
+            sum += t[c];
+        }
+        for (float& w : t) w /= sum;
+    }
+    m_best = best;
+
+    // Crossfade to the new weights over the next frame.
+    for (size_t c = 0; c < m_channels; ++c)
+        m_step[c] = (t[c] - m_weight[c]) / static_cast<float>(m_frameLen);
+    m_ramp = m_frameLen;
+}
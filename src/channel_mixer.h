@@ -0,0 +1,69 @@
+#pragma once
+// channel_mixer.h — per-utterance channel selection for multi-mic capture.
+//
+// Array microphones and docks deliver several channels of the same room.
+// The consumer stage feeds every interleaved block through here; each
+// channel's energy is measured per 10 ms frame (SIMD sumSquares over the
+// deinterleaved samples), giving a per-channel noise floor, speech level
+// and so SNR.  The mono output is either the best channel (Select) or an
+// SNR-weighted blend of every channel within 10 dB of it (Blend).
+//
+// Weights are re-decided every frame until the utterance has 300 ms of
+// speech, then held until the next beginUtterance(), so the pick fits
+// this talker's position without switching mid-sentence.  Weight changes
+// are crossfaded across one frame.  Single-channel input passes through.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ChannelMixer {
+public:
+    enum class Mode { Select, Blend };
+
+    static constexpr size_t kLockFrames = 30;   // speech frames before the weights hold (300 ms)
+
+    // frameLen: samples per channel in one 10 ms frame at the capture rate.
+    ChannelMixer(size_t channels, size_t frameLen, Mode mode = Mode::Select);
+
+    void setMode(Mode m) { m_mode = m; }
+    size_t channels() const { return m_channels; }
+
+    // New utterance: weights may move again.  Levels carry over.
+    void beginUtterance();
+
+    // New input device (hot-plug): forgets floors and levels too.
+    void resetStats();
+
+    // Mixes frames of interleaved input into mono out[0, frames).
+    void process(const float* interleaved, size_t frames, float* out);
+
+    // Per-channel SNR in dB (speech level over noise floor) and current weights.
+    float  snrDb(size_t ch) const;
+    float  weight(size_t ch) const { return m_target[ch]; }
+    size_t bestChannel() const { return m_best; }
+    bool   locked() const { return m_speechFrames >= kLockFrames; }
+
+private:
+    struct Stats {
+        float floor  = 0.0f;   // mean-square noise floor
+        float speech = 0.0f;   // mean-square speech level
+        float acc    = 0.0f;   // energy accumulated in the current frame
+    };
+
+    void endFrame();
+    void decideWeights();
+
+    size_t             m_channels;
+    size_t             m_frameLen;
+    Mode               m_mode;
+    std::vector<Stats> m_stats;
+    std::vector<float> m_weight;     // applied at the current sample
+    std::vector<float> m_target;     // weight at the end of the ramp
+    std::vector<float> m_step;       // per-sample ramp increment
+    std::vector<float> m_scratch;    // one deinterleaved channel, up to m_frameLen
+    size_t             m_pos          = 0;   // samples into the current frame
+    size_t             m_ramp         = 0;   // samples left in the crossfade
+    size_t             m_best         = 0;
+    size_t             m_speechFrames = 0;   // in this utterance
+    size_t             m_frames       = 0;   // since resetStats()
+};
@@ -10,15 +10,31 @@ using json = nlohmann::json;
 namespace fs = std::filesystem;
 
 // ------------------------------------------------------------------
-// Returns %APPDATA%\FLOW-ON\settings.json
+// Returns %APPDATA%\FLOW-ON (and the files kept there)
 // ------------------------------------------------------------------
-std::wstring ConfigManager::settingsPath() const
+std::wstring ConfigManager::dataDir() const
 {
     wchar_t appData[MAX_PATH] = {};
     SHGetFolderPathW(nullptr, CSIDL_APPDATA, nullptr, SHGFP_TYPE_CURRENT, appData);
     std::wstring dir = std::wstring(appData) + L"\\FLOW-ON";
     fs::create_directories(fs::path(dir));   // no-op if already exists
-    return dir + L"\\settings.json";
+    return dir;
+}
+
+std::wstring ConfigManager::settingsPath() const
+{
+    return dataDir() + L"\\settings.json";
+}
+
+std::wstring ConfigManager::journalPath(size_t index) const
+{
+    if (index == 0) return dataDir() + L"\\recording.journal";
+    return dataDir() + L"\\recording-" + std::to_wstring(index) + L".journal";
+}
+
+std::wstring ConfigManager::usagePath() const
+{
+    return dataDir() + L"\\usage.json";
 }
 
 bool ConfigManager::load()
@@ -37,6 +53,7 @@ bool ConfigManager::load()
         if (j.contains("hotkey"))             m_settings.hotkey           = j["hotkey"];
         if (j.contains("mode"))               m_settings.modeStr          = j["mode"];
         if (j.contains("model"))              m_settings.model            = j["model"];
+        if (j.contains("vad_model"))          m_settings.vadModel         = j["vad_model"];
         if (j.contains("use_gpu"))            m_settings.useGPU           = j["use_gpu"];
         if (j.contains("start_with_windows")) m_settings.startWithWindows = j["start_with_windows"];
         if (j.contains("idle_unload_sec")) {
@@ -44,6 +61,33 @@ bool ConfigManager::load()
             if (m_settings.idleUnloadSec < 15) m_settings.idleUnloadSec = 15;
             if (m_settings.idleUnloadSec > 600) m_settings.idleUnloadSec = 600;
         }
+        if (j.contains("state_unload_sec")) {
+            m_settings.stateUnloadSec = j["state_unload_sec"];
+            if (m_settings.stateUnloadSec < 5) m_settings.stateUnloadSec = 5;
+            if (m_settings.stateUnloadSec > 600) m_settings.stateUnloadSec = 600;
+        }
+        if (j.contains("noise_suppression"))  m_settings.noiseSuppression  = j["noise_suppression"];
+        if (j.contains("input_conditioning")) m_settings.inputConditioning = j["input_conditioning"];
+        if (j.contains("compact_pcm"))        m_settings.compactPcm       = j["compact_pcm"];
+        if (j.contains("recording_journal"))  m_settings.recordingJournal = j["recording_journal"];
+        if (j.contains("streaming_transcription")) m_settings.streamingTranscription = j["streaming_transcription"];
+        if (j.contains("predictive_warmup"))  m_settings.predictiveWarmup = j["predictive_warmup"];
+        if (j.contains("parallel_transcriptions")) {
+            m_settings.parallelTranscriptions = j["parallel_transcriptions"];
+            if (m_settings.parallelTranscriptions < 0) m_settings.parallelTranscriptions = 0;
+            if (m_settings.parallelTranscriptions > 8) m_settings.parallelTranscriptions = 8;
+        }
+        if (j.contains("capture_channels")) {
+            m_settings.captureChannels = j["capture_channels"];
+            if (m_settings.captureChannels < 0)  m_settings.captureChannels = 0;
+            if (m_settings.captureChannels > 32) m_settings.captureChannels = 32;
+        }
+        if (j.contains("channel_mix"))        m_settings.channelMix       = j["channel_mix"];
+        if (j.contains("preroll_ms")) {
+            m_settings.prerollMs = j["preroll_ms"];
+            if (m_settings.prerollMs < 0)    m_settings.prerollMs = 0;
+            if (m_settings.prerollMs > 1000) m_settings.prerollMs = 1000;
+        }
 
         if (j.contains("snippets") && j["snippets"].is_object()) {
             m_settings.snippets.clear();
@@ -72,9 +116,21 @@ bool ConfigManager::save() const
     j["hotkey"]             = m_settings.hotkey;
     j["mode"]               = m_settings.modeStr;
     j["model"]              = m_settings.model;
+    j["vad_model"]          = m_settings.vadModel;
     j["use_gpu"]            = m_settings.useGPU;
     j["start_with_windows"] = m_settings.startWithWindows;
     j["idle_unload_sec"]    = m_settings.idleUnloadSec;
+    j["state_unload_sec"]   = m_settings.stateUnloadSec;
+    j["preroll_ms"]         = m_settings.prerollMs;
+    j["noise_suppression"]  = m_settings.noiseSuppression;
+    j["input_conditioning"] = m_settings.inputConditioning;
+    j["compact_pcm"]        = m_settings.compactPcm;
+    j["recording_journal"]  = m_settings.recordingJournal;
+    j["streaming_transcription"] = m_settings.streamingTranscription;
+    j["parallel_transcriptions"] = m_settings.parallelTranscriptions;
+    j["predictive_warmup"]  = m_settings.predictiveWarmup;
+    j["capture_channels"]   = m_settings.captureChannels;
+    j["channel_mix"]        = m_settings.channelMix;
 
     json snips;
     for (auto& [k, v] : m_settings.snippets)
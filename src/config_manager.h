@@ -9,9 +9,21 @@ struct AppSettings {
     std::string hotkey           = "Alt+V";
     std::string modeStr          = "auto";   // "auto" | "prose" | "code"
     std::string model            = "tiny.en";
+    std::string vadModel         = "";        // e.g. "silero-v5.1.2"; empty = off
     bool        useGPU           = true;
     bool        startWithWindows = true;
     int         idleUnloadSec    = 120;   // keep model warm longer
+    int         stateUnloadSec   = 30;    // free worker states (KV caches) sooner; weights stay
+    int         prerollMs        = 0;     // >0: keep the mic armed with this much pre-roll
+    bool        noiseSuppression  = false; // Wiener denoiser ahead of Whisper
+    bool        inputConditioning = false; // high-pass + look-ahead AGC
+    bool        compactPcm       = false; // int16 ring + recording pages
+    bool        recordingJournal = false; // crash-safe copy of the recording on disk
+    bool        streamingTranscription = false; // decode while recording; only the tail at release
+    int         parallelTranscriptions = 0;     // jobs at once on one model; 0 = by core count
+    bool        predictiveWarmup = false; // learn when dictation is likely; preload / evict on it
+    int         captureChannels  = 0;     // 0 = every channel the device has
+    std::string channelMix       = "select";  // "select" | "blend" (multi-channel input)
     std::unordered_map<std::string, std::string> snippets = {
         { "insert email",     "you@yourdomain.com" },
         { "insert todo",      "// TODO: " },
@@ -34,7 +46,15 @@ public:
     void applyAutostart(const std::wstring& exePath) const;
     void removeAutostart() const;
 
+    // %APPDATA%\FLOW-ON\recording.journal, recording-1.journal, ... — one
+    // file per journaled recording (see RecordingJournal).
+    std::wstring journalPath(size_t index = 0) const;
+
+    // %APPDATA%\FLOW-ON\usage.json (see UsagePredictor).
+    std::wstring usagePath() const;
+
 private:
     AppSettings m_settings;
+    std::wstring dataDir() const;        // %APPDATA%\FLOW-ON, created on demand
     std::wstring settingsPath() const;   // full path to settings.json
 };
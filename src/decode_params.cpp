@@ -0,0 +1,71 @@
+// decode_params.cpp — shared whisper_full settings for dictation.
+#include "decode_params.h"
+
+#include <algorithm>
+#include <thread>
+
+whisper_full_params baseDecodeParams(int running)
+{
+    whisper_full_params p = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+
+    // -- Threading: reserve 1 core for the UI / OS and split the rest
+    //    over the jobs running.  A job keeps its share to the end, so a
+    //    second one starting beside a lone job briefly oversubscribes. --
+    const int hw = static_cast<int>(std::thread::hardware_concurrency());
+    p.n_threads   = std::max(1, (hw - 1) / std::max(1, running));   // 7 of 8 logical cores alone
+
+    p.language    = "en";
+    p.translate   = false;
+    p.no_context  = true;
+
+    // -- Segment / timestamp optimisations --
+    p.single_segment   = true;
+    p.no_timestamps    = true;
+    p.token_timestamps = false;
+    p.print_special    = false;
+    p.print_progress   = false;
+    p.print_realtime   = false;
+    p.print_timestamps = false;
+
+    // -- Decoding: use best_of=1 for speed --
+    p.greedy.best_of    = 1;     // 1 candidate for speed
+    p.temperature       = 0.0f;  // pure greedy — fastest decode
+    p.temperature_inc   = 0.2f;  // skip fallback quickly
+    p.entropy_thold     = 2.2f;  // tighter: reject noisy segments faster
+    p.logprob_thold     = -0.8f; // tighter: drop low-confidence tokens
+    p.no_speech_thold   = 0.65f; // reject silence/noise faster
+
+    // -- Blank suppression --
+    p.suppress_blank = true;
+    p.suppress_nst   = true;    // suppress non-speech tokens
+
+    // -- No initial prompt (saves token encoding overhead) --
+    p.initial_prompt = nullptr;
+    return p;
+}
+
+int audioCtxFor(float durationSec)
+{
+    if      (durationSec < 2.0f)  return 128;   // Ultra-fast for short commands
+    else if (durationSec < 5.0f)  return 192;   // Short phrases
+    else if (durationSec < 10.0f) return 256;   // Medium dictation
+    else if (durationSec < 20.0f) return 384;   // Longer dictation
+    else                          return 512;   // Cap for long audio
+}
+
+// Balance speed and accuracy by allowing more output on longer utterances.
+int maxTokensFor(float durationSec)
+{
+    if      (durationSec < 4.0f)  return 72;
+    else if (durationSec < 10.0f) return 128;
+    else                          return 196;
+}
+
+whisper_full_params clipDecodeParams(size_t samples, int running)
+{
+    whisper_full_params p = baseDecodeParams(running);
+    const float durationSec = static_cast<float>(samples) / 16000.0f;
+    p.audio_ctx  = audioCtxFor(durationSec);
+    p.max_tokens = maxTokensFor(durationSec);
+    return p;
+}
@@ -0,0 +1,23 @@
+#pragma once
+// decode_params.h — the whisper_full settings every dictation decode uses.
+//
+// Transcriber builds each job's parameters here; the benches that time or
+// compare whisper_full against it take theirs from the same functions, so
+// a tuning change reaches both at once.
+#include "whisper.h"
+
+#include <cstddef>
+
+// Settings shared by whole-recording jobs and streaming passes; the caller
+// sets audio_ctx and the token budget for its clip.  `running` is how many
+// jobs are in whisper_full now, this one included.
+whisper_full_params baseDecodeParams(int running);
+
+// Encoder context and output budget for a clip of the given length —
+// aggressive scaling for dictation speed.
+int audioCtxFor(float durationSec);
+int maxTokensFor(float durationSec);
+
+// baseDecodeParams() sized for `samples` of 16 kHz audio, as Transcriber::run
+// decodes a recording.
+whisper_full_params clipDecodeParams(size_t samples, int running);
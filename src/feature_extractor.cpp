@@ -0,0 +1,82 @@
+// feature_extractor.cpp
+#include "feature_extractor.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cstring>
+
+void FeatureExtractor::reset()
+{
+    m_frames.clear();
+    m_summary    = FeatureSummary{};
+    m_partialLen = 0;
+    m_samples    = 0;
+}
+
+void FeatureExtractor::emit(const float* x, size_t n)
+{
+    namespace ak = audio_kernels;
+
+    FeatureFrame f;
+    f.energy = ak::sumSquares(x, n) / static_cast<float>(n);
+    f.peak   = ak::peakAbs(x, n);
+    f.zcr    = n > 1 ? static_cast<float>(ak::countZeroCrossings(x, n)) / static_cast<float>(n - 1)
+                     : 0.0f;
+    f.voiced = f.energy >= m_voicedThreshold * m_voicedThreshold;
+
+    const size_t idx = m_frames.size();
+    m_frames.push_back(f);
+
+    m_summary.frames++;
+    if (f.voiced) m_summary.voicedFrames++;
+    if (f.peak > m_loudThreshold) {
+        if (m_summary.firstLoudFrame == SIZE_MAX) m_summary.firstLoudFrame = idx;
+        m_summary.lastLoudFrame = idx;
+    }
+    m_summary.peak = std::max(m_summary.peak, f.peak);
+}
+
+size_t FeatureExtractor::push(const float* x, size_t n)
+{
+    const size_t before = m_frames.size();
+    m_samples += n;
+
+    // Top up a partial frame left over from the previous block.
+    if (m_partialLen > 0) {
+        const size_t take = std::min(kFrameSamples - m_partialLen, n);
+        std::memcpy(m_partial + m_partialLen, x, take * sizeof(float));
+        m_partialLen += take;
+        x += take;
+        n -= take;
+        if (m_partialLen < kFrameSamples) return 0;
+        emit(m_partial, kFrameSamples);
+        m_partialLen = 0;
+    }
+
+    // Whole frames straight from the caller's buffer.
+    for (; n >= kFrameSamples; x += kFrameSamples, n -= kFrameSamples)
+        emit(x, kFrameSamples);
+
+    if (n > 0) {
+        std::memcpy(m_partial, x, n * sizeof(float));
+        m_partialLen = n;
+    }
+    return m_frames.size() - before;
+}
+
+void FeatureExtractor::finish()
+{
+    if (m_partialLen > 0) {
+        emit(m_partial, m_partialLen);
+        m_partialLen = 0;
+    }
+}
+
+void FeatureExtractor::loudRange(size_t& begin, size_t& end) const
+{
+    if (m_summary.firstLoudFrame == SIZE_MAX) {
+        begin = end = 0;
+        return;
+    }
+    begin = m_summary.firstLoudFrame * kFrameSamples;
+    end   = std::min(m_samples, (m_summary.lastLoudFrame + 1) * kFrameSamples);
+}
@@ -0,0 +1,65 @@
+#pragma once
+// feature_extractor.h — streaming per-10 ms feature frames.
+//
+// The consumer stage pushes every block of the recording through here as
+// it arrives.  Each complete 160-sample frame becomes one compact
+// FeatureFrame, and a running FeatureSummary is kept alongside, so the VAD,
+// the overlay meter, the silence gate and trimming all read precomputed
+// numbers instead of rescanning PCM after the hotkey is released.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct FeatureFrame {
+    float energy = 0.0f;   // mean square
+    float peak   = 0.0f;   // max |x|
+    float zcr    = 0.0f;   // zero crossings per sample, [0, 1]
+    bool  voiced = false;  // rms >= voiced threshold at the time of capture
+};
+
+// O(1) aggregate over all frames so far.
+struct FeatureSummary {
+    size_t frames         = 0;          // complete (or flushed) frames
+    size_t voicedFrames   = 0;
+    size_t firstLoudFrame = SIZE_MAX;   // first frame with peak > loud threshold
+    size_t lastLoudFrame  = 0;
+    float  peak           = 0.0f;
+};
+
+class FeatureExtractor {
+public:
+    static constexpr size_t kFrameSamples = 160;   // 10 ms at 16 kHz
+
+    // loudThreshold: peak amplitude that counts as "not silence" for trimming.
+    explicit FeatureExtractor(float loudThreshold = 0.005f) : m_loudThreshold(loudThreshold) {}
+
+    // Clears frames and the partial-frame remainder; keeps capacity.
+    void reset();
+
+    // Frames are flagged voiced when their RMS reaches this amplitude.
+    void setVoicedThreshold(float t) { m_voicedThreshold = t; }
+
+    // Appends samples; emits one frame per 160 samples.  Returns the number
+    // of new frames.
+    size_t push(const float* x, size_t n);
+
+    // Emits a frame for any trailing partial block (end of recording).
+    void finish();
+
+    const std::vector<FeatureFrame>& frames()  const { return m_frames; }
+    const FeatureSummary&            summary() const { return m_summary; }
+
+    // Sample range [begin, end) covered by the loud frames; empty if none.
+    void loudRange(size_t& begin, size_t& end) const;
+
+private:
+    void emit(const float* x, size_t n);
+
+    float                     m_loudThreshold;
+    float                     m_voicedThreshold = 0.0065f;
+    std::vector<FeatureFrame> m_frames;
+    FeatureSummary            m_summary;
+    float                     m_partial[kFrameSamples] = {};
+    size_t                    m_partialLen = 0;
+    size_t                    m_samples    = 0;   // total samples pushed
+};
@@ -0,0 +1,191 @@
+// fft.cpp
+#include "fft.h"
+#include <cmath>
+
+static constexpr double kTwoPi = 6.283185307179586;
+
+RealFft::RealFft(size_t n) : m_n(n), m_half(n / 2)
+{
+    // Factor the complex length: 4s first (cheapest per point), then 2,
+    // 3, 5 and whatever prime is left.
+    size_t rest = m_half, len = m_half, stride = 1;
+    auto addStage = [&](size_t p) {
+        Stage st;
+        st.p = p;
+        st.n = len;
+        st.s = stride;
+        const size_t m = len / p;
+        st.twRe.resize(m * (p - 1));
+        st.twIm.resize(m * (p - 1));
+        for (size_t q = 0; q < m; ++q)
+            for (size_t r = 1; r < p; ++r) {
+                const double a = -kTwoPi * static_cast<double>(q * r) / static_cast<double>(len);
+                st.twRe[q * (p - 1) + r - 1] = static_cast<float>(std::cos(a));
+                st.twIm[q * (p - 1) + r - 1] = static_cast<float>(std::sin(a));
+            }
+        if (p != 2 && p != 4) {
+            st.dftRe.resize(p * p);
+            st.dftIm.resize(p * p);
+            for (size_t r = 0; r < p; ++r)
+                for (size_t t = 0; t < p; ++t) {
+                    const double a = -kTwoPi * static_cast<double>((r * t) % p) / static_cast<double>(p);
+                    st.dftRe[r * p + t] = static_cast<float>(std::cos(a));
+                    st.dftIm[r * p + t] = static_cast<float>(std::sin(a));
+                }
+        }
+        m_stages.push_back(std::move(st));
+        len    /= p;
+        stride *= p;
+        rest   /= p;
+    };
+    while (rest % 4 == 0) addStage(4);
+    while (rest % 2 == 0) addStage(2);
+    for (size_t p = 3; rest > 1; p += 2)
+        while (rest % p == 0) addStage(p);
+
+    m_rotRe.resize(m_half + 1);
+    m_rotIm.resize(m_half + 1);
+    for (size_t k = 0; k <= m_half; ++k) {
+        const double a = -kTwoPi * static_cast<double>(k) / static_cast<double>(m_n);
+        m_rotRe[k] = static_cast<float>(std::cos(a));
+        m_rotIm[k] = static_cast<float>(std::sin(a));
+    }
+    m_bufRe.resize(m_half);
+    m_bufIm.resize(m_half);
+    m_tmpRe.resize(m_half);
+    m_tmpIm.resize(m_half);
+}
+
+// ------------------------------------------------------------------
+// Stockham DIF: stage with radix p reads x[j + s(q + m r)] and writes
+// y[j + s(p q + r)] = w^(q r) * DFT_p(...)_r.  j runs over the contiguous
+// stride, so each butterfly's inner loop is straight-line SIMD work.
+// ------------------------------------------------------------------
+void RealFft::complexForward(float* re, float* im)
+{
+    float* xr = re;           float* xi = im;
+    float* yr = m_tmpRe.data(); float* yi = m_tmpIm.data();
+
+    for (const Stage& st : m_stages) {
+        const size_t p = st.p, s = st.s, m = st.n / p;
+
+        for (size_t q = 0; q < m; ++q) {
+            const float* wr = st.twRe.data() + q * (p - 1);
+            const float* wi = st.twIm.data() + q * (p - 1);
+
+            if (p == 4) {
+                const float* ar0 = xr + s * q;           const float* ai0 = xi + s * q;
+                const float* ar1 = xr + s * (q + m);     const float* ai1 = xi + s * (q + m);
+                const float* ar2 = xr + s * (q + 2 * m); const float* ai2 = xi + s * (q + 2 * m);
+                const float* ar3 = xr + s * (q + 3 * m); const float* ai3 = xi + s * (q + 3 * m);
+                float* o0r = yr + s * (4 * q);     float* o0i = yi + s * (4 * q);
+                float* o1r = yr + s * (4 * q + 1); float* o1i = yi + s * (4 * q + 1);
+                float* o2r = yr + s * (4 * q + 2); float* o2i = yi + s * (4 * q + 2);
+                float* o3r = yr + s * (4 * q + 3); float* o3i = yi + s * (4 * q + 3);
+                const float w1r = wr[0], w1i = wi[0], w2r = wr[1], w2i = wi[1], w3r = wr[2], w3i = wi[2];
+                for (size_t j = 0; j < s; ++j) {
+                    const float s02r = ar0[j] + ar2[j], s02i = ai0[j] + ai2[j];
+                    const float d02r = ar0[j] - ar2[j], d02i = ai0[j] - ai2[j];
+                    const float s13r = ar1[j] + ar3[j], s13i = ai1[j] + ai3[j];
+                    const float d13r = ar1[j] - ar3[j], d13i = ai1[j] - ai3[j];
+                    // X1 = d02 - i d13,  X3 = d02 + i d13
+                    const float x1r = d02r + d13i, x1i = d02i - d13r;
+                    const float x2r = s02r - s13r, x2i = s02i - s13i;
+                    const float x3r = d02r - d13i, x3i = d02i + d13r;
+                    o0r[j] = s02r + s13r;             o0i[j] = s02i + s13i;
+                    o1r[j] = x1r * w1r - x1i * w1i;   o1i[j] = x1r * w1i + x1i * w1r;
+                    o2r[j] = x2r * w2r - x2i * w2i;   o2i[j] = x2r * w2i + x2i * w2r;
+                    o3r[j] = x3r * w3r - x3i * w3i;   o3i[j] = x3r * w3i + x3i * w3r;
+                }
+            } else if (p == 2) {
+                const float* ar0 = xr + s * q;       const float* ai0 = xi + s * q;
+                const float* ar1 = xr + s * (q + m); const float* ai1 = xi + s * (q + m);
+                float* o0r = yr + s * (2 * q);     float* o0i = yi + s * (2 * q);
+                float* o1r = yr + s * (2 * q + 1); float* o1i = yi + s * (2 * q + 1);
+                const float w1r = wr[0], w1i = wi[0];
+                for (size_t j = 0; j < s; ++j) {
+                    const float dr = ar0[j] - ar1[j], di = ai0[j] - ai1[j];
+                    o0r[j] = ar0[j] + ar1[j];       o0i[j] = ai0[j] + ai1[j];
+                    o1r[j] = dr * w1r - di * w1i;   o1i[j] = dr * w1i + di * w1r;
+                }
+            } else {
+                // Generic radix (3, 5, other primes): direct p-point DFT.
+                for (size_t r = 0; r < p; ++r) {
+                    float* or_ = yr + s * (p * q + r);
+                    float* oi  = yi + s * (p * q + r);
+                    for (size_t j = 0; j < s; ++j) { or_[j] = 0.0f; oi[j] = 0.0f; }
+                    for (size_t t = 0; t < p; ++t) {
+                        const float  cr = st.dftRe[r * p + t], ci = st.dftIm[r * p + t];
+                        const float* ar = xr + s * (q + m * t);
+                        const float* ai = xi + s * (q + m * t);
+                        for (size_t j = 0; j < s; ++j) {
+                            or_[j] += ar[j] * cr - ai[j] * ci;
+                            oi[j]  += ar[j] * ci + ai[j] * cr;
+                        }
+                    }
+                    if (r > 0) {
+                        const float twr = wr[r - 1], twi = wi[r - 1];
+                        for (size_t j = 0; j < s; ++j) {
+                            const float vr = or_[j], vi = oi[j];
+                            or_[j] = vr * twr - vi * twi;
+                            oi[j]  = vr * twi + vi * twr;
+                        }
+                    }
+                }
+            }
+        }
+        std::swap(xr, yr);
+        std::swap(xi, yi);
+    }
+
+    if (xr != re) {
+        std::copy(xr, xr + m_half, re);
+        std::copy(xi, xi + m_half, im);
+    }
+}
+
+void RealFft::forward(const float* x, float* re, float* im)
+{
+    // Pack even/odd samples as one complex signal of length n/2.
+    for (size_t k = 0; k < m_half; ++k) {
+        m_bufRe[k] = x[2 * k];
+        m_bufIm[k] = x[2 * k + 1];
+    }
+    complexForward(m_bufRe.data(), m_bufIm.data());
+
+    // Split: X[k] = E[k] + w^k O[k], with E/O recovered from Z[k], Z[h-k]*.
+    const float* zr = m_bufRe.data();
+    const float* zi = m_bufIm.data();
+    for (size_t k = 0; k <= m_half; ++k) {
+        const size_t a = k % m_half, b = (m_half - k) % m_half;
+        const float er = 0.5f * (zr[a] + zr[b]), ei = 0.5f * (zi[a] - zi[b]);
+        const float or_ = 0.5f * (zi[a] + zi[b]), oi = -0.5f * (zr[a] - zr[b]);
+        re[k] = er + m_rotRe[k] * or_ - m_rotIm[k] * oi;
+        im[k] = ei + m_rotRe[k] * oi + m_rotIm[k] * or_;
+    }
+}
+
+void RealFft::inverse(const float* re, const float* im, float* x)
+{
+    // Rebuild Z[k] = E[k] + i O[k], then invert through the forward
+    // transform by conjugation.
+    for (size_t k = 0; k < m_half; ++k) {
+        const size_t b = m_half - k;
+        const float ar = re[k], ai = k == 0 ? 0.0f : im[k];
+        const float br = re[b], bi = b == m_half ? 0.0f : im[b];
+        const float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);
+        const float dr = 0.5f * (ar - br), di = 0.5f * (ai + bi);
+        // O = (X[k] - X[h-k]*) * conj(w^k)
+        const float or_ = dr * m_rotRe[k] + di * m_rotIm[k];
+        const float oi  = di * m_rotRe[k] - dr * m_rotIm[k];
+        m_bufRe[k] = er - oi;          // Z = E + i O, conjugated for the
+        m_bufIm[k] = -(ei + or_);      // forward-as-inverse trick
+    }
+    complexForward(m_bufRe.data(), m_bufIm.data());
+
+    const float scale = 1.0f / static_cast<float>(m_n);
+    for (size_t k = 0; k < m_half; ++k) {
+        x[2 * k]     =  m_bufRe[k] * scale * 2.0f;
+        x[2 * k + 1] = -m_bufIm[k] * scale * 2.0f;
+    }
+}
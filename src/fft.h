@@ -0,0 +1,46 @@
+#pragma once
+// fft.h — mixed-radix real FFT for the audio consumer stage.
+//
+// Sizes are whatever the DSP needs rather than powers of two: 320 (20 ms
+// noise-suppression frames) and 400 (Whisper's n_fft) factor as 2^a 5^b,
+// so the transform decomposes into radix-4, 2, 3 and 5 passes (any other
+// prime factor falls back to a generic butterfly).  It is a Stockham
+// autosort FFT on split real/imaginary arrays: no bit reversal, and every
+// butterfly's inner loop walks contiguous memory, which the compiler
+// vectorises.  A real input of size n runs as one complex FFT of n/2.
+//
+// Not thread-safe: each user owns its plan (it holds scratch buffers).
+#include <cstddef>
+#include <vector>
+
+class RealFft {
+public:
+    explicit RealFft(size_t n);   // n must be even
+
+    size_t size() const { return m_n; }
+    size_t bins() const { return m_n / 2 + 1; }
+
+    // x[0, n) -> re/im[0, n/2]  (unnormalised)
+    void forward(const float* x, float* re, float* im);
+
+    // re/im[0, n/2] -> x[0, n), scaled by 1/n so inverse(forward(x)) == x.
+    // The imaginary parts of bins 0 and n/2 are ignored.
+    void inverse(const float* re, const float* im, float* x);
+
+private:
+    struct Stage {
+        size_t p;                   // radix
+        size_t n;                   // sub-transform length entering the stage
+        size_t s;                   // stride (number of interleaved transforms)
+        std::vector<float> twRe, twIm;   // w^(q r), q < n/p, 1 <= r < p
+        std::vector<float> dftRe, dftIm; // p x p roots, generic radix only
+    };
+
+    void complexForward(float* re, float* im);   // in place, length m_half
+
+    size_t m_n, m_half;
+    std::vector<Stage> m_stages;
+    std::vector<float> m_rotRe, m_rotIm;         // e^{-2 pi i k / n}, k <= n/4 .. n/2
+    std::vector<float> m_bufRe, m_bufIm;         // packed input / output
+    std::vector<float> m_tmpRe, m_tmpIm;         // Stockham ping-pong
+};
@@ -0,0 +1,91 @@
+// local_agreement.cpp — LocalAgreement-2 over timed words.
+#include "local_agreement.h"
+
+#include <algorithm>
+#include <cctype>
+
+// A word decoded by two passes may differ in case, punctuation or the
+// leading space ("Hello," vs " hello"); compare letters and digits only.
+static std::string normalized(const std::string& w)
+{
+    std::string out;
+    out.reserve(w.size());
+    for (unsigned char c : w)
+        if (std::isalnum(c)) out.push_back(static_cast<char>(std::tolower(c)));
+    return out;
+}
+
+static bool sameWord(const TimedWord& a, const TimedWord& b)
+{
+    return normalized(a.text) == normalized(b.text);
+}
+
+static void appendWord(std::string& text, const std::string& word)
+{
+    if (text.empty()) {
+        const size_t first = word.find_first_not_of(' ');
+        if (first != std::string::npos) text.append(word, first, std::string::npos);
+        return;
+    }
+    if (!word.empty() && word.front() != ' ' && text.back() != ' ') text.push_back(' ');
+    text += word;
+}
+
+size_t LocalAgreement::insert(std::vector<TimedWord> words)
+{
+    // Token times are coarse; keep words that end just inside the committed
+    // audio, then drop any that repeat its last few words.
+    constexpr size_t kSlack = 1600;   // 100 ms
+    const size_t done = committedEnd();
+    if (done > 0) {
+        words.erase(std::remove_if(words.begin(), words.end(),
+                        [done](const TimedWord& w) { return w.end + kSlack <= done; }),
+                    words.end());
+        constexpr size_t kMaxNgram = 5;
+        if (!words.empty() && words.front().begin < done + 16000) {
+            const size_t longest = std::min({ kMaxNgram, m_committed.size(), words.size() });
+            for (size_t n = longest; n >= 1; --n) {
+                bool repeat = true;
+                for (size_t i = 0; i < n && repeat; ++i)
+                    repeat = sameWord(m_committed[m_committed.size() - n + i], words[i]);
+                if (repeat) {
+                    words.erase(words.begin(), words.begin() + static_cast<std::ptrdiff_t>(n));
+                    break;
+                }
+            }
+        }
+    }
+
+    // Commit the prefix this pass and the previous one agree on.
+    size_t agreed = 0;
+    while (agreed < words.size() && agreed < m_previous.size()
+           && sameWord(words[agreed], m_previous[agreed])) {
+        appendWord(m_text, words[agreed].text);
+        m_committed.push_back(words[agreed]);
+        ++agreed;
+    }
+    m_previous.assign(std::make_move_iterator(words.begin() + static_cast<std::ptrdiff_t>(agreed)),
+                      std::make_move_iterator(words.end()));
+    return agreed;
+}
+
+std::string LocalAgreement::tentativeText() const
+{
+    std::string out;
+    for (const TimedWord& w : m_previous) appendWord(out, w.text);
+    return out;
+}
+
+std::string LocalAgreement::prompt(size_t maxChars) const
+{
+    if (m_text.size() <= maxChars) return m_text;
+    const size_t cut = m_text.find(' ', m_text.size() - maxChars);
+    return cut == std::string::npos ? std::string{} : m_text.substr(cut + 1);
+}
+
+void LocalAgreement::reset()
+{
+    m_committed.clear();
+    m_previous.clear();
+    m_text.clear();
+}
@@ -0,0 +1,50 @@
+#pragma once
+// local_agreement.h — stable-prefix commit policy for streaming transcription.
+//
+// While the user is still speaking, Whisper is re-run on a sliding window
+// of the live recording.  Each pass yields a hypothesis for the whole
+// window, and its last few words keep changing as more audio arrives.
+// Local agreement (LocalAgreement-2) commits a word only once two
+// consecutive passes agree on it: the longest common prefix of the new
+// hypothesis and the previous one, after the text already committed.
+// Committed words are final.  The rest is the tentative tail, and only that
+// tail's audio needs decoding once the recording stops.
+//
+// Word times are sample indices into the recording (16 kHz).
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct TimedWord {
+    std::string text;        // as decoded, usually with a leading space
+    size_t      begin = 0;   // samples
+    size_t      end   = 0;
+};
+
+class LocalAgreement {
+public:
+    // Feeds one pass's hypothesis (in order, absolute times).  Words that
+    // end before the committed audio are ignored, as is a repeat of the
+    // last few committed words at its start.  Returns how many words were
+    // newly committed.
+    size_t insert(std::vector<TimedWord> words);
+
+    // Text committed so far, words joined as decoded (no leading space).
+    const std::string& committedText() const { return m_text; }
+    // The previous pass's words after the committed prefix.
+    std::string tentativeText() const;
+    // Recording index where the committed audio ends; 0 if none.
+    size_t committedEnd() const { return m_committed.empty() ? 0 : m_committed.back().end; }
+    size_t committedWords() const { return m_committed.size(); }
+
+    // Last `maxChars` (at a word boundary) of the committed text, to
+    // prompt the next pass with.
+    std::string prompt(size_t maxChars = 200) const;
+
+    void reset();
+
+private:
+    std::vector<TimedWord> m_committed;
+    std::vector<TimedWord> m_previous;   // uncommitted tail of the last pass
+    std::string            m_text;
+};
@@ -0,0 +1,172 @@
+// log_mel.cpp — incremental Whisper log-mel spectrogram.
+#include "log_mel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+static constexpr size_t kBins  = LogMelSpectrogram::kFft / 2 + 1;
+static constexpr float  kFloor = -10.0f;   // log10(1e-10), whisper.cpp's power floor
+// whisper.cpp pads every clip with 30 s of zeros before framing it.
+static constexpr size_t kTrailingPad = 16000 * 30;
+
+// Slaney mel scale: linear below 1 kHz, logarithmic above.
+static double hzToMel(double f)
+{
+    const double logStep = std::log(6.4) / 27.0;
+    return f < 1000.0 ? f * 3.0 / 200.0 : 15.0 + std::log(f / 1000.0) / logStep;
+}
+
+static double melToHz(double m)
+{
+    const double logStep = std::log(6.4) / 27.0;
+    return m < 15.0 ? m * 200.0 / 3.0 : 1000.0 * std::exp((m - 15.0) * logStep);
+}
+
+std::vector<float> LogMelSpectrogram::filterbank(size_t nMel)
+{
+    // Triangles between nMel + 2 points evenly spaced in mel from 0 Hz to
+    // Nyquist, each scaled to unit area (librosa's norm="slaney").
+    std::vector<double> edges(nMel + 2);
+    const double top = hzToMel(8000.0);
+    for (size_t i = 0; i < edges.size(); ++i)
+        edges[i] = melToHz(top * static_cast<double>(i) / static_cast<double>(nMel + 1));
+
+    std::vector<float> w(nMel * kBins, 0.0f);
+    for (size_t b = 0; b < nMel; ++b) {
+        const double norm = 2.0 / (edges[b + 2] - edges[b]);
+        for (size_t k = 0; k < kBins; ++k) {
+            const double f     = 40.0 * static_cast<double>(k);   // 16000 / 400 Hz per bin
+            const double lower = (f - edges[b]) / (edges[b + 1] - edges[b]);
+            const double upper = (edges[b + 2] - f) / (edges[b + 2] - edges[b + 1]);
+            w[b * kBins + k] = static_cast<float>(std::max(0.0, std::min(lower, upper)) * norm);
+        }
+    }
+    return w;
+}
+
+LogMelSpectrogram::LogMelSpectrogram(size_t nMel)
+    : m_nMel(nMel), m_filters(filterbank(nMel)),
+      m_filterBegin(nMel, 0), m_filterLen(nMel, 0),
+      m_frame(kFft), m_re(kBins), m_im(kBins), m_power(kBins)
+{
+    // Each triangle covers a handful of bins; only those are multiplied.
+    for (size_t b = 0; b < nMel; ++b) {
+        const float* row = &m_filters[b * kBins];
+        size_t first = 0;
+        while (first < kBins && row[first] == 0.0f) ++first;
+        size_t last = kBins;
+        while (last > first && row[last - 1] == 0.0f) --last;
+        m_filterBegin[b] = first;
+        m_filterLen[b]   = last - first;
+    }
+    // Periodic Hann, as torch.hann_window / whisper.cpp.
+    for (size_t n = 0; n < kFft; ++n)
+        m_window[n] = 0.5f - 0.5f * static_cast<float>(std::cos(6.283185307179586 * static_cast<double>(n) / kFft));
+    m_head.reserve(kPad + 1);
+}
+
+void LogMelSpectrogram::push(const float* x, size_t n)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_finished || n == 0) return;
+    const auto t0 = std::chrono::steady_clock::now();
+
+    if (m_head.size() < kPad + 1)
+        m_head.insert(m_head.end(), x, x + std::min(n, kPad + 1 - m_head.size()));
+    m_audio.insert(m_audio.end(), x, x + n);
+    m_received += n;
+
+    // Frame f is centred on sample f * kHop; its window ends kPad later.
+    while (m_frames * kHop + kPad < m_received)
+        computeFrame(m_frames++);
+
+    // Samples before the next window are never read again (the reflected
+    // head is kept separately); give them back a second at a time.
+    const size_t next = m_frames * kHop;
+    const size_t keepFrom = next > kPad ? next - kPad : 0;
+    if (keepFrom >= m_offset + 16000) {
+        m_audio.erase(m_audio.begin(), m_audio.begin() + static_cast<std::ptrdiff_t>(keepFrom - m_offset));
+        m_offset = keepFrom;
+    }
+
+    m_computeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void LogMelSpectrogram::finish()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_finished) return;
+    const auto t0 = std::chrono::steady_clock::now();
+    // Windows that start before the end of the audio; zeros beyond it.
+    while (m_frames * kHop < m_received + kPad)
+        computeFrame(m_frames++);
+    m_finished = true;
+    m_computeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void LogMelSpectrogram::computeFrame(size_t frame)
+{
+    // Window [frame * kHop - kPad, + kFft) of the recording; negative
+    // indices reflect about sample 0, indices past the end read zero.
+    const std::ptrdiff_t start = static_cast<std::ptrdiff_t>(frame * kHop) - static_cast<std::ptrdiff_t>(kPad);
+    for (size_t j = 0; j < kFft; ++j) {
+        const std::ptrdiff_t i = start + static_cast<std::ptrdiff_t>(j);
+        float s = 0.0f;
+        if (i < 0) {
+            const size_t r = static_cast<size_t>(-i);
+            if (r < m_head.size()) s = m_head[r];
+        } else if (static_cast<size_t>(i) < m_received) {
+            s = m_audio[static_cast<size_t>(i) - m_offset];
+        }
+        m_frame[j] = s * m_window[j];
+    }
+
+    m_fft.forward(m_frame.data(), m_re.data(), m_im.data());
+    for (size_t k = 0; k < kBins; ++k)
+        m_power[k] = m_re[k] * m_re[k] + m_im[k] * m_im[k];
+
+    m_logMel.resize((frame + 1) * m_nMel);
+    float* out = &m_logMel[frame * m_nMel];
+    for (size_t b = 0; b < m_nMel; ++b) {
+        const float* w = &m_filters[b * kBins + m_filterBegin[b]];
+        const float* p = &m_power[m_filterBegin[b]];
+        float sum = 0.0f;
+        for (size_t k = 0; k < m_filterLen[b]; ++k) sum += w[k] * p[k];
+        out[b] = std::log10(std::max(sum, 1e-10f));
+    }
+}
+
+size_t LogMelSpectrogram::extract(size_t begin, size_t end, std::vector<float>& out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t first = begin / kHop;
+    if (end <= first * kHop) return 0;
+
+    // whisper.cpp's frame count for an n-sample clip, and how many of
+    // those frames see any of its audio; the rest are pure padding.
+    const size_t n       = end - first * kHop;
+    const size_t nLen    = (n + kTrailingPad) / kHop;
+    const size_t audible = std::min(nLen, (n + kPad + kHop - 1) / kHop);
+    if (first + audible > m_frames) return 0;
+
+    const float* src = &m_logMel[first * m_nMel];
+    float peak = kFloor;
+    for (size_t i = 0; i < audible * m_nMel; ++i) peak = std::max(peak, src[i]);
+    const float floor = peak - 8.0f;
+    const float silent = (std::max(kFloor, floor) + 4.0f) / 4.0f;
+
+    out.resize(nLen * m_nMel);
+    for (size_t b = 0; b < m_nMel; ++b) {
+        float* row = &out[b * nLen];
+        for (size_t i = 0; i < audible; ++i)
+            row[i] = (std::max(src[i * m_nMel + b], floor) + 4.0f) / 4.0f;
+        std::fill(row + audible, row + nLen, silent);
+    }
+    return nLen;
+}
+
+LogMelSpectrogram::Stats LogMelSpectrogram::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Stats{ m_frames, m_computeMs };
+}
@@ -0,0 +1,78 @@
+#pragma once
+// log_mel.h — Whisper's log-mel spectrogram, computed while recording.
+//
+// whisper_full() computes the spectrogram of the whole clip before the
+// encoder can start, i.e. after the hotkey is released.  This class does
+// the same STFT as whisper.cpp (400-point periodic Hann, 160-sample hop,
+// reflect padding at the start, power spectrum through the Slaney mel
+// filterbank, log10) frame by frame as the samples arrive, on the capture
+// consumer thread.  Only the final clamp to (max - 8) and the (x + 4) / 4
+// scaling depend on the whole clip; extract() applies them at handoff,
+// one pass over the frames, and lays the result out for
+// whisper_set_mel_with_state().
+//
+// The filterbank is rebuilt here (librosa's mel(sr=16000, n_fft=400)),
+// matching the one stored in the model files to float precision.
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include "fft.h"
+
+class LogMelSpectrogram {
+public:
+    static constexpr size_t kFft = 400;   // 25 ms window
+    static constexpr size_t kHop = 160;   // 10 ms; one encoder input frame
+    static constexpr size_t kPad = kFft / 2;
+
+    // nMel: 80, or 128 for large-v3 models (whisper_model_n_mels()).
+    explicit LogMelSpectrogram(size_t nMel = 80);
+
+    size_t melBands() const { return m_nMel; }
+
+    // Consumer thread, in recording order: samples just appended to the
+    // recording.  Every frame whose window is complete is computed now.
+    void push(const float* x, size_t n);
+
+    // The recording has ended: computes the last frames, whose windows run
+    // past the end and are zero-padded as whisper.cpp does.  push() after
+    // this is ignored.
+    void finish();
+
+    // Spectrogram of recording samples [begin, end), as whisper.cpp would
+    // compute it for that clip: mel-major, melBands() rows of the returned
+    // frame count each, including the 30 s of trailing silence it pads
+    // with.  begin is rounded down to the hop grid; frames at the edges see
+    // the neighbouring recording instead of the clip's padding.  Returns 0
+    // if a frame in the range has not been computed (finish() not called).
+    size_t extract(size_t begin, size_t end, std::vector<float>& out) const;
+
+    struct Stats {
+        size_t frames    = 0;     // computed so far
+        double computeMs = 0.0;   // time spent in push() and finish()
+    };
+    Stats stats() const;
+
+    // Row-major nMel x (kFft/2 + 1) filter weights, for checking.
+    static std::vector<float> filterbank(size_t nMel);
+
+private:
+    void computeFrame(size_t frame);   // m_mutex held
+
+    size_t                m_nMel;
+    std::vector<float>    m_filters;        // nMel x bins
+    std::vector<size_t>   m_filterBegin;    // first non-zero bin per band
+    std::vector<size_t>   m_filterLen;      // non-zero bins per band
+    float                 m_window[kFft];
+
+    mutable std::mutex    m_mutex;
+    RealFft               m_fft{kFft};
+    std::vector<float>    m_audio;          // samples from m_offset on
+    size_t                m_offset   = 0;   // recording index of m_audio[0]
+    size_t                m_received = 0;
+    bool                  m_finished = false;
+    std::vector<float>    m_head;           // first kPad + 1 samples, for the reflection
+    std::vector<float>    m_logMel;         // frame-major, nMel per frame, log10 power
+    size_t                m_frames   = 0;
+    double                m_computeMs = 0.0;
+    std::vector<float>    m_frame, m_re, m_im, m_power;   // scratch
+};
@@ -18,7 +18,9 @@
 #include <vector>
 #include <algorithm>
 #include <cctype>
+#include <cwctype>
 #include <cmath>
+#include <cstdio>
 
 #include "audio_manager.h"
 #include "transcriber.h"
@@ -28,6 +30,8 @@
 #include "dashboard.h"
 #include "snippet_engine.h"
 #include "config_manager.h"
+#include "recording_journal.h"
+#include "usage_predictor.h"
 #include "../Resource.h"   // IDI_IDLE_ICON, IDI_RECORDING_ICON
 
 #pragma comment(lib, "comctl32.lib")
@@ -40,13 +44,17 @@
 #define WM_SHOW_DASHBOARD      (WM_APP + 2)
 #define WM_START_TRANSCRIPTION (WM_APP + 3)
 #define WM_TRANSCRIPTION_DONE  (WM_APP + 4)
+#define WM_VAD_EVENT           (WM_APP + 5)   // wp = frame << 8 | VadEvent, lp = capture session
+#define WM_RECOVERY_DONE       (WM_APP + 6)   // transcript of a journal recovered at start-up
+#define WM_TRANSCRIPTION_PARTIAL (WM_APP + 7) // wp = committed length, lp = heap std::string*
 
 // Hotkey
 #define HOTKEY_ID_RECORD       1
 
 // WM_TIMER IDs
-#define TIMER_ID_KEYCHECK      2   // 30 ms poll for Alt key release + VAD during recording
-#define TIMER_ID_IDLECHECK     3   // 30 s idle check for model unload
+#define TIMER_ID_KEYCHECK      2   // 30 ms poll for Alt key release during recording
+#define TIMER_ID_IDLECHECK     3   // 10 s idle check for state / model unload
+static constexpr UINT kIdleCheckMs = 10000;
 
 // ------------------------------------------------------------------
 // Globals
@@ -63,9 +71,42 @@ static Overlay       g_overlay;
 static Dashboard     g_dashboard;
 static SnippetEngine g_snippets;
 static ConfigManager g_config;
-
-// The audio callback writes RMS here; overlay.cpp reads it.
-// Defined here, extern-declared in audio_manager.cpp.
+// Crash-safe journals, open only with "recording_journal": true.  A new
+// dictation can start while earlier ones are still queued for Whisper, so
+// each recording gets a file of its own, kept until its job completes.
+// One for the live recording plus two waiting: a recording beyond that is
+// simply not journaled.
+static constexpr size_t kJournalFiles = 3;
+static RecordingJournal g_journals[kJournalFiles];
+// Journal capacity: the 15 s ring plus the 5 min spill cap in audio_manager.cpp.
+static constexpr size_t kJournalSec = 315;
+// Per journal: the transcription job whose recording it holds (0 = free,
+// kJournalLive = the recording in progress).  Only that job's completion
+// may wipe it.
+static constexpr uint64_t kJournalLive = UINT64_MAX;
+static uint64_t g_journalJobs[kJournalFiles] = {};
+static int      g_liveJournalIndex = -1;
+// Where the consumer thread mirrors the recording in progress; set while
+// the consumer stage is parked (before startCapture).
+static std::atomic<RecordingJournal*> g_liveJournal{nullptr};
+
+// "streaming_transcription": decode while the hotkey is held.
+static bool g_streaming = false;
+
+// "predictive_warmup": learn when dictation is likely (usage.json) and
+// load, prefetch or evict the model ahead of it.
+static bool           g_predictive = false;
+static UsagePredictor g_usage;
+static uint32_t       g_usageTicks = 0;   // idle checks since usage.json was saved
+// Idle timeouts while the predictor says a dictation is unlikely.
+static constexpr uint64_t kEvictStateMs = 5000;
+static constexpr uint64_t kEvictModelMs = 30000;
+
+// Transcriber streams: completions are ordered within each.
+static constexpr uint32_t kDictationStream = 0;
+static constexpr uint32_t kRecoveryStream  = 1;
+
+// The audio level callback writes RMS here; overlay.cpp reads it.
 Overlay* g_overlayPtr = nullptr;
 
 // State machine
@@ -73,11 +114,10 @@ enum class AppState { IDLE, RECORDING, TRANSCRIBING, INJECTING };
 static std::atomic<AppState> g_state{AppState::IDLE};
 static std::atomic<bool>     g_recordingActive{false};
 static bool                  g_hotkeyDown   = false;
+static bool                  g_drainPending = false;  // stopped, WM_START_TRANSCRIPTION not yet run
 static bool                  g_altHotkeyFallback = false; // true = using Alt+Shift+V
 static std::atomic<uint64_t> g_idleUnloadMs{120000};  // 120 s default — keep model warm
-static float                 g_vadNoiseFloor = 0.004f;
-static int                   g_vadSilentFrames = 0;
-static int                   g_vadSpeechFrames = 0;
+static std::atomic<uint64_t> g_stateUnloadMs{30000};  // worker states go first
 
 struct RecentTranscript {
     std::string normalized;
@@ -87,6 +127,13 @@ static RecentTranscript g_recentTranscript;
 
 // Timing: used to measure transcription latency for the history entry
 static std::chrono::steady_clock::time_point g_recordStart;
+// Hotkey release (or VAD stop): release-to-text is what streaming shortens.
+static std::chrono::steady_clock::time_point g_recordStop;
+
+// Results that arrived while the next dictation was being recorded (the
+// hotkey is held, so typing now would go out as Alt+key).  Re-posted, in
+// order, as soon as that recording stops.
+static std::vector<std::pair<WPARAM, LPARAM>> g_heldResults;
 
 static bool FileExistsWPath(const std::wstring& path)
 {
@@ -114,6 +161,72 @@ static uint64_t ClampIdleUnloadMs(int sec)
     return static_cast<uint64_t>(sec) * 1000ULL;
 }
 
+static int LocalMinuteOfDay()
+{
+    SYSTEMTIME st; GetLocalTime(&st);
+    return st.wHour * 60 + st.wMinute;
+}
+
+// Lower-case exe file name of the focused window's process, UTF-8.
+static std::string ActiveAppName()
+{
+    std::wstring path = ActiveWindowExePath();
+    const size_t slash = path.find_last_of(L"\\/");
+    if (slash != std::wstring::npos) path.erase(0, slash + 1);
+    std::transform(path.begin(), path.end(), path.begin(),
+                   [](wchar_t c) { return static_cast<wchar_t>(towlower(c)); });
+    return WideToUtf8(path);
+}
+
+static void LogWarmupScore(const char* outcome)
+{
+    const UsagePredictor::Stats& s = g_usage.stats();
+    char debugBuf[192];
+    snprintf(debugBuf, sizeof(debugBuf),
+        "FLOW-ON: predictive warm-up %s; %u hits, %u misses (%.0f%% hit rate); %u of %u dictations cold\n",
+        outcome, s.hits, s.misses, 100.0 * s.hitRate(), s.coldStarts, s.uses);
+    OutputDebugStringA(debugBuf);
+}
+
+// Idle check with "predictive_warmup": learns from this tick and acts on
+// the advice for the next few minutes.  Preload loads the model now (and
+// the caller keeps it); Prefetch reads the file into the page cache.
+static UsagePredictor::Advice PredictUse()
+{
+    const int minute = LocalMinuteOfDay();
+    const std::string app = ActiveAppName();
+    const uint64_t now = GetTickCount64();
+    g_usage.observe(minute, app, kIdleCheckMs / 60000.0);
+    if (g_usage.expire(now)) LogWarmupScore("miss");
+
+    const UsagePredictor::Advice advice = g_usage.advise(minute, app);
+    if (advice == UsagePredictor::Advice::Preload && !g_transcriber.modelLoaded()
+        && g_state.load(std::memory_order_acquire) == AppState::IDLE) {
+        g_transcriber.prewarm();
+        g_usage.warmedUp(now);
+        char debugBuf[160];
+        snprintf(debugBuf, sizeof(debugBuf),
+            "FLOW-ON: preloading the model: P(dictation within %.0f min) = %.2f in %s\n",
+            UsagePredictor::kHorizonMin, g_usage.likelihood(minute, app), app.c_str());
+        OutputDebugStringA(debugBuf);
+    } else if (advice == UsagePredictor::Advice::Prefetch) {
+        g_transcriber.prefetchModelFile();
+    }
+
+    if (++g_usageTicks >= 3600000 / kIdleCheckMs) {   // hourly
+        g_usage.save(g_config.usagePath());
+        g_usageTicks = 0;
+    }
+    return advice;
+}
+
+static uint64_t ClampStateUnloadMs(int sec)
+{
+    if (sec < 5) sec = 5;
+    if (sec > 600) sec = 600;
+    return static_cast<uint64_t>(sec) * 1000ULL;
+}
+
 static std::string NormalizeForDedup(const std::string& text)
 {
     std::string out;
@@ -182,6 +295,8 @@ static void ShowTrayMenu(HWND hwnd)
 {
     HMENU menu = CreatePopupMenu();
     AppendMenuW(menu, MF_STRING,    1001, L"Dashboard");
+    if (g_transcriber.isBusy())
+        AppendMenuW(menu, MF_STRING, 1003, L"Cancel transcription");
     AppendMenuW(menu, MF_SEPARATOR, 0,    nullptr);
     AppendMenuW(menu, MF_STRING,    1002, L"Exit");
 
@@ -193,12 +308,114 @@ static void ShowTrayMenu(HWND hwnd)
     DestroyMenu(menu);
 
     if (cmd == 1001) PostMessageW(hwnd, WM_SHOW_DASHBOARD, 0, 0);
+    if (cmd == 1003) {
+        // Queued jobs complete at once, the running one within a few ms;
+        // each still posts its (empty) result, in order.
+        const size_t n = g_transcriber.cancelAll();
+        OutputDebugStringA(("FLOW-ON: cancelled " + std::to_string(n) + " transcription job(s)\n").c_str());
+    }
     if (cmd == 1002) {
         Shell_NotifyIconW(NIM_DELETE, &g_nid);
         PostQuitMessage(0);
     }
 }
 
+// ------------------------------------------------------------------
+// Dashboard history entry for a finished transcription
+// ------------------------------------------------------------------
+static void AddHistoryEntry(const std::string& formatted, int latMs, bool wasCoded)
+{
+    TranscriptionEntry entry;
+    entry.text      = formatted;
+    entry.latencyMs = latMs;
+    entry.wasCoded  = wasCoded;
+    {
+        // Build timestamp "HH:MM"
+        SYSTEMTIME st; GetLocalTime(&st);
+        wchar_t ts[8];
+        swprintf_s(ts, L"%02d:%02d", st.wHour, st.wMinute);
+        entry.timestamp = std::string(ts, ts + 5);
+    }
+    // Count words
+    entry.wordCount = 0;
+    bool inWord = false;
+    for (char c : formatted) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            if (inWord) entry.wordCount++;
+            inWord = false;
+        } else {
+            inWord = true;
+        }
+    }
+    if (inWord) entry.wordCount++;
+    g_dashboard.addEntry(entry);
+}
+
+// ------------------------------------------------------------------
+// Journals.  UI thread only, apart from the consumer thread's append
+// through g_liveJournal.
+// ------------------------------------------------------------------
+
+// Hotkey: mirror the new recording into a free journal, if there is one.
+static void BeginJournal()
+{
+    g_liveJournal.store(nullptr, std::memory_order_release);
+    g_liveJournalIndex = -1;
+    for (size_t i = 0; i < kJournalFiles; ++i) {
+        if (!g_journals[i].isOpen() || g_journalJobs[i] != 0) continue;
+        g_journals[i].begin();
+        g_journalJobs[i]   = kJournalLive;
+        g_liveJournalIndex = static_cast<int>(i);
+        g_liveJournal.store(&g_journals[i], std::memory_order_release);
+        return;
+    }
+    if (g_journals[0].isOpen())
+        OutputDebugStringA("FLOW-ON: every journal holds a pending dictation; this one is not journaled\n");
+}
+
+// The stopped recording was queued as `jobId` (0: discarded, or nothing
+// could take it): the journal now waits for that job, or is wiped.
+static void HandOffJournal(uint64_t jobId)
+{
+    g_liveJournal.store(nullptr, std::memory_order_release);
+    if (g_liveJournalIndex < 0) return;
+    const size_t i = static_cast<size_t>(g_liveJournalIndex);
+    g_liveJournalIndex = -1;
+    if (jobId == 0) {
+        g_journals[i].finish();
+        g_journalJobs[i] = 0;
+    } else {
+        g_journalJobs[i] = jobId;
+    }
+}
+
+// Whisper is done with job `jobId`; its on-disk copy can go.
+static void FinishJournal(uint64_t jobId)
+{
+    for (size_t i = 0; i < kJournalFiles; ++i) {
+        if (g_journalJobs[i] != jobId) continue;
+        g_journals[i].finish();
+        g_journalJobs[i] = 0;
+    }
+}
+
+// ------------------------------------------------------------------
+// After a job completes or is discarded: back to idle, unless the next
+// recording is already running (it owns the UI) or more jobs are queued.
+// ------------------------------------------------------------------
+static void SettleAfterJob(OverlayState overlay, const wchar_t* idleTip)
+{
+    if (g_recordingActive.load(std::memory_order_acquire)) return;
+    if (g_transcriber.isBusy()) {
+        g_state.store(AppState::TRANSCRIBING, std::memory_order_release);
+        SetTrayIcon(IDI_IDLE_ICON, L"FLOW-ON! \u2014 Processing\u2026");
+        return;
+    }
+    g_overlay.setState(overlay);
+    g_state.store(AppState::IDLE, std::memory_order_release);
+    SetTrayIcon(IDI_IDLE_ICON, idleTip);
+}
+
 // ------------------------------------------------------------------
 // StopRecordingOnce — atomic CAS ensures only ONE path (hotkey release
 // OR VAD silence) wins and triggers the transcription.
@@ -209,10 +426,15 @@ static void StopRecordingOnce(HWND hwnd)
     if (g_recordingActive.compare_exchange_strong(expected, false,
             std::memory_order_acq_rel, std::memory_order_acquire)) {
         g_audio.stopCapture();
+        g_recordStop = std::chrono::steady_clock::now();
+        g_drainPending = true;   // the next recording waits for the drain
         g_state.store(AppState::TRANSCRIBING, std::memory_order_release);
         g_overlay.setState(OverlayState::Processing);
         SetTrayIcon(IDI_IDLE_ICON, L"FLOW-ON! \u2014 Processing\u2026");
         PostMessageW(hwnd, WM_START_TRANSCRIPTION, 0, 0);
+        for (const auto& [wp, lp] : g_heldResults)
+            PostMessageW(hwnd, WM_TRANSCRIPTION_DONE, wp, lp);
+        g_heldResults.clear();
         KillTimer(hwnd, TIMER_ID_KEYCHECK);
     }
 }
@@ -253,6 +475,24 @@ static std::string ResolveModelPath(const std::string& configuredModel)
     return "";
 }
 
+// ------------------------------------------------------------------
+// Optional whisper VAD model: "silero-v5.1.2" -> models\ggml-silero-v5.1.2.bin.
+// Empty string (the default) or a missing file disables neural gating.
+// ------------------------------------------------------------------
+static std::string ResolveVadModelPath(const std::string& configuredVad)
+{
+    if (configuredVad.empty()) return "";
+
+    wchar_t exeDir[MAX_PATH] = {};
+    GetModuleFileNameW(nullptr, exeDir, MAX_PATH);
+    wchar_t* lastSlash = wcsrchr(exeDir, L'\\');
+    if (lastSlash) *(lastSlash + 1) = L'\0';
+
+    const std::wstring name(configuredVad.begin(), configuredVad.end());
+    const std::wstring full = std::wstring(exeDir) + L"models\\ggml-" + name + L".bin";
+    return FileExistsWPath(full) ? WideToUtf8(full) : "";
+}
+
 // ------------------------------------------------------------------
 // WindowProc
 // ------------------------------------------------------------------
@@ -290,12 +530,17 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
     }
 
     // ----------------------------------------------------------
-    // Hotkey press → start recording
+    // Hotkey press → start recording.  Earlier dictations may still be
+    // queued for Whisper; this one simply joins the queue behind them.
+    // A stopped recording whose WM_START_TRANSCRIPTION has not run yet
+    // still owns the capture buffer and the streaming pass, so a press in
+    // that window is ignored rather than discarding it.
     // ----------------------------------------------------------
     case WM_HOTKEY:
         if (wp == HOTKEY_ID_RECORD
             && !g_hotkeyDown
-            && g_state.load(std::memory_order_acquire) == AppState::IDLE)
+            && !g_drainPending
+            && !g_recordingActive.load(std::memory_order_acquire))
         {
             g_hotkeyDown = true;
             g_recordingActive.store(true, std::memory_order_release);
@@ -304,11 +549,27 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
 
             g_overlay.setState(OverlayState::Recording);
             SetTrayIcon(IDI_RECORDING_ICON, L"FLOW-ON! \u2014 Recording\u2026");
+            BeginJournal();
+            if (g_predictive
+                && g_usage.recordUse(LocalMinuteOfDay(), ActiveAppName(), GetTickCount64(),
+                                     g_transcriber.modelLoaded()))
+                LogWarmupScore("hit");
+            // Reload anything an idle unload freed while the user speaks.
+            g_transcriber.prewarm();
+            if (g_streaming) {
+                // Partial text: committed prefix + tentative tail in one
+                // string; wParam says where the committed part ends.
+                g_transcriber.beginRecording([hwnd](const std::string& committed, const std::string& tentative) {
+                    auto* s = new std::string(committed);
+                    if (!tentative.empty()) *s += (s->empty() ? "" : " ") + tentative;
+                    if (!PostMessageW(hwnd, WM_TRANSCRIPTION_PARTIAL, committed.size(), reinterpret_cast<LPARAM>(s)))
+                        delete s;
+                });
+            } else {
+                g_transcriber.beginRecording();   // log-mel while recording
+            }
             g_audio.startCapture();
 
-            g_vadSilentFrames = 0;
-            g_vadSpeechFrames = 0;
-
             SetTimer(hwnd, TIMER_ID_KEYCHECK, 30, nullptr);  // 30 ms poll
         }
         return 0;
@@ -329,43 +590,19 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
                 g_hotkeyDown = false;
                 StopRecordingOnce(hwnd);
             }
-            // Adaptive VAD: estimate local noise floor and only auto-stop
-            // once real speech has occurred and then tailed off.
-            else {
-                const float rms = g_audio.getRMS();
-
-                g_vadNoiseFloor = std::max(0.0015f, g_vadNoiseFloor * 0.98f + rms * 0.02f);
-
-                const float speechThreshold  = std::max(0.0065f, g_vadNoiseFloor * 2.4f);
-                const float silenceThreshold = std::max(0.0045f, g_vadNoiseFloor * 1.5f);
-
-                if (rms >= speechThreshold) {
-                    g_vadSpeechFrames++;
-                    g_vadSilentFrames = 0;
-                } else {
-                    if (g_vadSpeechFrames >= 4 && rms <= silenceThreshold) {
-                        g_vadSilentFrames++;
-                    } else if (g_vadSpeechFrames == 0) {
-                        // Before first speech frame, keep adapting quickly to ambient noise.
-                        g_vadNoiseFloor = std::max(0.0015f, g_vadNoiseFloor * 0.9f + rms * 0.1f);
-                    }
-                }
-
-                // 1500ms / 30ms per poll = ~50 consecutive silent polls.
-                if (g_vadSpeechFrames >= 4 && g_vadSilentFrames > 50) {
-                    g_vadSilentFrames = 0;
-                    g_vadSpeechFrames = 0;
-                    g_hotkeyDown = false;
-                    StopRecordingOnce(hwnd);
-                }
-            }
         }
         if (wp == TIMER_ID_IDLECHECK) {
+            const UsagePredictor::Advice advice = g_predictive ? PredictUse() : UsagePredictor::Advice::Normal;
             if (g_state.load(std::memory_order_acquire) == AppState::IDLE
-                && !g_transcriber.isBusy()) {
-                g_transcriber.unloadIfIdle(
-                    GetTickCount64(),
-                    g_idleUnloadMs.load(std::memory_order_acquire));
+                && !g_transcriber.isBusy()
+                && advice != UsagePredictor::Advice::Preload) {   // keep it for the expected dictation
+                uint64_t modelMs = g_idleUnloadMs.load(std::memory_order_acquire);
+                uint64_t stateMs = std::min(g_stateUnloadMs.load(std::memory_order_acquire), modelMs);
+                if (advice == UsagePredictor::Advice::Evict) {
+                    modelMs = std::min(modelMs, kEvictModelMs);
+                    stateMs = std::min(stateMs, kEvictStateMs);
+                }
+                g_transcriber.unloadIfIdle(GetTickCount64(), stateMs, modelMs);
             }
         }
         return 0;
@@ -387,49 +624,104 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
         g_dashboard.show();
         return 0;
 
+    // ----------------------------------------------------------
+    // VAD event from the audio consumer stage.  Auto-stop once real
+    // speech has occurred and then tailed off for 1.5 s.
+    // ----------------------------------------------------------
+    case WM_VAD_EVENT: {
+        const auto   ev    = static_cast<VadEvent>(wp & 0xFF);
+        const size_t frame = static_cast<size_t>(wp >> 8);
+        if (static_cast<uint32_t>(lp) != g_audio.session()) return 0;   // stale
+
+        char dbg[96];
+        snprintf(dbg, sizeof(dbg), "[FLOW-ON] VAD %s at %zu ms\n",
+                 ev == VadEvent::SpeechStart ? "speech start" : "speech end",
+                 frame * 10);
+        OutputDebugStringA(dbg);
+
+        if (ev == VadEvent::SpeechEnd && g_hotkeyDown) {
+            g_hotkeyDown = false;
+            StopRecordingOnce(hwnd);
+        }
+        return 0;
+    }
+
     // ----------------------------------------------------------
     // Drain audio and hand off to Whisper
     // ----------------------------------------------------------
     case WM_START_TRANSCRIPTION: {
-        std::vector<float> pcm = g_audio.drainBuffer();
+        PcmChain pcm = g_audio.drainBuffer();
+        g_drainPending = false;
 
+        {
+            // Hotkey-to-first-sample latency, cold start vs armed pre-roll.
+            char debugBuf[160];
+            snprintf(debugBuf, sizeof(debugBuf),
+                "FLOW-ON: capture start (%s): first sample after %.1f ms, %zu ms pre-roll stitched\n",
+                g_audio.isArmed() ? "armed" : "cold", g_audio.getStartLatencyMs(),
+                g_audio.getPrerollMs());
+            OutputDebugStringA(debugBuf);
+        }
+
+        if (g_audio.captureChannels() > 1) {
+            // Which microphone(s) this utterance came from, and why.
+            char debugBuf[256];
+            int len = snprintf(debugBuf, sizeof(debugBuf), "FLOW-ON: %u-channel capture, %u input switches;",
+                               g_audio.captureChannels(), g_audio.getRouteChanges());
+            const std::vector<AudioManager::ChannelInfo> channels = g_audio.getChannelInfo();
+            for (size_t c = 0; c < channels.size() && len > 0 && len < static_cast<int>(sizeof(debugBuf)) - 32; ++c)
+                len += snprintf(debugBuf + len, sizeof(debugBuf) - len, " ch%zu %.1f dB x%.2f",
+                                c, channels[c].snrDb, channels[c].weight);
+            OutputDebugStringA(debugBuf);
+            OutputDebugStringA("\n");
+        }
+
+        // Capture never drops below the spill cap; past it, report each gap
+        // but still transcribe what was kept.
         const int dropped = g_audio.getDroppedSamples();
         g_audio.resetDropCounter();
+        if (dropped > 0) {
+            for (const CaptureGap& gap : g_audio.getCaptureGaps()) {
+                char debugBuf[128];
+                snprintf(debugBuf, sizeof(debugBuf),
+                    "FLOW-ON: capture cap reached, %zu frames lost at %.2f s\n",
+                    gap.dropped, static_cast<double>(gap.atSample) / g_audio.captureRate());
+                OutputDebugStringA(debugBuf);
+            }
+        }
 
-        // Gate on a meaningful recording length (>0.15 s) and low drop rate
+        // Gate on a meaningful recording length (>0.15 s)
         const bool tooShort  = pcm.size() < 2400;   // 0.15 s at 16 kHz
-        const bool tooDroppy = dropped > 160;   // >10 ms gap = noticeable corruption
 
-        size_t voicedSamples = 0;
-        const float voicedThreshold = std::max(0.0065f, g_vadNoiseFloor * 2.0f);
-        for (float s : pcm) {
-            if (std::fabs(s) >= voicedThreshold) {
-                ++voicedSamples;
-            }
-        }
-        const bool mostlySilence = pcm.empty() ||
-            (static_cast<double>(voicedSamples) / static_cast<double>(pcm.size()) < 0.015);
+        // Voiced frames and the loud range were accumulated per 10 ms frame
+        // by the audio consumer stage while recording — no rescan here.
+        const FeatureSummary features = g_audio.getFeatureSummary();
+        const bool mostlySilence = features.frames == 0 ||
+            (static_cast<double>(features.voicedFrames) / static_cast<double>(features.frames) < 0.015);
 
-        if (tooShort || tooDroppy || mostlySilence) {
+        if (tooShort || mostlySilence) {
             wchar_t tip[128];
             if (tooShort)
                 wcscpy_s(tip, L"FLOW-ON! \u2014 Too short, try again");
-            else if (mostlySilence)
-                wcscpy_s(tip, L"FLOW-ON! \u2014 No clear speech detected");
             else
-                swprintf_s(tip, L"FLOW-ON! \u2014 Audio capture error (%d drops)", dropped);
-            g_overlay.setState(OverlayState::Error);
-            g_state.store(AppState::IDLE, std::memory_order_release);
-            SetTrayIcon(IDI_IDLE_ICON, tip);
+                wcscpy_s(tip, L"FLOW-ON! \u2014 No clear speech detected");
+            HandOffJournal(0);
+            g_transcriber.abortRecording();
+            SettleAfterJob(OverlayState::Error, tip);
             break;
         }
 
-        // Single-flight guard in transcribeAsync prevents re-entry
-        if (!g_transcriber.transcribeAsync(hwnd, std::move(pcm), WM_TRANSCRIPTION_DONE)) {
-            // Whisper was still busy — silently drop and reset
-            g_overlay.setState(OverlayState::Error);
-            g_state.store(AppState::IDLE, std::memory_order_release);
-            SetTrayIcon(IDI_IDLE_ICON, L"FLOW-ON! \u2014 Busy, try again");
+        // Queued behind any earlier dictation; results come back in order.
+        // When streaming, the job only decodes what the stream has not yet
+        // committed.
+        size_t loudBegin = 0, loudEnd = 0;
+        g_audio.getLoudRange(loudBegin, loudEnd);
+        const uint64_t jobId = g_transcriber.transcribeAsync(hwnd, std::move(pcm), WM_TRANSCRIPTION_DONE,
+                                                             loudBegin, loudEnd, JobPriority::Interactive,
+                                                             kDictationStream);
+        HandOffJournal(jobId);
+        if (jobId == 0) {
+            SettleAfterJob(OverlayState::Error, L"FLOW-ON! \u2014 No Whisper model available");
         }
         break;
     }
@@ -438,12 +730,44 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
     // Transcription complete — format, expand snippets, inject
     // Use a static to prevent duplicate processing of the same message
     // ----------------------------------------------------------
+    case WM_TRANSCRIPTION_PARTIAL: {
+        auto* textPtr = reinterpret_cast<std::string*>(lp);
+        const std::string text = textPtr ? *textPtr : "";
+        delete textPtr;
+        // A late pass for a recording that has already stopped adds nothing.
+        if (!g_recordingActive.load(std::memory_order_acquire)) break;
+
+        const size_t committed = std::min<size_t>(wp, text.size());
+        OutputDebugStringA(("FLOW-ON PARTIAL: [" + text.substr(0, committed) + "]"
+                            + text.substr(committed) + "\n").c_str());
+
+        // The tray tooltip shows the end of what has been heard so far.
+        const std::string shown = text.size() > 90 ? "..." + text.substr(text.size() - 90) : text;
+        std::wstring tip = L"FLOW-ON! \u2014 ";
+        const int wlen = MultiByteToWideChar(CP_UTF8, 0, shown.c_str(), -1, nullptr, 0);
+        if (wlen > 1) {
+            std::wstring wide(wlen - 1, L'\0');
+            MultiByteToWideChar(CP_UTF8, 0, shown.c_str(), -1, wide.data(), wlen);
+            tip += wide;
+        }
+        SetTrayIcon(IDI_RECORDING_ICON, tip.c_str());
+        break;
+    }
+
     case WM_TRANSCRIPTION_DONE: {
+        if (g_recordingActive.load(std::memory_order_acquire)) {
+            g_heldResults.emplace_back(wp, lp);
+            break;
+        }
+
         const uint64_t tickNow = GetTickCount64();
         auto* rawPtr = reinterpret_cast<std::string*>(lp);
         std::string raw = rawPtr ? *rawPtr : "";
         delete rawPtr;
 
+        // Whisper is done with the recording; the on-disk copy can go.
+        FinishJournal(static_cast<uint64_t>(wp));
+
         OutputDebugStringA(("FLOW-ON RAW: " + raw + "\n").c_str());
 
         // Detect active window mode (code editor vs prose)
@@ -462,9 +786,7 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
 
         if (duplicateRecent) {
             OutputDebugStringA("FLOW-ON: Suppressed duplicate transcription chunk\n");
-            g_overlay.setState(OverlayState::Done);
-            g_state.store(AppState::IDLE, std::memory_order_release);
-            SetTrayIcon(IDI_IDLE_ICON, L"FLOW-ON! \u2014 Idle (Alt+V to record)");
+            SettleAfterJob(OverlayState::Done, L"FLOW-ON! \u2014 Idle (Alt+V to record)");
             break;
         }
 
@@ -491,39 +813,41 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
             g_recentTranscript.tick = tickNow;
         }
 
-        g_overlay.setState(OverlayState::Done);
-        g_state.store(AppState::IDLE, std::memory_order_release);
-        SetTrayIcon(IDI_IDLE_ICON, L"FLOW-ON! \u2014 Idle (Alt+V to record)");
+        SettleAfterJob(OverlayState::Done, L"FLOW-ON! \u2014 Idle (Alt+V to record)");
 
         // Record in dashboard history
-        if (!formatted.empty()) {
-            TranscriptionEntry entry;
-            entry.text      = formatted;
-            entry.latencyMs = latMs;
-            entry.wasCoded  = (mode == AppMode::CODING);
-            {
-                // Build timestamp "HH:MM"
-                SYSTEMTIME st; GetLocalTime(&st);
-                wchar_t ts[8];
-                swprintf_s(ts, L"%02d:%02d", st.wHour, st.wMinute);
-                entry.timestamp = std::string(ts, ts + 5);
-            }
-            // Count words
-            entry.wordCount = 0;
-            bool inWord = false;
-            for (char c : formatted) {
-                if (std::isspace(static_cast<unsigned char>(c))) {
-                    if (inWord) entry.wordCount++;
-                    inWord = false;
-                } else {
-                    inWord = true;
-                }
-            }
-            if (inWord) entry.wordCount++;
-            g_dashboard.addEntry(entry);
-        }
+        if (!formatted.empty())
+            AddHistoryEntry(formatted, latMs, mode == AppMode::CODING);
+
+        const int releaseMs = static_cast<int>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - g_recordStop).count());
+        OutputDebugStringA(("FLOW-ON LATENCY: " + std::to_string(latMs) + " ms, "
+                            + std::to_string(releaseMs) + " ms after release ("
+                            + (g_streaming ? "streaming" : "batch") + ")\n").c_str());
+        break;
+    }
 
-        OutputDebugStringA(("FLOW-ON LATENCY: " + std::to_string(latMs) + " ms\n").c_str());
+    // ----------------------------------------------------------
+    // A dictation recovered from the journal has been transcribed.
+    // The user has long since moved on, so it goes to the history
+    // rather than being typed into whatever window has focus.
+    // ----------------------------------------------------------
+    case WM_RECOVERY_DONE: {
+        auto* rawPtr = reinterpret_cast<std::string*>(lp);
+        std::string raw = rawPtr ? *rawPtr : "";
+        delete rawPtr;
+
+        FinishJournal(static_cast<uint64_t>(wp));
+
+        const AppMode mode = g_config.settings().modeStr == "code" ? AppMode::CODING : AppMode::PROSE;
+        const std::string formatted = g_snippets.apply(FormatTranscription(raw, mode));
+        OutputDebugStringA(("FLOW-ON RECOVERED: " + formatted + "\n").c_str());
+        if (!formatted.empty())
+            AddHistoryEntry(formatted, 0, mode == AppMode::CODING);
+
+        SettleAfterJob(OverlayState::Done, formatted.empty()
+            ? L"FLOW-ON! \u2014 Idle (Alt+V to record)"
+            : L"FLOW-ON! \u2014 Recovered dictation is in the history");
         break;
     }
 
@@ -597,6 +921,8 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int)
     g_snippets.setSnippets(g_config.settings().snippets);
     g_idleUnloadMs.store(ClampIdleUnloadMs(g_config.settings().idleUnloadSec),
                          std::memory_order_release);
+    g_stateUnloadMs.store(ClampStateUnloadMs(g_config.settings().stateUnloadSec),
+                          std::memory_order_release);
     if (g_config.settings().startWithWindows) {
         wchar_t exeFull[MAX_PATH] = {};
         GetModuleFileNameW(nullptr, exeFull, MAX_PATH);
@@ -622,7 +948,51 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int)
     // ----------------------------------------------------------
     // Audio manager (Phase 2)
     // ----------------------------------------------------------
-    if (!g_audio.init(nullptr)) {
+    g_audio.setVadCallback([](VadEvent ev, size_t frame, uint32_t session) {
+        PostMessageW(g_hwnd, WM_VAD_EVENT,
+                     static_cast<WPARAM>(frame) << 8 | static_cast<WPARAM>(ev),
+                     static_cast<LPARAM>(session));
+    });
+    g_audio.setLevelCallback([](float rms) {
+        // pushRMS is a single atomic store — safe from the consumer thread.
+        if (g_overlayPtr) g_overlayPtr->pushRMS(rms);
+    });
+    g_audio.setPrerollMs(static_cast<size_t>(g_config.settings().prerollMs));
+    g_audio.setNoiseSuppression(g_config.settings().noiseSuppression);
+    g_audio.setConditioning(g_config.settings().inputConditioning);
+    g_audio.setCompactPcm(g_config.settings().compactPcm);
+    g_audio.setCaptureChannels(static_cast<uint32_t>(g_config.settings().captureChannels));
+    g_audio.setChannelMode(g_config.settings().channelMix == "blend" ? ChannelMixer::Mode::Blend
+                                                                      : ChannelMixer::Mode::Select);
+    // Crash-safe journals: pick up whatever an earlier run left unfinished
+    // before the files are reused, then mirror every recording into one.
+    PcmChain recovered[kJournalFiles];
+    RecordingJournal::Recovered recoveredInfo[kJournalFiles];
+    if (g_config.settings().recordingJournal) {
+        for (size_t i = 0; i < kJournalFiles; ++i) {
+            const std::wstring journalPath = g_config.journalPath(i);
+            if (!RecordingJournal::recover(journalPath, recovered[i], recoveredInfo[i])
+                || recoveredInfo[i].sampleRate != AudioManager::kWhisperRate)
+                recovered[i].clear();
+            if (!g_journals[i].open(journalPath, AudioManager::kWhisperRate, kJournalSec))
+                OutputDebugStringA("FLOW-ON: recording journal unavailable\n");
+        }
+    }
+
+    // Usage history for the predictive warm-up (first run: learns from now).
+    g_predictive = g_config.settings().predictiveWarmup;
+    if (g_predictive) g_usage.load(g_config.usagePath());
+
+    // The sample callback runs on the consumer thread with each block of
+    // the finished recording; append() is a wait-free queue write, and
+    // recordingAppend() extends the log-mel spectrogram (one 400-point FFT
+    // per 10 ms) plus, when streaming, a copy and once a second a queued pass.
+    g_streaming = g_config.settings().streamingTranscription;
+    if (!g_audio.init([](const float* data, size_t n) {
+            if (RecordingJournal* journal = g_liveJournal.load(std::memory_order_acquire))
+                journal->append(data, n);
+            g_transcriber.recordingAppend(data, n);
+        })) {
         MessageBoxW(nullptr,
             L"Failed to open microphone.\n\n"
             L"Make sure a microphone is connected and privacy settings\n"
@@ -667,9 +1037,30 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int)
 
     // Keep baseline RAM low by loading the model only when transcription starts.
     g_transcriber.setModelPath(modelPath);
+    g_transcriber.setVadModelPath(ResolveVadModelPath(g_config.settings().vadModel));
     g_transcriber.setUseGPU(g_config.settings().useGPU);
-
-    SetTimer(g_hwnd, TIMER_ID_IDLECHECK, 30000, nullptr);
+    g_transcriber.setParallelJobs(g_config.settings().parallelTranscriptions);
+
+    SetTimer(g_hwnd, TIMER_ID_IDLECHECK, kIdleCheckMs, nullptr);
+
+    // Transcribe recovered dictations in the background, on their own
+    // stream so live dictation neither waits for them nor queues behind
+    // them.  Each journal stays as it is until its job completes.
+    for (size_t i = 0; i < kJournalFiles; ++i) {
+        if (recovered[i].empty()) continue;
+        char debugBuf[160];
+        snprintf(debugBuf, sizeof(debugBuf),
+            "FLOW-ON: recovered %.1f s unfinished recording from journal %zu%s%s\n",
+            static_cast<double>(recovered[i].size()) / AudioManager::kWhisperRate, i,
+            recoveredInfo[i].lossy ? ", with gaps" : "", recoveredInfo[i].truncated ? ", truncated" : "");
+        OutputDebugStringA(debugBuf);
+        g_journalJobs[i] = g_transcriber.transcribeAsync(g_hwnd, std::move(recovered[i]), WM_RECOVERY_DONE,
+                                                         0, 0, JobPriority::Background, kRecoveryStream);
+        if (g_journalJobs[i] != 0) {
+            g_state.store(AppState::TRANSCRIBING, std::memory_order_release);
+            SetTrayIcon(IDI_IDLE_ICON, L"FLOW-ON! \u2014 Recovering interrupted dictation\u2026");
+        }
+    }
 
     // ----------------------------------------------------------
     // Dashboard (Phase 8)
@@ -720,13 +1111,19 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int)
     g_audio.stopCapture();
     {
         auto buf = g_audio.drainBuffer();
-        SecureZeroMemory(buf.data(), buf.size() * sizeof(float));
+        for (size_t i = 0; i < buf.pageCount(); ++i)
+            SecureZeroMemory(buf.pageBytes(i).data(), buf.pageBytes(i).size_bytes());
+    }
+    for (RecordingJournal& journal : g_journals) {
+        journal.finish();
+        journal.close();
     }
     g_audio.shutdown();
     g_transcriber.shutdown();
     g_overlay.shutdown();
     g_dashboard.shutdown();
     g_config.save();
+    if (g_predictive) g_usage.save(g_config.usagePath());
 
     return static_cast<int>(msg.wParam);
 }
@@ -0,0 +1,158 @@
+// mapped_model.cpp — read-only model file mapping and its whisper loader.
+#include "mapped_model.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedModel::open(const std::filesystem::path& path)
+{
+    close();
+#ifdef _WIN32
+    HANDLE f = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(f, &size) || size.QuadPart <= 0) {
+        CloseHandle(f);
+        return false;
+    }
+    HANDLE m = CreateFileMappingW(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void*  v = m ? MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!v) {
+        if (m) CloseHandle(m);
+        CloseHandle(f);
+        return false;
+    }
+    m_file    = reinterpret_cast<std::uintptr_t>(f);
+    m_mapping = reinterpret_cast<std::uintptr_t>(m);
+    m_base    = v;
+    m_bytes   = static_cast<size_t>(size.QuadPart);
+
+    // Large reads ahead of the loader instead of one fault per page.
+    WIN32_MEMORY_RANGE_ENTRY range{ v, m_bytes };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st {};
+    void* v = ::fstat(fd, &st) == 0 && st.st_size > 0
+            ? ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0)
+            : MAP_FAILED;
+    if (v == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    m_file    = static_cast<std::uintptr_t>(fd);
+    m_mapping = 0;
+    m_base    = v;
+    m_bytes   = static_cast<size_t>(st.st_size);
+    ::madvise(v, m_bytes, MADV_SEQUENTIAL);
+    ::madvise(v, m_bytes, MADV_WILLNEED);
+#endif
+    m_pos = 0;
+    return true;
+}
+
+void MappedModel::close()
+{
+    if (!m_base) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_base);
+    CloseHandle(reinterpret_cast<HANDLE>(m_mapping));
+    CloseHandle(reinterpret_cast<HANDLE>(m_file));
+#else
+    ::munmap(m_base, m_bytes);
+    ::close(static_cast<int>(m_file));
+#endif
+    m_base    = nullptr;
+    m_bytes   = 0;
+    m_file    = 0;
+    m_mapping = 0;
+    m_pos     = 0;
+}
+
+// ---- whisper_model_loader --------------------------------------------
+
+whisper_model_loader MappedModel::loader()
+{
+    m_pos = 0;
+    whisper_model_loader l{};
+    l.context = this;
+    l.read    = &MappedModel::read;
+    l.eof     = &MappedModel::eof;
+    l.close   = &MappedModel::done;
+    return l;
+}
+
+size_t MappedModel::read(void* ctx, void* output, size_t bytes)
+{
+    auto* self = static_cast<MappedModel*>(ctx);
+    const size_t n = std::min(bytes, self->m_bytes - self->m_pos);
+    std::memcpy(output, self->data() + self->m_pos, n);
+    self->m_pos += n;
+    return n;
+}
+
+bool MappedModel::eof(void* ctx)
+{
+    const auto* self = static_cast<const MappedModel*>(ctx);
+    return self->m_pos >= self->m_bytes;
+}
+
+void MappedModel::done(void*)
+{
+    // whisper calls this when it has finished reading; the owner decides
+    // when to unmap.
+}
+
+// ---- Residency ---------------------------------------------------------
+
+MappedModel::Residency MappedModel::residency() const
+{
+    Residency r;
+    r.mapped = m_bytes;
+    if (!m_base) return r;
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    const size_t page  = si.dwPageSize;
+    const size_t pages = (m_bytes + page - 1) / page;
+    // QueryWorkingSetEx in batches: one entry per page.
+    std::vector<PSAPI_WORKING_SET_EX_INFORMATION> info(std::min<size_t>(pages, 4096));
+    for (size_t first = 0; first < pages; first += info.size()) {
+        const size_t n = std::min(info.size(), pages - first);
+        for (size_t i = 0; i < n; ++i)
+            info[i].VirtualAddress = static_cast<char*>(m_base) + (first + i) * page;
+        if (!QueryWorkingSetEx(GetCurrentProcess(), info.data(),
+                               static_cast<DWORD>(n * sizeof(info[0]))))
+            break;
+        for (size_t i = 0; i < n; ++i) {
+            const auto& a = info[i].VirtualAttributes;
+            if (!a.Valid) continue;
+            r.resident += page;
+            if (a.Shared && a.ShareCount > 1) r.shared += page;
+        }
+    }
+    r.resident = std::min(r.resident, m_bytes);
+    r.shared   = std::min(r.shared, m_bytes);
+#else
+    const size_t page  = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t pages = (m_bytes + page - 1) / page;
+    std::vector<unsigned char> in(pages);
+    if (::mincore(m_base, m_bytes, in.data()) == 0) {
+        for (unsigned char c : in) r.resident += (c & 1) ? page : 0;
+        r.resident = std::min(r.resident, m_bytes);
+    }
+#endif
+    return r;
+}
@@ -0,0 +1,60 @@
+#pragma once
+// mapped_model.h — read a ggml model file through a read-only file mapping.
+//
+// whisper_init_from_file_* reads the model with buffered stream reads:
+// every tensor is copied from the page cache into a stream buffer and
+// from there into whisper's own weight buffers.  This maps the file
+// read-only instead and hands whisper a whisper_model_loader that copies
+// straight out of the mapping.  The mapped pages are the page cache
+// itself — shared by every process that maps the same file and still
+// there after an unload — so a reload, or a second FLOW-ON instance on a
+// terminal server, finds the file in memory instead of re-reading it.
+//
+// whisper.cpp copies the tensors into buffers it allocates, so the
+// loaded weights themselves remain private to each process; only the
+// file pages are shared.  The mapping is needed only while loading.
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include "whisper.h"
+
+class MappedModel {
+public:
+    // Pages of the mapping in memory, in bytes.
+    struct Residency {
+        size_t mapped   = 0;   // file size
+        size_t resident = 0;   // in memory, readable without disk I/O
+        size_t shared   = 0;   // of those, mapped by another process too (Windows)
+    };
+
+    MappedModel() = default;
+    ~MappedModel() { close(); }
+    MappedModel(const MappedModel&)            = delete;
+    MappedModel& operator=(const MappedModel&) = delete;
+
+    // Maps `path` read-only and asks the OS to read it ahead sequentially.
+    bool open(const std::filesystem::path& path);
+    void close();
+    bool isOpen() const { return m_base != nullptr; }
+
+    const unsigned char* data() const { return static_cast<const unsigned char*>(m_base); }
+    size_t size() const { return m_bytes; }
+
+    // A loader for whisper_init_with_params_no_state() that reads the
+    // mapping from the start.  Valid while open; one load at a time.
+    whisper_model_loader loader();
+
+    Residency residency() const;
+
+private:
+    static size_t read(void* ctx, void* output, size_t bytes);
+    static bool   eof(void* ctx);
+    static void   done(void* ctx);
+
+    // Handles are HANDLEs on Windows, a file descriptor elsewhere.
+    void*          m_base    = nullptr;
+    size_t         m_bytes   = 0;
+    std::uintptr_t m_file    = 0;
+    std::uintptr_t m_mapping = 0;
+    size_t         m_pos     = 0;   // loader read offset
+};
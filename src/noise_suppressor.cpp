@@ -0,0 +1,111 @@
+// noise_suppressor.cpp
+#include "noise_suppressor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static constexpr float kGainFloor   = 0.1f;    // -20 dB
+static constexpr float kDdAlpha     = 0.98f;   // decision-directed smoothing
+static constexpr float kSpeechRatio = 3.0f;    // bin power above 3x noise = speech, don't learn
+static constexpr float kNoiseAlpha  = 0.04f;   // noise tracking rate in speech-absent bins
+static constexpr float kNoiseCreep  = 1.002f;  // lets an underestimate recover
+
+NoiseSuppressor::NoiseSuppressor()
+    : m_noise(kBins, 0.0f), m_prevClean(kBins, 0.0f),
+      m_re(kBins), m_im(kBins), m_frame(kFrame)
+{
+    // Periodic sqrt-Hann: analysis x synthesis sums to 1 at 50% overlap.
+    for (size_t n = 0; n < kFrame; ++n)
+        m_window[n] = std::sqrt(0.5f - 0.5f * std::cos(6.2831853f * static_cast<float>(n) / kFrame));
+}
+
+void NoiseSuppressor::resetStream()
+{
+    std::memset(m_in, 0, sizeof(m_in));
+    std::memset(m_ola, 0, sizeof(m_ola));
+    std::fill(m_prevClean.begin(), m_prevClean.end(), 0.0f);
+    m_fill    = 0;
+    m_pending = 0;
+}
+
+void NoiseSuppressor::resetProfile()
+{
+    resetStream();
+    std::fill(m_noise.begin(), m_noise.end(), 0.0f);
+    m_framesSeen = 0;
+}
+
+size_t NoiseSuppressor::process(const float* in, size_t n, float* out)
+{
+    size_t produced = 0;
+    while (n > 0) {
+        const size_t take = std::min(kHop - m_fill, n);
+        std::memcpy(m_in + kHop + m_fill, in, take * sizeof(float));
+        m_fill += take;
+        in     += take;
+        n      -= take;
+        if (m_fill == kHop) {
+            processHop(out + produced);
+            produced += kHop;
+            m_pending = kHop;
+            m_fill    = 0;
+        }
+    }
+    return produced;
+}
+
+size_t NoiseSuppressor::flush(float* out)
+{
+    // Push silence through so the held-back hop and any partial one come
+    // out, then report only the real samples.
+    const size_t real = m_pending + m_fill;
+    float tmp[2 * kHop];
+    std::memset(m_in + kHop + m_fill, 0, (kHop - m_fill) * sizeof(float));
+    m_fill = kHop;
+    processHop(tmp);
+    std::memset(m_in + kHop, 0, kHop * sizeof(float));
+    processHop(tmp + kHop);
+
+    // The stream is one hop behind: the first kHop of tmp finish the last
+    // full hop, the rest cover the partial one.
+    const size_t skip = kHop - m_pending;
+    std::memcpy(out, tmp + skip, real * sizeof(float));
+    resetStream();
+    return real;
+}
+
+void NoiseSuppressor::processHop(float* out)
+{
+    for (size_t i = 0; i < kFrame; ++i) m_frame[i] = m_in[i] * m_window[i];
+    m_fft.forward(m_frame.data(), m_re.data(), m_im.data());
+
+    const bool learning = m_framesSeen < kLearnFrames;
+    const float learnW  = 1.0f / static_cast<float>(m_framesSeen + 1);
+    ++m_framesSeen;
+
+    for (size_t k = 0; k < kBins; ++k) {
+        const float p = m_re[k] * m_re[k] + m_im[k] * m_im[k];
+        float& noise  = m_noise[k];
+
+        if (learning)                        noise += (p - noise) * learnW;   // running mean
+        else if (p < kSpeechRatio * noise)   noise += (p - noise) * kNoiseAlpha;
+        else                                 noise *= kNoiseCreep;
+        noise = std::max(noise, 1e-12f);
+
+        const float post  = p / noise;
+        const float prio  = kDdAlpha * m_prevClean[k] / noise
+                          + (1.0f - kDdAlpha) * std::max(post - 1.0f, 0.0f);
+        const float gain  = std::max(kGainFloor, prio / (1.0f + prio));
+        m_prevClean[k] = gain * gain * p;
+        m_re[k] *= gain;
+        m_im[k] *= gain;
+    }
+
+    m_fft.inverse(m_re.data(), m_im.data(), m_frame.data());
+    for (size_t i = 0; i < kFrame; ++i) m_ola[i] += m_frame[i] * m_window[i];
+
+    std::memcpy(out, m_ola, kHop * sizeof(float));
+    std::memmove(m_ola, m_ola + kHop, kHop * sizeof(float));
+    std::memset(m_ola + kHop, 0, kHop * sizeof(float));
+    std::memmove(m_in, m_in + kHop, kHop * sizeof(float));
+}
@@ -0,0 +1,276 @@
+#pragma once
+// ordered_job_queue.h — priority/deadline job queue with in-order completions.
+//
+// Feeds the persistent transcription worker(s).  Jobs are never rejected:
+// push() always queues.  pop() hands out the most urgent job first —
+// highest priority, then earliest deadline, then smallest cost (so short
+// utterances run ahead of long ones queued at the same priority), then
+// submission order.
+//
+// Completions are delivered in submission order *within a stream*, even
+// when a later job of that stream finishes first: its result is held until
+// every earlier job of the stream has completed.  Separate streams (live
+// dictation vs. a recovered recording, say) do not wait for each other.
+// Completion callbacks run on the worker thread that finished the job (or
+// the thread that cancelled it while it was still queued), one at a time,
+// outside the queue lock.
+//
+// Every job carries a CancelToken.  cancel() drops a queued job on the spot
+// and asks a running one to stop.  Pushing a job of higher priority than a
+// running one while no worker is free asks the least urgent running job to
+// yield (Reason::Preempted); its worker hands it back with requeue() and it
+// runs again later, keeping its id and place in its stream.
+#include "cancel_token.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+template <typename Payload, typename Result>
+class OrderedJobQueue {
+public:
+    using Clock      = std::chrono::steady_clock;
+    using Completion = std::function<void(uint64_t id, Result result)>;
+
+    struct Job {
+        uint64_t          id        = 0;   // process-wide, from 1
+        uint32_t          stream    = 0;
+        uint64_t          streamSeq = 0;   // position within the stream
+        int               priority  = 0;   // higher runs first
+        Clock::time_point submitted;
+        Clock::time_point deadline;
+        size_t            cost      = 0;   // e.g. samples; tie-break, smaller first
+        Payload           payload;
+        Completion        done;
+        std::shared_ptr<CancelToken> cancel;   // polled by whoever runs the job
+    };
+
+    // Queues a job and wakes a worker.  Returns its id.
+    uint64_t push(Payload payload, Completion done, int priority,
+                  Clock::time_point deadline, size_t cost, uint32_t stream = 0)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Job j;
+        j.id        = ++m_nextId;
+        j.stream    = stream;
+        j.streamSeq = m_streams[stream].nextSeq++;
+        j.priority  = priority;
+        j.submitted = Clock::now();
+        j.deadline  = deadline;
+        j.cost      = cost;
+        j.payload   = std::move(payload);
+        j.done      = std::move(done);
+        j.cancel    = std::make_shared<CancelToken>();
+        const uint64_t id = j.id;
+        m_queued.push_back(std::move(j));
+        m_wake.notify_one();
+
+        // Every worker busy: the least urgent running job below this
+        // priority makes way.
+        if (m_waiting == 0) {
+            Running* victim = nullptr;
+            for (Running& r : m_running)
+                if (r.priority < priority && (!victim || r.priority < victim->priority))
+                    victim = &r;
+            if (victim) victim->cancel->request(CancelToken::Reason::Preempted);
+        }
+        return id;
+    }
+
+    // Blocks until a job is available; false once close() has been called.
+    bool pop(Job& out)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_waiting;
+        m_wake.wait(lock, [this] { return m_closed || !m_queued.empty(); });
+        --m_waiting;
+        if (m_closed) return false;
+
+        const auto next = std::min_element(m_queued.begin(), m_queued.end(),
+            [](const Job& a, const Job& b) {
+                if (a.priority != b.priority) return a.priority > b.priority;
+                if (a.deadline != b.deadline) return a.deadline < b.deadline;
+                if (a.cost     != b.cost)     return a.cost < b.cost;
+                return a.id < b.id;
+            });
+        out = std::move(*next);
+        m_queued.erase(next);
+        m_running.push_back(Running{ out.id, out.priority, out.cancel });
+        if (Clock::now() > out.deadline) ++m_late;
+        return true;
+    }
+
+    // Records a finished job's result and delivers every completion of its
+    // stream that is now in order (possibly none, possibly several).
+    void complete(Job& job, Result result)
+    {
+        std::lock_guard<std::mutex> order(m_deliverMutex);
+        std::vector<std::pair<Job, Result>> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            stopRunning(job.id);
+            collect(std::move(job), std::move(result), ready);
+        }
+        deliver(ready);
+    }
+
+    // Hands a popped job back to the queue unfinished (it was preempted).
+    // It keeps its id, deadline and place in its stream.  Returns false,
+    // leaving the job running, if it has been cancelled meanwhile — the
+    // caller then completes it as usual.
+    bool requeue(Job& job)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (job.cancel->reason() == CancelToken::Reason::Cancelled) return false;
+        stopRunning(job.id);
+        job.cancel->reset();
+        if (m_closed) {                       // shutting down: discard like close() does
+            m_idle.notify_all();
+            return true;
+        }
+        m_queued.push_back(std::move(job));
+        m_wake.notify_one();
+        return true;
+    }
+
+    // A queued job is removed and completed at once with `result`; a
+    // running one is asked to stop (its worker completes it).  False if
+    // no such job is queued or running.  Not from a completion callback.
+    bool cancel(uint64_t id, Result result)
+    {
+        std::lock_guard<std::mutex> order(m_deliverMutex);
+        std::vector<std::pair<Job, Result>> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto queued = std::find_if(m_queued.begin(), m_queued.end(),
+                                             [id](const Job& j) { return j.id == id; });
+            if (queued == m_queued.end()) {
+                for (Running& r : m_running)
+                    if (r.id == id) {
+                        r.cancel->request(CancelToken::Reason::Cancelled);
+                        return true;
+                    }
+                return false;
+            }
+            Job j = std::move(*queued);
+            m_queued.erase(queued);
+            j.cancel->request(CancelToken::Reason::Cancelled);
+            collect(std::move(j), std::move(result), ready);
+        }
+        deliver(ready);
+        return true;
+    }
+
+    // cancel() for every queued and running job.  Returns how many.
+    size_t cancelAll(const Result& result)
+    {
+        std::vector<uint64_t> ids;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const Job& j : m_queued)     ids.push_back(j.id);
+            for (const Running& r : m_running) ids.push_back(r.id);
+        }
+        size_t n = 0;
+        for (uint64_t id : ids)
+            if (cancel(id, result)) ++n;
+        return n;
+    }
+
+    // Wakes every worker; pop() returns false from now on.  Jobs still
+    // queued are discarded without a completion; running ones are asked
+    // to stop.
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_queued.clear();
+        for (Running& r : m_running) r.cancel->request(CancelToken::Reason::Cancelled);
+        m_wake.notify_all();
+        m_idle.notify_all();
+    }
+
+    // Blocks until nothing is queued or running (or close()).
+    void waitIdle()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_closed || (m_queued.empty() && m_running.empty()); });
+    }
+
+    // Jobs queued or running.
+    size_t pending() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queued.size() + m_running.size();
+    }
+
+    // Jobs that were popped after their deadline had passed.
+    uint64_t lateJobs() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_late;
+    }
+
+private:
+    struct Running {
+        uint64_t                     id       = 0;
+        int                          priority = 0;
+        std::shared_ptr<CancelToken> cancel;
+    };
+
+    struct Stream {
+        uint64_t                                  nextSeq      = 0;
+        uint64_t                                  nextDelivery = 0;
+        std::map<uint64_t, std::pair<Job, Result>> finished;   // waiting for an earlier job
+    };
+
+    // m_mutex held.
+    void stopRunning(uint64_t id)
+    {
+        m_running.erase(std::find_if(m_running.begin(), m_running.end(),
+                                     [id](const Running& r) { return r.id == id; }));
+        m_idle.notify_all();
+    }
+
+    // m_mutex held: files a finished job and moves every completion of its
+    // stream that is now in order to `ready`.
+    void collect(Job&& job, Result&& result, std::vector<std::pair<Job, Result>>& ready)
+    {
+        Stream& s = m_streams[job.stream];
+        const uint64_t seq = job.streamSeq;
+        s.finished.emplace(seq, std::make_pair(std::move(job), std::move(result)));
+        for (auto it = s.finished.find(s.nextDelivery); it != s.finished.end();
+             it = s.finished.find(s.nextDelivery)) {
+            ready.push_back(std::move(it->second));
+            s.finished.erase(it);
+            ++s.nextDelivery;
+        }
+        m_idle.notify_all();
+    }
+
+    // m_deliverMutex held, m_mutex not.
+    static void deliver(std::vector<std::pair<Job, Result>>& ready)
+    {
+        for (auto& [j, r] : ready)
+            if (j.done) j.done(j.id, std::move(r));
+    }
+
+    mutable std::mutex           m_mutex;
+    std::mutex                   m_deliverMutex;   // completions go out one at a time, in order
+    std::condition_variable      m_wake;
+    std::condition_variable      m_idle;
+    std::vector<Job>             m_queued;
+    std::vector<Running>         m_running;
+    std::map<uint32_t, Stream>   m_streams;
+    uint64_t                     m_nextId  = 0;
+    size_t                       m_waiting = 0;   // workers blocked in pop()
+    uint64_t                     m_late    = 0;
+    bool                         m_closed  = false;
+};
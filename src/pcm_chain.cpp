@@ -0,0 +1,195 @@
+// pcm_chain.cpp
+#include "pcm_chain.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+// ------------------------------------------------------------------
+// Process-wide page pool.  Pages are taken on the audio consumer side and
+// returned from whichever thread drops the chain (usually the Whisper
+// worker), so the free list is mutex-guarded.  Neither side is the
+// real-time audio thread.
+// ------------------------------------------------------------------
+namespace {
+
+struct PagePool {
+    std::mutex            mutex;
+    std::vector<PcmPage*> free;
+    size_t                maxCached = 60;   // 60 idle pages (~3.8 MB)
+
+    PcmPage* acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!free.empty()) {
+                PcmPage* p = free.back();
+                free.pop_back();
+                p->frames = 0;
+                return p;
+            }
+        }
+        return new PcmPage();
+    }
+
+    void release(std::vector<PcmPage*>& pages)
+    {
+        std::vector<PcmPage*> surplus;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (PcmPage* p : pages) {
+                if (free.size() < maxCached) free.push_back(p);
+                else                         surplus.push_back(p);
+            }
+        }
+        for (PcmPage* p : surplus) delete p;
+        pages.clear();
+    }
+};
+
+// Leaked on purpose: chains owned by other static objects may be dropped
+// during static destruction, after a plain global pool would be gone.
+PagePool& pool()
+{
+    static PagePool* p = new PagePool();
+    return *p;
+}
+
+} // namespace
+
+void PcmChain::reservePool(size_t pages, size_t maxCached)
+{
+    PagePool& pp = pool();
+    std::lock_guard<std::mutex> lock(pp.mutex);
+    pp.maxCached = maxCached;
+    while (pp.free.size() < std::min(pages, maxCached))
+        pp.free.push_back(new PcmPage());
+}
+
+// ------------------------------------------------------------------
+
+PcmChain::PcmChain(PcmFormat format)
+    : m_format(format),
+      m_perPage(format == PcmFormat::Int16 ? PcmPage::kBytes / sizeof(int16_t) : PcmPage::kFrames)
+{
+}
+
+PcmChain::PcmChain(PcmChain&& other) noexcept
+    : m_pages(std::move(other.m_pages)), m_frames(other.m_frames),
+      m_format(other.m_format), m_perPage(other.m_perPage)
+{
+    other.m_pages.clear();
+    other.m_frames = 0;
+}
+
+PcmChain& PcmChain::operator=(PcmChain&& other) noexcept
+{
+    if (this != &other) {
+        clear();
+        m_pages   = std::move(other.m_pages);
+        m_frames  = other.m_frames;
+        m_format  = other.m_format;
+        m_perPage = other.m_perPage;
+        other.m_pages.clear();
+        other.m_frames = 0;
+    }
+    return *this;
+}
+
+PcmPage* PcmChain::tailPage()
+{
+    if (m_pages.empty() || m_pages.back()->frames == m_perPage)
+        m_pages.push_back(pool().acquire());
+    return m_pages.back();
+}
+
+std::span<float> PcmChain::tail()
+{
+    PcmPage* p = tailPage();
+    return { p->f32() + p->frames, m_perPage - p->frames };
+}
+
+void PcmChain::commit(size_t frames)
+{
+    m_pages.back()->frames += frames;
+    m_frames               += frames;
+}
+
+void PcmChain::append(const float* src, size_t frames)
+{
+    while (frames > 0) {
+        PcmPage* p = tailPage();
+        const size_t n = std::min(m_perPage - p->frames, frames);
+        if (m_format == PcmFormat::Int16)
+            audio_kernels::floatToInt16(src, n, p->s16() + p->frames);
+        else
+            std::memcpy(p->f32() + p->frames, src, n * sizeof(float));
+        commit(n);
+        src    += n;
+        frames -= n;
+    }
+}
+
+void PcmChain::clear()
+{
+    if (!m_pages.empty()) pool().release(m_pages);
+    m_frames = 0;
+}
+
+float PcmChain::at(size_t i) const
+{
+    const PcmPage* p = m_pages[i / m_perPage];
+    float v;
+    if (m_format == PcmFormat::Int16) audio_kernels::int16ToFloat(p->s16() + i % m_perPage, 1, &v);
+    else                              v = p->f32()[i % m_perPage];
+    return v;
+}
+
+// Int16 pages are scanned through a small float window; this is only the
+// fallback when the consumer stage left no loud range.
+static constexpr size_t kScanWindow = 1024;
+
+size_t PcmChain::findFirstAbove(float threshold) const
+{
+    size_t pos = 0;
+    float  buf[kScanWindow];
+    for (size_t i = 0; i < m_frames; i += kScanWindow) {
+        const size_t n = std::min(kScanWindow, m_frames - i);
+        const float* x = contiguous(i, i + n);
+        if (!x) { copyTo(buf, i, i + n); x = buf; }
+        const size_t k = audio_kernels::findFirstAbove(x, n, threshold);
+        if (k < n) return pos + k;
+        pos += n;
+    }
+    return m_frames;
+}
+
+size_t PcmChain::findLastAbove(float threshold) const
+{
+    float buf[kScanWindow];
+    for (size_t end = m_frames; end > 0;) {
+        const size_t n = std::min(kScanWindow, end);
+        const float* x = contiguous(end - n, end);
+        if (!x) { copyTo(buf, end - n, end); x = buf; }
+        const size_t k = audio_kernels::findLastAbove(x, n, threshold);
+        if (k < n) return end - n + k;
+        end -= n;
+    }
+    return m_frames;
+}
+
+const float* PcmChain::contiguous(size_t begin, size_t end) const
+{
+    if (begin >= end || m_format != PcmFormat::Float32) return nullptr;
+    if (begin / m_perPage != (end - 1) / m_perPage) return nullptr;
+    return m_pages[begin / m_perPage]->f32() + (begin % m_perPage);
+}
+
+void PcmChain::copyTo(float* dst, size_t begin, size_t end) const
+{
+    forEachRun(begin, end, [&](const PcmPage& p, size_t off, size_t n) {
+        if (m_format == PcmFormat::Int16) audio_kernels::int16ToFloat(p.s16() + off, n, dst);
+        else                              std::memcpy(dst, p.f32() + off, n * sizeof(float));
+        dst += n;
+    });
+}
@@ -0,0 +1,104 @@
+#pragma once
+// pcm_chain.h — unbounded, page-chained recording buffer.
+//
+// A recording is a list of fixed-size 64 KB pages (1 s of float or 2 s of
+// int16 at 16 kHz) borrowed from a process-wide pool.  Appending never
+// reallocates or moves existing samples, so there is no length cap and no
+// per-session ~1 MB reserve; dropping a chain hands its pages back to the
+// pool for the next session.  Chains are move-only and are
+// passed by value from AudioManager to Transcriber without copying PCM.
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Sample storage of a chain.  Int16 halves memory and cache traffic per
+// second of audio; conversion to float happens in copyTo() (SIMD), right
+// before the samples reach Whisper.
+enum class PcmFormat { Float32, Int16 };
+
+struct PcmPage {
+    static constexpr size_t kBytes  = 64000;                    // 1 s of float, 2 s of int16 at 16 kHz
+    static constexpr size_t kFrames = kBytes / sizeof(float);   // float frames per page
+    size_t frames = 0;
+    alignas(32) unsigned char bytes[kBytes];
+
+    float*         f32()       { return reinterpret_cast<float*>(bytes); }
+    const float*   f32() const { return reinterpret_cast<const float*>(bytes); }
+    int16_t*       s16()       { return reinterpret_cast<int16_t*>(bytes); }
+    const int16_t* s16() const { return reinterpret_cast<const int16_t*>(bytes); }
+};
+
+class PcmChain {
+public:
+    explicit PcmChain(PcmFormat format = PcmFormat::Float32);
+    ~PcmChain() { clear(); }
+
+    PcmChain(PcmChain&& other) noexcept;
+    PcmChain& operator=(PcmChain&& other) noexcept;
+    PcmChain(const PcmChain&)            = delete;
+    PcmChain& operator=(const PcmChain&) = delete;
+
+    PcmFormat format() const { return m_format; }
+    size_t size()  const { return m_frames; }
+    bool   empty() const { return m_frames == 0; }
+
+    // Bytes of page storage held — what the recording actually costs.
+    size_t bytes() const { return m_pages.size() * PcmPage::kBytes; }
+
+    // Float32 chains only: writable space at the tail, taking a fresh page
+    // from the pool if the last one is full.  Fill it, then commit() how
+    // much was written.
+    std::span<float> tail();
+    void commit(size_t frames);
+
+    // Appends float samples; an Int16 chain quantises them on the way in.
+    void append(const float* src, size_t frames);
+
+    // Returns every page to the pool.
+    void clear();
+
+    // Raw page storage, whatever the format (e.g. to wipe it).
+    size_t                   pageCount()    const { return m_pages.size(); }
+    std::span<unsigned char> pageBytes(size_t i)  { return { m_pages[i]->bytes, PcmPage::kBytes }; }
+
+    float at(size_t i) const;
+
+    // Index of the first / last sample with |x| > threshold, or size().
+    size_t findFirstAbove(float threshold) const;
+    size_t findLastAbove(float threshold) const;
+
+    // Float32 chains: pointer to [begin, end) if it lies inside one page,
+    // else nullptr.  Always nullptr for Int16 — use copyTo().
+    const float* contiguous(size_t begin, size_t end) const;
+
+    // Copies [begin, end) into dst (which must hold end - begin floats),
+    // converting Int16 pages with the SIMD kernel.
+    void copyTo(float* dst, size_t begin, size_t end) const;
+
+    // Pre-populates the shared page pool so the first session does not
+    // allocate.  The pool keeps at most `maxCached` idle pages; the rest
+    // of a very long recording is freed when its chain is dropped.
+    static void reservePool(size_t pages, size_t maxCached);
+
+private:
+    // Calls fn(page, offset, count) for each run of [begin, end) in one page.
+    template <typename Fn>
+    void forEachRun(size_t begin, size_t end, Fn&& fn) const
+    {
+        while (begin < end) {
+            const PcmPage* p   = m_pages[begin / m_perPage];
+            const size_t   off = begin % m_perPage;
+            const size_t   n   = (p->frames - off) < (end - begin) ? (p->frames - off) : (end - begin);
+            fn(*p, off, n);
+            begin += n;
+        }
+    }
+
+    PcmPage* tailPage();
+
+    std::vector<PcmPage*> m_pages;
+    size_t                m_frames  = 0;
+    PcmFormat             m_format  = PcmFormat::Float32;
+    size_t                m_perPage = PcmPage::kFrames;   // frames per page in m_format
+};
@@ -0,0 +1,443 @@
+// recording_journal.cpp
+#include "recording_journal.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// ------------------------------------------------------------------
+// On-disk format
+// ------------------------------------------------------------------
+struct RecordingJournal::Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sequence;        // newest valid slot wins
+    uint32_t sampleRate;
+    uint32_t state;           // kIdle / kRecording
+    uint64_t samples;         // committed write offset, in samples
+    uint64_t capacity;        // samples the file holds
+    int64_t  startedUnixMs;
+    uint32_t dataCrc;         // CRC-32 of samples [0, samples)
+    uint32_t flags;           // kLossy | kTruncated
+    uint32_t reserved;
+    uint32_t headerCrc;       // CRC-32 of every field above
+};
+static_assert(sizeof(RecordingJournal::Header) == 64, "journal header slot is 64 bytes");
+
+static constexpr uint32_t kMagic      = 0x4A4F4C46;   // "FLOJ"
+static constexpr uint32_t kVersion    = 1;
+static constexpr uint32_t kIdle       = 0;
+static constexpr uint32_t kRecording  = 1;
+static constexpr uint32_t kLossy      = 1u << 0;
+static constexpr uint32_t kTruncated  = 1u << 1;
+static constexpr size_t   kDataOffset = 4096;         // samples start on their own page
+
+// Writer cadence: wake often enough that the 4 s queue never fills, flush
+// to disk once a second.
+static constexpr auto   kWriterInterval = std::chrono::milliseconds(50);
+static constexpr auto   kFlushInterval  = std::chrono::seconds(1);
+static constexpr size_t kQueueSec       = 4;
+
+// ------------------------------------------------------------------
+// CRC-32 (IEEE, reflected) — a byte-wise table is far faster than the
+// 32 KB/s the journal writes.
+// ------------------------------------------------------------------
+namespace {
+
+struct CrcTable {
+    uint32_t v[256];
+    constexpr CrcTable() : v()
+    {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            v[i] = c;
+        }
+    }
+};
+constexpr CrcTable kCrc;
+
+uint32_t crc32(uint32_t crc, const void* data, size_t n)
+{
+    const auto* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = kCrc.v[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t headerCrc(const RecordingJournal::Header& h)
+{
+    return crc32(0, &h, offsetof(RecordingJournal::Header, headerCrc));
+}
+
+bool valid(const RecordingJournal::Header& h)
+{
+    return h.magic == kMagic && h.version == kVersion && h.headerCrc == headerCrc(h)
+        && h.samples <= h.capacity;
+}
+
+// Newest valid of the two slots at the start of the file, or nullptr.
+const RecordingJournal::Header* newest(const void* base)
+{
+    const auto* slots = static_cast<const RecordingJournal::Header*>(base);
+    const bool a = valid(slots[0]), b = valid(slots[1]);
+    if (a && b) return slots[0].sequence > slots[1].sequence ? &slots[0] : &slots[1];
+    return a ? &slots[0] : b ? &slots[1] : nullptr;
+}
+
+int64_t unixMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+double msSince(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// ---- Memory-mapped file, Win32 or POSIX ------------------------------
+
+bool mapFile(const std::filesystem::path& path, size_t bytes,
+             std::uintptr_t& file, std::uintptr_t& mapping, void*& base)
+{
+#ifdef _WIN32
+    HANDLE f = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                           nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(bytes);
+    if (!SetFilePointerEx(f, size, nullptr, FILE_BEGIN) || !SetEndOfFile(f)) {
+        CloseHandle(f);
+        return false;
+    }
+    HANDLE m = CreateFileMappingW(f, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    void*  v = m ? MapViewOfFile(m, FILE_MAP_ALL_ACCESS, 0, 0, bytes) : nullptr;
+    if (!v) {
+        if (m) CloseHandle(m);
+        CloseHandle(f);
+        return false;
+    }
+    file    = reinterpret_cast<std::uintptr_t>(f);
+    mapping = reinterpret_cast<std::uintptr_t>(m);
+    base    = v;
+    return true;
+#else
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) return false;
+    void* v = ::ftruncate(fd, static_cast<off_t>(bytes)) == 0
+            ? ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+            : MAP_FAILED;
+    if (v == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    file    = static_cast<std::uintptr_t>(fd);
+    mapping = 0;
+    base    = v;
+    return true;
+#endif
+}
+
+void unmapFile(std::uintptr_t file, std::uintptr_t mapping, void* base, size_t bytes)
+{
+#ifdef _WIN32
+    (void)bytes;
+    UnmapViewOfFile(base);
+    CloseHandle(reinterpret_cast<HANDLE>(mapping));
+    CloseHandle(reinterpret_cast<HANDLE>(file));
+#else
+    (void)mapping;
+    ::munmap(base, bytes);
+    ::close(static_cast<int>(file));
+#endif
+}
+
+// Starts writing [offset, offset + bytes) of the view back to the file.
+// Does not wait for the disk itself — a crash only loses what the OS has
+// not yet written, a process exit loses nothing.
+void flushRange(void* base, size_t offset, size_t bytes)
+{
+#ifdef _WIN32
+    FlushViewOfFile(static_cast<char*>(base) + offset, bytes);
+#else
+    const size_t page  = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t begin = offset / page * page;
+    ::msync(static_cast<char*>(base) + begin, offset + bytes - begin, MS_ASYNC);
+#endif
+}
+
+} // namespace
+
+// ------------------------------------------------------------------
+// Recovery
+// ------------------------------------------------------------------
+bool RecordingJournal::recover(const std::filesystem::path& path, PcmChain& pcm, Recovered& info)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) return false;
+
+    alignas(Header) unsigned char head[2 * sizeof(Header)];
+    if (!f.read(reinterpret_cast<char*>(head), sizeof(head))) return false;
+    const Header* h = newest(head);
+    if (!h || h->state != kRecording || h->samples == 0) return false;
+
+    // Samples are checked against the CRC as they are read; a mismatch
+    // means the file was damaged, not merely cut short.
+    PcmChain out(PcmFormat::Int16);
+    std::vector<int16_t> s16(16000);
+    std::vector<float>   f32(s16.size());
+    uint32_t crc = 0;
+    f.seekg(static_cast<std::streamoff>(kDataOffset));
+    for (uint64_t left = h->samples; left > 0; ) {
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(left, s16.size()));
+        if (!f.read(reinterpret_cast<char*>(s16.data()), static_cast<std::streamsize>(n * sizeof(int16_t))))
+            return false;
+        crc = crc32(crc, s16.data(), n * sizeof(int16_t));
+        audio_kernels::int16ToFloat(s16.data(), n, f32.data());
+        out.append(f32.data(), n);
+        left -= n;
+    }
+    if (crc != h->dataCrc) return false;
+
+    pcm = std::move(out);
+    info.sampleRate    = h->sampleRate;
+    info.startedUnixMs = h->startedUnixMs;
+    info.lossy         = (h->flags & kLossy) != 0;
+    info.truncated     = (h->flags & kTruncated) != 0;
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Lifetime
+// ------------------------------------------------------------------
+bool RecordingJournal::open(const std::filesystem::path& path, uint32_t sampleRate, size_t capacitySec)
+{
+    close();
+    const uint64_t capacity = uint64_t{sampleRate} * capacitySec;
+    const size_t   bytes    = kDataOffset + static_cast<size_t>(capacity) * sizeof(int16_t);
+    if (!mapFile(path, bytes, m_file, m_mapping, m_base)) {
+        m_base = nullptr;
+        return false;
+    }
+    m_bytes      = bytes;
+    m_sampleRate = sampleRate;
+    m_capacity   = capacity;
+    m_stats      = Stats{};
+
+    // Keep an unfinished recording of the same shape as it is: recover()
+    // may still be working from it.  Anything else is reinitialised.
+    const Header* h = newest(m_base);
+    if (h && h->sampleRate == sampleRate && h->capacity == capacity) {
+        m_sequence  = h->sequence;
+        m_state     = h->state;
+        m_written   = h->samples;
+        m_crc       = h->dataCrc;
+        m_flags     = h->flags;
+        m_startedMs = h->startedUnixMs;
+    } else {
+        m_sequence = 0;
+        m_state    = kIdle;
+        m_written  = 0;
+        m_crc      = 0;
+        m_flags    = 0;
+        commitHeader();
+        flushRange(m_base, 0, kDataOffset);
+    }
+    m_dirtyBegin = m_dirtyEnd = 0;
+
+    m_ring  = std::make_unique<CaptureRing>(size_t{sampleRate} * kQueueSec);
+    m_stage.assign(4096, 0.0f);
+    m_drops.store(0, std::memory_order_relaxed);
+    m_seenDrops = 0;
+
+    m_quit   = false;
+    m_writer = std::thread([this] { writerLoop(); });
+    return true;
+}
+
+void RecordingJournal::close()
+{
+    if (m_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_quit = true;
+        }
+        m_wake.notify_one();
+        m_writer.join();
+    }
+    if (m_base) {
+        unmapFile(m_file, m_mapping, m_base, m_bytes);
+        m_base = nullptr;
+    }
+    m_ring.reset();
+}
+
+// ------------------------------------------------------------------
+// Recording
+// ------------------------------------------------------------------
+int16_t* RecordingJournal::samples() const
+{
+    return reinterpret_cast<int16_t*>(static_cast<char*>(m_base) + kDataOffset);
+}
+
+void RecordingJournal::begin()
+{
+    if (!m_base) return;
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    // The consumer stage is parked, so nothing is appending; anything
+    // still queued belongs to no recording.
+    m_ring->reset();
+    m_drops.store(0, std::memory_order_relaxed);
+    m_seenDrops = 0;
+    m_state     = kRecording;
+    m_written   = 0;
+    m_crc       = 0;
+    m_flags     = 0;
+    m_startedMs = unixMs();
+    commitHeader();
+}
+
+void RecordingJournal::append(const float* x, size_t n)
+{
+    if (!m_ring) return;
+    const size_t k = m_ring->write(x, n);
+    if (k < n) m_drops.fetch_add(n - k, std::memory_order_relaxed);
+}
+
+void RecordingJournal::finish()
+{
+    if (!m_base) return;
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    drain();
+    if (m_state == kIdle && m_written == 0) return;
+
+    // Wipe what was recorded; the writer flushes the zeroes with its next pass.
+    std::memset(samples(), 0, static_cast<size_t>(m_written) * sizeof(int16_t));
+    markDirty(0, m_written);
+    m_state   = kIdle;
+    m_written = 0;
+    m_crc     = 0;
+    m_flags   = 0;
+    commitHeader();
+}
+
+RecordingJournal::Stats RecordingJournal::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    return m_stats;
+}
+
+// ------------------------------------------------------------------
+// Writer
+// ------------------------------------------------------------------
+void RecordingJournal::drain()
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    const uint64_t before = m_written;
+    for (;;) {
+        const size_t n = m_ring->read(m_stage.data(), m_stage.size());
+        if (n == 0) break;
+        if (m_state != kRecording) continue;   // no recording open: discard
+
+        const size_t take = static_cast<size_t>(std::min<uint64_t>(n, m_capacity - m_written));
+        if (take < n) m_flags |= kTruncated;
+        int16_t* dst = samples() + m_written;
+        audio_kernels::floatToInt16(m_stage.data(), take, dst);
+        m_crc      = crc32(m_crc, dst, take * sizeof(int16_t));
+        m_written += take;
+    }
+
+    const uint64_t drops   = m_drops.load(std::memory_order_relaxed);
+    const bool     dropped = drops != m_seenDrops && m_state == kRecording;
+    if (dropped) {
+        m_flags        |= kLossy;
+        m_stats.dropped = drops;
+        m_seenDrops     = drops;
+    }
+    if (m_written == before && !dropped) return;
+
+    markDirty(before, m_written);
+    commitHeader();
+    m_stats.samples += m_written - before;
+    m_stats.batches += 1;
+    m_stats.writeMs += msSince(t0);
+}
+
+void RecordingJournal::commitHeader()
+{
+    Header h{};
+    h.magic         = kMagic;
+    h.version       = kVersion;
+    h.sequence      = ++m_sequence;
+    h.sampleRate    = m_sampleRate;
+    h.state         = m_state;
+    h.samples       = m_written;
+    h.capacity      = m_capacity;
+    h.startedUnixMs = m_startedMs;
+    h.dataCrc       = m_crc;
+    h.flags         = m_flags;
+    h.headerCrc     = headerCrc(h);
+
+    // Samples are already in place; the other slot still describes the
+    // previous state until this one is complete.
+    std::memcpy(static_cast<Header*>(m_base) + (m_sequence & 1), &h, sizeof(h));
+    m_headerDirty = true;
+}
+
+void RecordingJournal::markDirty(uint64_t begin, uint64_t end)
+{
+    if (begin >= end) return;
+    if (m_dirtyBegin == m_dirtyEnd) {
+        m_dirtyBegin = begin;
+        m_dirtyEnd   = end;
+    } else {
+        m_dirtyBegin = std::min(m_dirtyBegin, begin);
+        m_dirtyEnd   = std::max(m_dirtyEnd, end);
+    }
+}
+
+void RecordingJournal::flushDirty()
+{
+    if (!m_headerDirty && m_dirtyBegin == m_dirtyEnd) return;
+    const auto t0 = std::chrono::steady_clock::now();
+    if (m_dirtyBegin != m_dirtyEnd)
+        flushRange(m_base, kDataOffset + static_cast<size_t>(m_dirtyBegin) * sizeof(int16_t),
+                   static_cast<size_t>(m_dirtyEnd - m_dirtyBegin) * sizeof(int16_t));
+    // Header after the samples it describes.
+    flushRange(m_base, 0, 2 * sizeof(Header));
+    m_dirtyBegin = m_dirtyEnd = 0;
+    m_headerDirty = false;
+    m_stats.flushMs += msSince(t0);
+}
+
+void RecordingJournal::writerLoop()
+{
+    auto lastFlush = std::chrono::steady_clock::now();
+    for (;;) {
+        bool quit;
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wake.wait_for(lock, kWriterInterval, [this] { return m_quit; });
+            quit = m_quit;
+        }
+
+        std::lock_guard<std::mutex> lock(m_fileMutex);
+        drain();
+        if (quit || std::chrono::steady_clock::now() - lastFlush >= kFlushInterval) {
+            flushDirty();
+            lastFlush = std::chrono::steady_clock::now();
+        }
+        if (quit) break;
+    }
+}
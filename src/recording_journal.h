@@ -0,0 +1,128 @@
+#pragma once
+// recording_journal.h — crash-safe on-disk copy of the recording in progress.
+//
+// The recording lives in process memory until Whisper has consumed it, so a
+// crash mid-dictation used to lose it.  With the journal enabled, every
+// block the consumer stage appends to the recording is also queued here
+// (a wait-free ring write — never a syscall or a lock) and a background
+// thread copies it as int16 into a memory-mapped file.  Pages of a mapped
+// file belong to the OS, so they survive the process dying; the writer
+// also flushes them to disk once a second.
+//
+// File layout: two 64-byte header slots, then int16 samples from byte 4096.
+// A header holds the sample rate, the committed sample count and a running
+// CRC-32 of the samples, and is itself CRC-protected.  Updates alternate
+// between the two slots with an increasing sequence number, so a header
+// torn by a crash leaves the previous one intact.
+//
+// On the next start recover() returns any recording that was begun but not
+// finished.  finish() wipes the samples, so nothing lingers on disk once a
+// recording has been transcribed.
+#include "capture_ring.h"
+#include "pcm_chain.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class RecordingJournal {
+public:
+    struct Recovered {
+        uint32_t sampleRate    = 0;
+        int64_t  startedUnixMs = 0;
+        bool     lossy         = false;   // the writer fell behind; blocks are missing
+        bool     truncated     = false;   // the recording outgrew the file
+    };
+
+    // Counters for the overhead the journal adds.
+    struct Stats {
+        uint64_t samples   = 0;     // written to the file
+        uint64_t batches   = 0;     // writer passes that moved data
+        double   writeMs   = 0.0;   // writer time: convert, copy, CRC, header
+        double   flushMs   = 0.0;   // writer time in FlushViewOfFile / msync
+        uint64_t dropped   = 0;     // samples lost because the writer fell behind
+    };
+
+    // One on-disk header slot (layout in the .cpp).
+    struct Header;
+
+    // Reads the journal at `path` without modifying it.  Returns true and
+    // fills `pcm` (Int16) if it holds an unfinished recording whose
+    // header and sample CRCs check out.
+    static bool recover(const std::filesystem::path& path, PcmChain& pcm, Recovered& info);
+
+    RecordingJournal() = default;
+    ~RecordingJournal() { close(); }
+    RecordingJournal(const RecordingJournal&)            = delete;
+    RecordingJournal& operator=(const RecordingJournal&) = delete;
+
+    // Maps (creating or resizing) a journal for up to `capacitySec` of audio
+    // and starts the writer thread.  An unfinished recording already in the
+    // file is left alone until the next begin() or finish().
+    bool open(const std::filesystem::path& path, uint32_t sampleRate, size_t capacitySec);
+    void close();
+    bool isOpen() const { return m_base != nullptr; }
+
+    // Main thread, while the consumer stage is parked: start a new
+    // recording in the file (before AudioManager::startCapture()).
+    void begin();
+
+    // Producer (the AudioManager sample callback): queues samples for the
+    // writer.  Wait-free; if the writer is more than 4 s behind, samples
+    // are dropped and the recording is marked lossy.
+    void append(const float* x, size_t n);
+
+    // Main thread: the recording is safe elsewhere (transcribed or
+    // discarded).  Writes out anything queued, zeroes the samples and
+    // marks the journal clean.  Blocks for at most one writer pass.
+    void finish();
+
+    Stats stats() const;
+
+private:
+    // All but writerLoop() run with m_fileMutex held.
+    void     writerLoop();
+    void     drain();                                 // queue -> file, then header
+    void     commitHeader();                          // into the older slot
+    void     markDirty(uint64_t begin, uint64_t end); // samples to flush
+    void     flushDirty();
+    int16_t* samples() const;
+
+    // Mapping.  Handles are HANDLEs on Windows, a file descriptor elsewhere.
+    void*          m_base     = nullptr;
+    size_t         m_bytes    = 0;
+    std::uintptr_t m_file     = 0;
+    std::uintptr_t m_mapping  = 0;
+
+    // Written only under m_fileMutex.
+    mutable std::mutex m_fileMutex;
+    uint32_t       m_sampleRate  = 0;
+    uint64_t       m_capacity    = 0;   // samples the file holds
+    uint64_t       m_sequence    = 0;   // of the newest header slot
+    uint64_t       m_written     = 0;   // committed samples
+    uint64_t       m_dirtyBegin  = 0;   // samples not yet flushed: [begin, end)
+    uint64_t       m_dirtyEnd    = 0;
+    bool           m_headerDirty = false;
+    uint32_t       m_crc         = 0;
+    uint32_t       m_state       = 0;
+    uint32_t       m_flags       = 0;
+    int64_t        m_startedMs   = 0;
+    uint64_t       m_seenDrops   = 0;
+    Stats          m_stats;
+    std::vector<float>   m_stage;
+
+    // Consumer stage -> writer.
+    std::unique_ptr<CaptureRing> m_ring;
+    std::atomic<uint64_t>        m_drops{0};
+
+    std::thread             m_writer;
+    std::mutex              m_wakeMutex;
+    std::condition_variable m_wake;
+    bool                    m_quit = false;   // m_wakeMutex
+};
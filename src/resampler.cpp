@@ -0,0 +1,119 @@
+// resampler.cpp
+#include "resampler.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// Zeroth-order modified Bessel function — Kaiser window.
+static double besselI0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum  += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+Resampler::Resampler(uint32_t inRate, uint32_t outRate, float transitionHz)
+    : m_inRate(inRate), m_outRate(outRate)
+{
+    const uint32_t g = std::gcd(inRate, outRate);
+    m_up   = outRate / g;
+    m_down = inRate  / g;
+
+    // ~80 dB stopband: Kaiser beta 7.86; length from the standard estimate,
+    // expressed in input samples so it doesn't grow with L.
+    constexpr double kAttenDb = 80.0;
+    constexpr double kBeta    = 0.1102 * (kAttenDb - 8.7);
+    const double nyquist = 0.5 * std::min(inRate, outRate);
+    const double cutoff  = nyquist - 0.5 * transitionHz;       // Hz, mid-transition
+    const double width   = static_cast<double>(transitionHz) / inRate;
+    size_t taps = static_cast<size_t>(std::ceil((kAttenDb - 8.0) / (2.285 * 2.0 * 3.14159265358979 * width)));
+    m_taps = (taps + 7) & ~size_t{7};
+
+    // Prototype at the upsampled rate L * inRate, split into L phases.
+    const size_t len = m_taps * m_up;
+    const double fc  = cutoff / (static_cast<double>(inRate) * m_up);   // cycles / upsampled sample
+    const double mid = 0.5 * static_cast<double>(len - 1);
+    const double i0b = besselI0(kBeta);
+
+    m_coeffs.assign(len, 0.0f);
+    for (size_t n = 0; n < len; ++n) {
+        const double t    = static_cast<double>(n) - mid;
+        const double sinc = t == 0.0 ? 2.0 * fc : std::sin(2.0 * 3.14159265358979 * fc * t) / (3.14159265358979 * t);
+        const double r    = t / (mid + 1.0);
+        const double win  = besselI0(kBeta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0b;
+        // Phase p, tap j = n / L; stored reversed so a phase is a plain dot
+        // product with the history window (oldest sample first).
+        const size_t p = n % m_up, j = n / m_up;
+        m_coeffs[p * m_taps + (m_taps - 1 - j)] = static_cast<float>(sinc * win * m_up);
+    }
+    reset();
+}
+
+void Resampler::reset()
+{
+    m_hist.assign(m_taps - 1, 0.0f);   // zero history before the first sample
+    m_hist.reserve(m_taps * 4 + 8192);
+    m_histStart = 0;
+    m_next      = m_taps - 1;
+    m_phase     = 0;
+}
+
+double Resampler::delay() const
+{
+    const double midUp = 0.5 * static_cast<double>(m_taps * m_up - 1);
+    return midUp / m_down;
+}
+
+size_t Resampler::process(const float* in, size_t n, float* out)
+{
+    m_hist.insert(m_hist.end(), in, in + n);
+    return drain(out);
+}
+
+size_t Resampler::flush(float* out)
+{
+    // Outputs so far cover upsampled positions [0, made * M); the real
+    // input ends at N * L, and the filter centre trails the newest tap by
+    // midUp, so the last real output is the one before (N * L + midUp) / M.
+    const uint64_t inputs = m_histStart + m_hist.size() - (m_taps - 1);
+    const uint64_t made   = ((m_next - (m_taps - 1)) * m_up + m_phase) / m_down;
+    const double   midUp  = 0.5 * static_cast<double>(m_taps * m_up - 1);
+    const uint64_t total  = inputs == 0 ? 0
+        : static_cast<uint64_t>(std::ceil((static_cast<double>(inputs) * m_up + midUp) / m_down));
+
+    // Push silence through — one filter length reaches past the centre of
+    // every one of them — then report only those.
+    m_hist.insert(m_hist.end(), m_taps, 0.0f);
+    const size_t produced = drain(out);
+    reset();
+    return static_cast<size_t>(std::min<uint64_t>(produced, total > made ? total - made : 0));
+}
+
+size_t Resampler::drain(float* out)
+{
+    const uint64_t end = m_histStart + m_hist.size();
+
+    size_t produced = 0;
+    while (m_next < end) {
+        const float* window = m_hist.data() + (m_next + 1 - m_taps - m_histStart);
+        out[produced++] = audio_kernels::dot(m_coeffs.data() + m_phase * m_taps, window, m_taps);
+
+        m_phase += m_down;
+        m_next  += m_phase / m_up;
+        m_phase %= m_up;
+    }
+
+    // Keep only the window the next output still needs.
+    const uint64_t keepFrom = m_next + 1 - m_taps;
+    if (keepFrom > m_histStart) {
+        const size_t drop = static_cast<size_t>(std::min<uint64_t>(keepFrom - m_histStart, m_hist.size()));
+        m_hist.erase(m_hist.begin(), m_hist.begin() + drop);
+        m_histStart += drop;
+    }
+    return produced;
+}
@@ -0,0 +1,54 @@
+#pragma once
+// resampler.h — polyphase windowed-sinc sample-rate converter.
+//
+// Converts the capture device's native rate (typically 44.1 or 48 kHz) down
+// to Whisper's 16 kHz on the audio consumer thread, so the real-time
+// callback only copies.  The ratio is reduced to L/M (48k->16k = 1/3,
+// 44.1k->16k = 160/441); each output sample is one SIMD dot product of a
+// Kaiser-windowed sinc phase against the input history.  Streaming: state
+// carries over between process() calls, so block boundaries are invisible.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Resampler {
+public:
+    // transitionHz: width of the roll-off below outRate / 2.  Narrower is
+    // sharper but costs more taps per output sample.
+    Resampler(uint32_t inRate, uint32_t outRate, float transitionHz = 800.0f);
+
+    // Consumes in[0, n) and writes the outputs it makes possible to out.
+    // Returns the count written; at most maxOutput(n) + 1.
+    size_t process(const float* in, size_t n, float* out);
+
+    // Upper bound on outputs for n more inputs (excluding the +1 carry).
+    size_t maxOutput(size_t n) const { return static_cast<size_t>((static_cast<uint64_t>(n) * m_up) / m_down) + 1; }
+
+    // Emits the outputs still held back by the filter — out must hold
+    // maxFlush() — and resets the stream.  In total the output is the input
+    // delayed by delay(), rounded up to whole samples.
+    size_t flush(float* out);
+    size_t maxFlush() const { return maxOutput(m_taps) + 1; }
+
+    // Forgets the history (start of a new recording).
+    void reset();
+
+    uint32_t inRate()       const { return m_inRate; }
+    uint32_t outRate()      const { return m_outRate; }
+    size_t   tapsPerPhase() const { return m_taps; }
+    // Group delay, in output samples.
+    double   delay()        const;
+
+private:
+    // Writes every output the history now covers; returns the count.
+    size_t drain(float* out);
+
+    uint32_t           m_inRate, m_outRate;
+    uint32_t           m_up = 1, m_down = 1;     // L / M
+    size_t             m_taps = 0;               // per phase, multiple of 8
+    std::vector<float> m_coeffs;                 // m_up phases x m_taps, time-reversed
+    std::vector<float> m_hist;                   // input window, oldest first
+    uint64_t           m_histStart = 0;          // input index of m_hist[0]
+    uint64_t           m_next      = 0;          // input index of the next output's newest tap
+    uint32_t           m_phase     = 0;
+};
@@ -0,0 +1,161 @@
+// signal_conditioner.cpp
+#include "signal_conditioner.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// ------------------------------------------------------------------
+// Biquad
+// ------------------------------------------------------------------
+Biquad Biquad::highPass(float cutoffHz, float sampleRate, float q)
+{
+    // RBJ cookbook high-pass.
+    const double w0    = 2.0 * 3.14159265358979 * cutoffHz / sampleRate;
+    const double alpha = std::sin(w0) / (2.0 * q);
+    const double c     = std::cos(w0);
+    const double a0    = 1.0 + alpha;
+
+    Biquad f;
+    f.b0 = static_cast<float>((1.0 + c) / 2.0 / a0);
+    f.b1 = static_cast<float>(-(1.0 + c) / a0);
+    f.b2 = f.b0;
+    f.a1 = static_cast<float>(-2.0 * c / a0);
+    f.a2 = static_cast<float>((1.0 - alpha) / a0);
+    return f;
+}
+
+void Biquad::process(const float* in, float* out, size_t n)
+{
+    // The recursion is serial in time, so this stays scalar; at 16 kHz it
+    // is five multiply-adds per sample.
+    float z1 = m_z1, z2 = m_z2;
+    for (size_t i = 0; i < n; ++i) {
+        const float x = in[i];
+        const float y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        out[i] = y;
+    }
+    // Flush denormals once the input has gone quiet.
+    m_z1 = std::fabs(z1) < 1e-20f ? 0.0f : z1;
+    m_z2 = std::fabs(z2) < 1e-20f ? 0.0f : z2;
+}
+
+// ------------------------------------------------------------------
+// LookaheadAgc
+// ------------------------------------------------------------------
+LookaheadAgc::LookaheadAgc(const Params& p) : m_p(p), m_level(p.targetRms), m_floorMin{ p.floorInit, p.floorInit } {}
+
+void LookaheadAgc::resetStream()
+{
+    std::memset(m_delay, 0, sizeof(m_delay));
+    std::memset(m_peaks, 0, sizeof(m_peaks));
+    m_fill   = 0;
+    m_primed = 0;
+}
+
+size_t LookaheadAgc::process(const float* in, size_t n, float* out)
+{
+    size_t produced = 0;
+    while (n > 0) {
+        const size_t take = std::min(kHop - m_fill, n);
+        std::memcpy(m_delay + kDelay + m_fill, in, take * sizeof(float));
+        m_fill += take;
+        in     += take;
+        n      -= take;
+        if (m_fill == kHop) {
+            // Nothing real to emit until the delay line has filled once.
+            if (m_primed >= kLookahead) {
+                processHop(out + produced);
+                produced += kHop;
+            } else {
+                float discard[kHop];
+                processHop(discard);
+                ++m_primed;
+            }
+            m_fill = 0;
+        }
+    }
+    return produced;
+}
+
+size_t LookaheadAgc::flush(float* out)
+{
+    // Real samples held: the primed hops plus the partial newest one.
+    const size_t held = m_primed * kHop + m_fill;
+    size_t produced = 0;
+    std::memset(m_delay + kDelay + m_fill, 0, (kHop - m_fill) * sizeof(float));
+    for (size_t h = 0; h <= kLookahead; ++h) {
+        float hop[kHop];
+        processHop(hop);
+        const bool padding = h < kLookahead - m_primed;   // zeros ahead of an unfilled line
+        if (!padding) {
+            const size_t take = std::min(kHop, held - produced);
+            std::memcpy(out + produced, hop, take * sizeof(float));
+            produced += take;
+        }
+        std::memset(m_delay + kDelay, 0, kHop * sizeof(float));
+        if (produced == held) break;
+    }
+    resetStream();
+    return produced;
+}
+
+void LookaheadAgc::processHop(float* out)
+{
+    const float* newest = m_delay + kDelay;
+    const float  rms    = audio_kernels::rms(newest, kHop);
+    m_peaks[kLookahead] = audio_kernels::peakAbs(newest, kHop);
+
+    // Noise floor: the quietest hop of the last two to three seconds —
+    // speech leaves gaps that often, and a room that got louder shows
+    // within three.
+    // Digital silence (a device still starting) is not the room.
+    if (rms > 1e-6f) m_blockMin = std::min(m_blockMin, rms);
+    if (++m_blockHops == kFloorHops) {
+        if (m_blockMin < 1.0f) {
+            m_floorMin[0] = m_floorMin[1];
+            m_floorMin[1] = m_blockMin;
+        }
+        m_blockMin  = 1.0f;
+        m_blockHops = 0;
+    }
+    const float floor = noiseFloor();
+
+    // Speech level, tracked in power: fast up, slow down.  Hops not clearly
+    // above the floor freeze the estimate and so the gain, however loud the
+    // room is.
+    const bool speech = rms > std::max(m_p.gate, floor * m_p.gateRatio);
+    if (speech) {
+        const float p = m_level * m_level, q = rms * rms;
+        m_level = std::sqrt(p + (q - p) * (q > p ? m_p.attack : m_p.release));
+    }
+
+    // Level-following gain moves smoothly both ways, but never lifts the
+    // floor over the ceiling (nor cuts for the noise alone).
+    const float floorCap = std::clamp(m_p.noiseCeiling / std::max(floor, 1e-6f), 1.0f, m_p.maxGain);
+    if (speech && m_level > 0.0f) {
+        const float want = std::clamp(m_p.targetRms / m_level, m_p.minGain, floorCap);
+        m_levelGain += (want - m_levelGain) * m_p.smoothing;
+    }
+    m_levelGain = std::min(m_levelGain, floorCap);
+
+    // Look-ahead limit: nothing between the output hop and the newest one
+    // may end up above the ceiling.  That cut is immediate (ramped across
+    // this hop); recovery from it is gentle.
+    const float peak  = *std::max_element(m_peaks, m_peaks + kLookahead + 1);
+    const float limit = peak > 0.0f ? m_p.ceiling / peak : m_p.maxGain;
+    const float next  = m_gain < m_levelGain ? m_gain + (m_levelGain - m_gain) * m_p.recovery : m_levelGain;
+    const float target = std::min(next, limit);
+    const float step   = (target - m_gain) / static_cast<float>(kHop);
+    float g = m_gain;
+    for (size_t i = 0; i < kHop; ++i) {
+        g += step;
+        out[i] = m_delay[i] * g;
+    }
+    m_gain = target;
+
+    std::memmove(m_delay, m_delay + kHop, kDelay * sizeof(float));
+    std::memmove(m_peaks, m_peaks + 1, kLookahead * sizeof(float));
+}
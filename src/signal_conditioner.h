@@ -0,0 +1,89 @@
+#pragma once
+// signal_conditioner.h — level and DC conditioning for 16 kHz speech.
+//
+// Two block-processing stages run in the audio consumer path, so trimming,
+// the VAD and Whisper all see normalised input whatever the microphone:
+//
+//   Biquad        2nd-order Butterworth high-pass (80 Hz by default): strips
+//                 DC offset, handling rumble and mains hum from cheap headsets.
+//   LookaheadAgc  brings speech to a target RMS.  Gain decisions are made
+//                 30 ms ahead of the output, so a sudden loud syllable is
+//                 already being turned down when it arrives — no clipping,
+//                 no pumping.  The room's noise floor is tracked as the
+//                 quietest hop of the last 2-3 s; hops not clearly above it
+//                 hold the gain rather than moving it, and the gain never
+//                 lifts the floor past noiseCeiling, so pauses stay silence
+//                 for the VAD and trimming.
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+class Biquad {
+public:
+    static Biquad highPass(float cutoffHz, float sampleRate, float q = 0.70710678f);
+
+    // In place or out of place; state carries across calls.
+    void process(const float* in, float* out, size_t n);
+    void reset() { m_z1 = m_z2 = 0.0f; }
+
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+
+private:
+    float m_z1 = 0.0f, m_z2 = 0.0f;   // transposed direct form II state
+};
+
+class LookaheadAgc {
+public:
+    static constexpr size_t kHop       = 160;            // 10 ms decision grid
+    static constexpr size_t kLookahead = 3;              // hops (30 ms)
+    static constexpr size_t kDelay     = kHop * kLookahead;
+    static constexpr size_t kFloorHops = 100;            // noise floor minimum block (1 s)
+
+    struct Params {
+        float targetRms = 0.1f;     // -20 dBFS speech level
+        float maxGain   = 10.0f;    // +20 dB
+        float minGain   = 0.25f;    // -12 dB
+        float gate      = 0.002f;   // hop RMS at or below this never moves the level estimate,
+        float gateRatio = 2.0f;     // ... nor below this multiple of the noise floor (+6 dB)
+        float noiseCeiling = 0.002f;   // floor x gain stays below this: an ordinary quiet room
+        float floorInit = 0.002f;   // noise floor until two seconds have been measured
+        float ceiling   = 0.95f;    // no output sample above this
+        float attack    = 0.05f;    // level estimate (power), rising
+        float release   = 0.02f;    // level estimate (power), falling
+        float smoothing = 0.05f;    // per-hop approach of the gain to the level
+        float recovery  = 0.05f;    // per-hop approach back after a ceiling cut
+    };
+
+    LookaheadAgc() : LookaheadAgc(Params{}) {}
+    explicit LookaheadAgc(const Params& p);
+
+    // New recording: clears the delay line.  The level estimate, noise
+    // floor and gain carry over so the first words come out at the right
+    // level — never above what the floor allows.
+    void resetStream();
+
+    // Consumes in[0, n) and writes completed output to out (room for
+    // n + kHop).  Output is the input delayed by kDelay.  Returns the count.
+    size_t process(const float* in, size_t n, float* out);
+
+    // Emits everything still in the delay line (out: room for kDelay + kHop).
+    size_t flush(float* out);
+
+    float gain() const { return m_gain; }
+    float noiseFloor() const { return std::min({ m_floorMin[0], m_floorMin[1], m_blockMin }); }
+
+private:
+    void processHop(float* out);
+
+    Params m_p;
+    float  m_delay[kDelay + kHop]  = {};   // oldest hop first; newest hop last
+    float  m_peaks[kLookahead + 1] = {};   // peak |x| per hop in m_delay
+    size_t m_fill      = 0;                // samples in the newest hop
+    size_t m_primed    = 0;                // hops in the delay line holding real input
+    float  m_level;                        // speech RMS estimate; starts on target
+    float  m_floorMin[2];                  // quietest hop RMS of the last two full blocks
+    float  m_blockMin  = 1.0f;             // ... of the block in progress
+    size_t m_blockHops = 0;
+    float  m_levelGain = 1.0f;             // gain that puts m_level on target
+    float  m_gain      = 1.0f;             // gain applied at the end of the last hop
+};
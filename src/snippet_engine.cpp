@@ -32,14 +32,14 @@ std::string SnippetEngine::apply(const std::string& text) const
 #include <windows.h>
 #include "formatter.h"   // AppMode
 
-AppMode DetectModeFromActiveWindow()
+std::wstring ActiveWindowExePath()
 {
     HWND fg = GetForegroundWindow();
-    if (!fg) return AppMode::PROSE;
+    if (!fg) return {};
 
     DWORD pid = 0;
     GetWindowThreadProcessId(fg, &pid);
-    if (pid == 0) return AppMode::PROSE;
+    if (pid == 0) return {};
 
     wchar_t exePath[MAX_PATH] = {};
     HANDLE proc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
@@ -48,6 +48,13 @@ AppMode DetectModeFromActiveWindow()
         QueryFullProcessImageNameW(proc, 0, exePath, &sz);
         CloseHandle(proc);
     }
+    return exePath;
+}
+
+AppMode DetectModeFromActiveWindow()
+{
+    const std::wstring exePath = ActiveWindowExePath();
+    if (exePath.empty()) return AppMode::PROSE;
 
     // Known code editors / terminals — matched as a substring of the full path.
     static const wchar_t* CODE_APPS[] = {
@@ -72,9 +79,8 @@ AppMode DetectModeFromActiveWindow()
         L"mintty.exe",
     };
 
-    std::wstring path(exePath);
     for (auto* name : CODE_APPS)
-        if (path.find(name) != std::wstring::npos)
+        if (exePath.find(name) != std::wstring::npos)
             return AppMode::CODING;
 
     return AppMode::PROSE;
@@ -18,6 +18,10 @@ private:
     std::unordered_map<std::string, std::string> m_snippets;
 };
 
+// Full path of the executable that owns the focused window; empty if it
+// cannot be determined.
+std::wstring ActiveWindowExePath();
+
 // Detects whether the currently focused window belongs to a code editor.
 // Returns AppMode::CODING for VS Code, Cursor, nvim, Windows Terminal, etc.
 // Falls back to AppMode::PROSE for everything else.
@@ -0,0 +1,147 @@
+// streaming_decoder.cpp — sliding-window Whisper passes with local agreement.
+#include "streaming_decoder.h"
+#include "whisper.h"
+
+#include <algorithm>
+#include <chrono>
+
+// Audio kept before the committed point: the next window starts this far
+// back so the first syllable after it is not clipped.
+static constexpr size_t kOverlap = 3200;   // 200 ms
+
+// Encoder positions for a window: Whisper's 1500 cover 30 s (50 per
+// second).  A little headroom, rounded up to a multiple of 64.
+static int audioCtxForWindow(size_t samples)
+{
+    const size_t positions = samples / 320 + 32;
+    return static_cast<int>(std::clamp<size_t>((positions + 63) / 64 * 64, 128, 1500));
+}
+
+static size_t windowStartFor(const LocalAgreement& agreement)
+{
+    const size_t done = agreement.committedEnd();
+    return done > kOverlap ? done - kOverlap : 0;
+}
+
+void StreamingDecoder::append(const float* x, size_t n)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_audio.insert(m_audio.end(), x, x + n);
+    m_received += n;
+}
+
+bool StreamingDecoder::passDue() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t window = m_received - windowStartFor(m_agreement);
+    return m_received - m_lastPass >= m_params.step
+        && window >= m_params.minWindow
+        && window <= m_params.maxWindow;
+}
+
+bool StreamingDecoder::pass(whisper_context* ctx, whisper_state* state,
+                            const whisper_full_params& base, CancelToken& cancel)
+{
+    size_t      start = 0;
+    std::string prompt;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        start = std::max(windowStartFor(m_agreement), m_offset);
+        const size_t end = std::min(m_received, start + m_params.maxWindow);
+        if (end <= start) return false;
+        m_window.assign(m_audio.begin() + static_cast<std::ptrdiff_t>(start - m_offset),
+                        m_audio.begin() + static_cast<std::ptrdiff_t>(end - m_offset));
+        m_lastPass = m_received;
+        prompt = m_agreement.prompt();
+    }
+
+    whisper_full_params p = base;
+    p.audio_ctx        = audioCtxForWindow(m_window.size());
+    p.single_segment   = false;
+    p.no_timestamps    = false;   // segment times anchor the token times
+    p.token_timestamps = true;
+    p.initial_prompt   = prompt.empty() ? nullptr : prompt.c_str();
+    p.encoder_begin_callback = [](whisper_context*, whisper_state*, void* token) {
+        return !static_cast<CancelToken*>(token)->requested();
+    };
+    p.encoder_begin_callback_user_data = &cancel;
+    p.abort_callback           = &CancelToken::abortCallback;
+    p.abort_callback_user_data = &cancel;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const int err = whisper_full_with_state(ctx, state, p, m_window.data(), static_cast<int>(m_window.size()));
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    if (err != 0 || cancel.requested()) return false;
+
+    // Tokens -> words.  A token starting with a space starts a word; times
+    // are centiseconds from the window start (160 samples each).
+    std::vector<TimedWord> words;
+    const whisper_token eot = whisper_token_eot(ctx);
+    const int nSeg = whisper_full_n_segments_from_state(state);
+    for (int i = 0; i < nSeg; ++i) {
+        const int64_t segT0 = whisper_full_get_segment_t0_from_state(state, i);
+        const int64_t segT1 = whisper_full_get_segment_t1_from_state(state, i);
+        const int nTok = whisper_full_n_tokens_from_state(state, i);
+        for (int j = 0; j < nTok; ++j) {
+            if (whisper_full_get_token_id_from_state(state, i, j) >= eot) continue;   // special
+            const char* text = whisper_full_get_token_text_from_state(ctx, state, i, j);
+            if (!text || !*text) continue;
+            const whisper_token_data d = whisper_full_get_token_data_from_state(state, i, j);
+            const int64_t tb = d.t0 >= 0 ? d.t0 : segT0;
+            const int64_t te = d.t1 >= 0 ? d.t1 : segT1;
+            const size_t b = start + static_cast<size_t>(std::max<int64_t>(0, tb)) * 160;
+            const size_t e = start + static_cast<size_t>(std::max<int64_t>(0, te)) * 160;
+            if (words.empty() || text[0] == ' ') {
+                words.push_back(TimedWord{ text, b, std::max(b, e) });
+            } else {
+                words.back().text += text;
+                words.back().end = std::max(words.back().end, e);
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_agreement.insert(std::move(words));
+    ++m_stats.passes;
+    m_stats.passMs    += ms;
+    m_stats.windowSec += static_cast<double>(m_window.size()) / 16000.0;
+
+    // Audio before the next window is never decoded again; give it back in
+    // whole seconds rather than on every pass.
+    const size_t keepFrom = windowStartFor(m_agreement);
+    if (keepFrom >= m_offset + 16000) {
+        m_audio.erase(m_audio.begin(), m_audio.begin() + static_cast<std::ptrdiff_t>(keepFrom - m_offset));
+        m_offset = keepFrom;
+    }
+    return true;
+}
+
+StreamingDecoder::Hypothesis StreamingDecoder::hypothesis() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Hypothesis{ m_agreement.committedText(), m_agreement.tentativeText() };
+}
+
+StreamingDecoder::Tail StreamingDecoder::tail() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Tail{ windowStartFor(m_agreement), m_agreement.committedText(), m_agreement.prompt() };
+}
+
+std::string StreamingDecoder::prompt() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_agreement.prompt();
+}
+
+size_t StreamingDecoder::received() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_received;
+}
+
+StreamingDecoder::Stats StreamingDecoder::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,89 @@
+#pragma once
+// streaming_decoder.h — live transcription of a recording still in progress.
+//
+// Receives the recording's samples as they are captured and, every
+// `step` of new audio, re-runs Whisper over a sliding window that starts
+// at the end of the committed text.  Hypotheses go through
+// LocalAgreement, so the committed prefix only ever grows.  When the
+// recording stops, only the audio after committedEnd() has to be decoded.
+//
+// Passes run on a caller-owned whisper_state (whisper_full_with_state):
+// any worker's, since one recording never has two passes at once.
+#include "cancel_token.h"
+#include "local_agreement.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct whisper_context;
+struct whisper_state;
+struct whisper_full_params;
+
+class StreamingDecoder {
+public:
+    // All in samples at 16 kHz.
+    struct Params {
+        size_t step      = 16000;        // new audio between passes
+        size_t minWindow = 16000;        // first pass once this much is buffered
+        size_t maxWindow = 16000 * 28;   // Whisper sees at most 30 s; stop passing beyond
+    };
+
+    struct Hypothesis {
+        std::string committed;   // final
+        std::string tentative;   // may still change
+    };
+
+    struct Stats {
+        uint32_t passes    = 0;
+        double   passMs    = 0.0;   // total time in whisper_full_with_state
+        double   windowSec = 0.0;   // total audio decoded by passes
+    };
+
+    StreamingDecoder() = default;
+    explicit StreamingDecoder(const Params& params) : m_params(params) {}
+
+    // Any thread, in recording order: the samples just appended to the
+    // recording.  A copy is kept from the committed point on.
+    void append(const float* x, size_t n);
+
+    // True when enough new audio has arrived for another pass.
+    bool passDue() const;
+
+    // Decodes the current window on `state`.  `base` supplies threads,
+    // language and decoding thresholds; the window's audio_ctx, prompt,
+    // token timestamps and cancellation are set here.  False if the pass
+    // was cancelled or failed (the hypothesis is then unchanged).
+    bool pass(whisper_context* ctx, whisper_state* state, const whisper_full_params& base,
+              CancelToken& cancel);
+
+    Hypothesis hypothesis() const;
+
+    // What the final run at release continues from, in one snapshot: a
+    // cancelled pass still finishing on another worker may commit at any
+    // time, and the text must end where `begin` starts.
+    struct Tail {
+        size_t      begin = 0;   // where undecided audio begins in the recording,
+                                 // with a little overlap (token times are coarse;
+                                 // the overlap is deduplicated when joining)
+        std::string committed;
+        std::string prompt;      // for decoding from `begin`
+    };
+    Tail tail() const;
+    std::string prompt() const;
+    size_t received() const;
+    Stats stats() const;
+
+private:
+    Params                m_params;
+    mutable std::mutex    m_mutex;
+    std::vector<float>    m_audio;          // recording samples from m_offset on
+    size_t                m_offset   = 0;   // recording index of m_audio[0]
+    size_t                m_received = 0;   // samples appended
+    size_t                m_lastPass = 0;   // m_received when the last pass began
+    LocalAgreement        m_agreement;
+    Stats                 m_stats;
+    std::vector<float>    m_window;         // pass input, reused; pass() only
+};
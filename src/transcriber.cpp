@@ -1,5 +1,7 @@
 // transcriber.cpp — performance-tuned for maximum speed (WhisperFlow-style)
 #include "transcriber.h"
+#include "decode_params.h"
+#include "mapped_model.h"
 #include "whisper.h"
 #include <thread>
 #include <algorithm>
@@ -9,6 +11,7 @@
 #include <vector>
 #include <cctype>
 #include <windows.h>
+#include <psapi.h>
 #include <cstdio>
 
 static bool ieq(char a, char b)
@@ -231,39 +234,63 @@ static std::string removeRepetitions(const std::string& text)
 // ------------------------------------------------------------------
 // Trim leading/trailing silence (below threshold) so Whisper processes
 // only the voiced region. This is the single biggest win for short
-// recordings with long pauses at start/end.
+// recordings with long pauses at start/end.  Works on the page chain in
+// place and returns the kept range [begin, end) — no samples move.
+// When the capture stage already tracked the loud range, only the guard
+// window is applied.
 // ------------------------------------------------------------------
-static void trimSilence(std::vector<float>& pcm, float threshold = 0.005f,
-                        int guardSamples = 800 /* 50 ms at 16 kHz */)
+static void trimSilence(const PcmChain& pcm, size_t loudBegin, size_t loudEnd,
+                        size_t& begin, size_t& end,
+                        float threshold = 0.005f,
+                        size_t guardSamples = 800 /* 50 ms at 16 kHz */)
 {
-    const int n = static_cast<int>(pcm.size());
+    const size_t n = pcm.size();
+    begin = 0;
+    end   = n;
     if (n == 0) return;
 
-    // --- find first sample above threshold ---
-    int start = 0;
-    for (; start < n; ++start)
-        if (std::fabs(pcm[start]) > threshold) break;
-
-    // --- find last sample above threshold ---
-    int end = n - 1;
-    for (; end > start; --end)
-        if (std::fabs(pcm[end]) > threshold) break;
+    size_t start = loudBegin;
+    size_t last  = loudEnd > 0 ? loudEnd - 1 : 0;
+    if (loudEnd <= loudBegin || loudEnd > n) {
+        // --- first / last sample above threshold, SIMD scans over the pages ---
+        start = pcm.findFirstAbove(threshold);
+        if (start == n) start = 0;
+        last = pcm.findLastAbove(threshold);
+        if (last == n) last = start;
+    }
 
     // Add a small guard window so we don't clip the onset/release
-    start = std::max(0, start - guardSamples);
-    end   = std::min(n - 1, end + guardSamples);
+    begin = start > guardSamples ? start - guardSamples : 0;
+    end   = std::min(n, last + guardSamples + 1);
+}
 
-    if (start > 0 || end < n - 1) {
-        pcm.erase(pcm.begin() + end + 1, pcm.end());
-        pcm.erase(pcm.begin(), pcm.begin() + start);
-    }
+// Process memory for the load / unload logs, in MB: working set (RSS)
+// and private bytes (what the unload tiers actually give back).
+struct MemoryUse {
+    double workingSet = 0.0;
+    double privateBytes = 0.0;
+};
+
+static MemoryUse memoryUse()
+{
+    PROCESS_MEMORY_COUNTERS_EX pmc{};
+    pmc.cb = sizeof(pmc);
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof(pmc)))
+        return {};
+    return MemoryUse{ pmc.WorkingSetSize / 1048576.0, pmc.PrivateUsage / 1048576.0 };
 }
 
 bool Transcriber::init(const char* modelPath)
 {
     if (!modelPath || !*modelPath) return false;
-    if (m_ctx) shutdown();
+    if (m_ctx) freeModel();
     m_modelPath = modelPath;
+    return loadModel();
+}
+
+bool Transcriber::loadModel()
+{
+    const char* modelPath = m_modelPath.c_str();
 
     whisper_context_params cp = whisper_context_default_params();
     cp.use_gpu    = m_useGPU;
@@ -274,186 +301,769 @@ bool Transcriber::init(const char* modelPath)
     cp.use_gpu = m_useGPU;
     #endif
 
-        m_ctx = whisper_init_from_file_with_params(modelPath, cp);
+    // Weights only: every worker runs its jobs on its own whisper_state.
+    // Read through a file mapping when possible: the file's pages are the
+    // shared page cache, so a reload or another instance finds them there.
+    MappedModel file;
+    auto load = [&]() -> whisper_context* {
+        if (!file.isOpen())
+            return whisper_init_from_file_with_params_no_state(modelPath, cp);
+        whisper_model_loader loader = file.loader();
+        return whisper_init_with_params_no_state(&loader, cp);
+    };
+    if (!file.open(std::filesystem::path(modelPath)))
+        OutputDebugStringA("FLOW-ON: cannot map the model file; reading it instead\n");
+    m_ctx = load();
     if (!m_ctx) {
         // GPU init failed — retry on CPU
         cp.use_gpu    = false;
         cp.flash_attn = true;
-        m_ctx = whisper_init_from_file_with_params(modelPath, cp);
+        m_ctx = load();
+    }
+    if (m_ctx && file.isOpen()) {
+        const MappedModel::Residency r = file.residency();
+        char debugBuf[192];
+        snprintf(debugBuf, sizeof(debugBuf),
+            "FLOW-ON: model read from a %.0f MB mapping; %.0f MB resident, %.0f MB shared with other processes\n",
+            r.mapped / 1048576.0, r.resident / 1048576.0, r.shared / 1048576.0);
+        OutputDebugStringA(debugBuf);
     }
     if (m_ctx) {
+        m_loaded.store(true, std::memory_order_release);
         m_lastUseMs.store(GetTickCount64(), std::memory_order_release);
+        // 128 for large-v3; recordings begun from now on are analysed to match.
+        m_melBands.store(static_cast<size_t>(whisper_model_n_mels(static_cast<whisper_context*>(m_ctx))),
+                         std::memory_order_release);
+    }
+
+    // The VAD model is tiny (~1 MB) and runs on CPU; load it with the main
+    // model so the first gated transcription doesn't pay for it.  Failure
+    // is not fatal — transcription just runs ungated.
+    if (m_ctx && !m_vadCtx && !m_vadModelPath.empty()) {
+        whisper_vad_context_params vcp = whisper_vad_default_context_params();
+        vcp.use_gpu = false;
+        m_vadCtx = whisper_vad_init_from_file_with_params(m_vadModelPath.c_str(), vcp);
+        if (!m_vadCtx)
+            OutputDebugStringA(("FLOW-ON: failed to load VAD model " + m_vadModelPath + "\n").c_str());
     }
     return m_ctx != nullptr;
 }
 
 void Transcriber::shutdown()
 {
+    if (!m_workers.empty()) {
+        m_queue.close();
+        for (std::thread& t : m_workers) t.join();
+        m_workers.clear();
+    }
+    std::unique_lock<std::shared_mutex> lock(m_modelMutex);
+    freeModel();
+}
+
+void Transcriber::freeStates()
+{
+    for (const std::unique_ptr<Slot>& slot : m_slots) {
+        if (!slot->state) continue;
+        whisper_free_state(static_cast<whisper_state*>(slot->state));
+        slot->state = nullptr;
+    }
+}
+
+void Transcriber::freeModel()
+{
+    freeStates();
+    if (m_vadCtx) {
+        whisper_vad_free(static_cast<whisper_vad_context*>(m_vadCtx));
+        m_vadCtx = nullptr;
+    }
     if (m_ctx) {
         whisper_free(static_cast<whisper_context*>(m_ctx));
         m_ctx = nullptr;
     }
+    m_loaded.store(false, std::memory_order_release);
+}
+
+void Transcriber::prefetchModelFile()
+{
+    if (modelLoaded() || m_modelPath.empty()) {
+        m_prefetched.close();   // loaded: the pages did their job
+        return;
+    }
+    if (m_prefetched.isOpen()) return;
+    const auto t0 = std::chrono::steady_clock::now();
+    if (!m_prefetched.open(std::filesystem::path(m_modelPath))) return;
+    const MappedModel::Residency r = m_prefetched.residency();
+    char debugBuf[160];
+    snprintf(debugBuf, sizeof(debugBuf),
+        "FLOW-ON: prefetching the model file (%.0f MB, %.0f MB already resident) in %.1f ms\n",
+        r.mapped / 1048576.0, r.resident / 1048576.0,
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+    OutputDebugStringA(debugBuf);
+}
+
+void Transcriber::unloadIfIdle(uint64_t nowMs, uint64_t stateIdleMs, uint64_t modelIdleMs)
+{
+    // A running job holds the model lock; never wait for it here.
+    std::unique_lock<std::shared_mutex> lock(m_modelMutex, std::try_to_lock);
+    if (!lock.owns_lock() || !m_ctx || m_queue.pending() > 0) return;
+    const uint64_t idleMs = nowMs - m_lastUseMs.load(std::memory_order_acquire);
+
+    const bool weights = idleMs >= modelIdleMs;
+    const bool states  = idleMs >= stateIdleMs
+        && std::any_of(m_slots.begin(), m_slots.end(),
+                       [](const std::unique_ptr<Slot>& slot) { return slot->state != nullptr; });
+    if (!weights && !states) return;
+
+    const MemoryUse before = memoryUse();
+    if (weights) freeModel();
+    else         freeStates();
+    const MemoryUse after = memoryUse();
+
+    char debugBuf[192];
+    snprintf(debugBuf, sizeof(debugBuf),
+        "FLOW-ON: idle %llu s, freed %s; working set %.0f -> %.0f MB, private %.0f -> %.0f MB\n",
+        static_cast<unsigned long long>(idleMs / 1000), weights ? "the model" : "the worker states",
+        before.workingSet, after.workingSet, before.privateBytes, after.privateBytes);
+    OutputDebugStringA(debugBuf);
+}
+
+// Counts a job in Transcriber::m_running while it is in scope.
+class RunningJob {
+public:
+    explicit RunningJob(std::atomic<int>& running)
+        : m_running(running), m_count(running.fetch_add(1, std::memory_order_acq_rel) + 1) {}
+    ~RunningJob() { m_running.fetch_sub(1, std::memory_order_acq_rel); }
+    RunningJob(const RunningJob&) = delete;
+    RunningJob& operator=(const RunningJob&) = delete;
+
+    // Jobs running when this one started, itself included.
+    int count() const { return m_count; }
+
+private:
+    std::atomic<int>& m_running;
+    int               m_count;
+};
+
+const float* Transcriber::gateWithVad(Slot& slot, const float* x, size_t& n)
+{
+    auto* vctx = static_cast<whisper_vad_context*>(m_vadCtx);
+    std::vector<float>& kept = slot.vadScratch;
+
+    whisper_vad_params vp = whisper_vad_default_params();
+    vp.min_silence_duration_ms = 300;   // shorter pauses stay inside a segment
+    vp.speech_pad_ms           = 100;   // keep onsets and releases
+
+    whisper_vad_segments* segs = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_vadMutex);
+        segs = whisper_vad_segments_from_samples(vctx, vp, x, static_cast<int>(n));
+    }
+    if (!segs) return x;   // VAD failed — send the whole range
+
+    constexpr size_t kGap = 1600;   // 100 ms of silence between kept segments
+    if (kept.capacity() < n) kept.reserve(n);
+    kept.clear();
+
+    const int nSeg = whisper_vad_segments_n_segments(segs);
+    for (int i = 0; i < nSeg; ++i) {
+        // Segment times are in centiseconds; 160 samples each at 16 kHz.
+        const float t0 = whisper_vad_segments_get_segment_t0(segs, i);
+        const float t1 = whisper_vad_segments_get_segment_t1(segs, i);
+        const size_t s0 = std::min(n, static_cast<size_t>(std::max(0.0f, t0) * 160.0f));
+        const size_t s1 = std::min(n, static_cast<size_t>(std::max(0.0f, t1) * 160.0f));
+        if (s1 <= s0) continue;
+
+        if (!kept.empty())
+            kept.insert(kept.end(), kGap, 0.0f);
+        kept.insert(kept.end(), x + s0, x + s1);
+    }
+    whisper_vad_free_segments(segs);
+
+    if (kept.empty()) { n = 0; return nullptr; }
+    if (kept.size() >= n) return x;   // nothing worth cutting
+    n = kept.size();
+    return kept.data();
 }
 
-void Transcriber::unloadIfIdle(uint64_t nowMs, uint64_t idleMs)
+// ------------------------------------------------------------------
+// Job queue.  Long-lived workers share the whisper context, each with its
+// own whisper_state; recordings queue up behind them instead of being
+// turned away while they are busy.
+// ------------------------------------------------------------------
+
+// Start-by budget for a job: fixed slack plus half the recording's length,
+// so among equal priorities short utterances sort ahead of long ones.
+static constexpr auto kDeadlineBase = std::chrono::milliseconds(1500);
+
+uint64_t Transcriber::submit(PcmChain pcm, Completion done, const TranscriptionOptions& options)
 {
-    if (!m_ctx) return;
-    if (m_busy.load(std::memory_order_acquire)) return;
-    const uint64_t last = m_lastUseMs.load(std::memory_order_acquire);
-    if (nowMs - last < idleMs) return;
-    shutdown();
+    if (m_modelPath.empty()) return 0;
+
+    const size_t samples = pcm.size();
+    auto deadline = options.deadline;
+    if (deadline == std::chrono::steady_clock::time_point{})
+        deadline = std::chrono::steady_clock::now() + kDeadlineBase
+                 + std::chrono::milliseconds(samples / 32);   // 0.5 x duration at 16 kHz
+
+    startWorkers();
+
+    Request request;
+    request.pcm       = std::move(pcm);
+    request.loudBegin = options.loudBegin;
+    request.loudEnd   = options.loudEnd;
+    if (m_live) {
+        // The recording the open one followed: its spectrogram only lacks
+        // the last few frames, and when streamed only its tail is left.
+        closeRecording(*m_live);
+        if (m_live->mel) m_live->mel->finish();
+        request.kind = m_live->decoder ? JobKind::Final : JobKind::Batch;
+        request.live = std::move(m_live);
+    }
+    return m_queue.push(std::move(request), std::move(done), static_cast<int>(options.priority),
+                        deadline, samples, options.stream);
+}
+
+uint64_t Transcriber::transcribeAsync(HWND hwnd, PcmChain pcm, UINT doneMsg,
+                                      size_t loudBegin, size_t loudEnd,
+                                      JobPriority priority, uint32_t stream)
+{
+    TranscriptionOptions options;
+    options.priority  = priority;
+    options.stream    = stream;
+    options.loudBegin = loudBegin;
+    options.loudEnd   = loudEnd;
+    return submit(std::move(pcm), [hwnd, doneMsg](uint64_t id, std::string text) {
+        auto* s = new std::string(std::move(text));
+        PostMessage(hwnd, doneMsg, static_cast<WPARAM>(id), reinterpret_cast<LPARAM>(s));
+    }, options);
 }
 
-bool Transcriber::transcribeAsync(HWND hwnd, std::vector<float> pcm, UINT doneMsg)
+void Transcriber::startWorkers()
 {
-    // Single-flight guard — prevent re-entry
-    bool expected = false;
-    if (!m_busy.compare_exchange_strong(expected, true,
-            std::memory_order_acq_rel, std::memory_order_acquire))
-        return false;
+    if (!m_workers.empty()) return;
+    const int hw = static_cast<int>(std::thread::hardware_concurrency());
+    const int n  = m_parallel > 0 ? std::min(m_parallel, 8) : (hw >= 8 ? 2 : 1);
+    // Every slot exists before any worker can reach freeModel().
+    for (int i = 0; i < n; ++i)
+        m_slots.push_back(std::make_unique<Slot>());
+    for (const std::unique_ptr<Slot>& slot : m_slots)
+        m_workers.emplace_back([this, s = slot.get()] { workerLoop(*s); });
+}
 
-    // Lazy re-init if model was unloaded while idle
+bool Transcriber::ensureLoaded(std::shared_lock<std::shared_mutex>& model, Slot& slot)
+{
+    // Lazy (re-)init if the model was unloaded while idle.  Whoever gets
+    // the exclusive lock first loads it; the others find it loaded.
+    slot.restored  = Restore::None;
+    slot.restoreMs = 0.0;
     if (!m_ctx) {
-        if (!m_modelPath.empty()) {
-            if (!init(m_modelPath.c_str())) {
-                m_busy.store(false, std::memory_order_release);
-                return false;
+        model.unlock();
+        {
+            std::unique_lock<std::shared_mutex> load(m_modelMutex);
+            if (!m_ctx) {
+                const auto t0 = std::chrono::steady_clock::now();
+                if (loadModel()) {
+                    slot.restored  = Restore::Model;
+                    slot.restoreMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                    const MemoryUse mem = memoryUse();
+                    char debugBuf[160];
+                    snprintf(debugBuf, sizeof(debugBuf),
+                        "FLOW-ON: model loaded in %.0f ms; working set %.0f MB, private %.0f MB\n",
+                        slot.restoreMs, mem.workingSet, mem.privateBytes);
+                    OutputDebugStringA(debugBuf);
+                } else {
+                    OutputDebugStringA("FLOW-ON: model failed to load; job completes empty\n");
+                }
             }
-        } else {
-            m_busy.store(false, std::memory_order_release);
-            return false;
         }
+        model.lock();
+        if (!m_ctx) return false;   // failed, or unloaded again in between
     }
+    if (!slot.state) {
+        const auto t0 = std::chrono::steady_clock::now();
+        slot.state = whisper_init_state(static_cast<whisper_context*>(m_ctx));
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        if (slot.restored == Restore::None) slot.restored = Restore::State;
+        slot.restoreMs += ms;
+        const MemoryUse mem = memoryUse();
+        char debugBuf[160];
+        snprintf(debugBuf, sizeof(debugBuf),
+            slot.state ? "FLOW-ON: worker state allocated in %.0f ms; working set %.0f MB, private %.0f MB\n"
+                       : "FLOW-ON: could not allocate a worker state (%.0f ms, %.0f / %.0f MB); job completes empty\n",
+            ms, mem.workingSet, mem.privateBytes);
+        OutputDebugStringA(debugBuf);
+    }
+    return slot.state != nullptr;
+}
 
-    m_lastUseMs.store(GetTickCount64(), std::memory_order_release);
-
-    // Capture a copy of pcm before moving, validate it's not empty
-    if (pcm.empty()) {
-        m_busy.store(false, std::memory_order_release);
-        auto* s = new std::string("");
-        PostMessage(hwnd, doneMsg, 0, reinterpret_cast<LPARAM>(s));
-        return true;
+void Transcriber::logFirstToken(const Slot& slot, std::chrono::steady_clock::time_point firstToken)
+{
+    const double ms = std::chrono::duration<double, std::milli>(firstToken - slot.jobStart).count();
+    const int kind = static_cast<int>(slot.restored);
+    uint32_t jobs;
+    double mean;
+    {
+        std::lock_guard<std::mutex> lock(m_latencyMutex);
+        jobs = ++m_firstTokenJobs[kind];
+        m_firstTokenMs[kind] += ms;
+        mean = m_firstTokenMs[kind] / jobs;
     }
 
-    std::thread([this, hwnd, pcm = std::move(pcm), doneMsg]() mutable {
-        auto* ctx = static_cast<whisper_context*>(m_ctx);
+    char restored[64] = "warm";
+    if (slot.restored == Restore::State)
+        snprintf(restored, sizeof(restored), "state re-created in %.0f ms", slot.restoreMs);
+    else if (slot.restored == Restore::Model)
+        snprintf(restored, sizeof(restored), "weights reloaded in %.0f ms", slot.restoreMs);
+    char debugBuf[192];
+    snprintf(debugBuf, sizeof(debugBuf),
+        "FLOW-ON: first token %.0f ms after the job started (%s); mean %.0f ms over %u such jobs\n",
+        ms, restored, mean, jobs);
+    OutputDebugStringA(debugBuf);
+}
 
-        // ============================================================
-        // 1. Trim silence — avoid wasting compute on dead air
-        // ============================================================
-        trimSilence(pcm);
+void Transcriber::workerLoop(Slot& slot)
+{
+    Queue::Job job;
+    while (m_queue.pop(job)) {
+        const auto started = std::chrono::steady_clock::now();
+        if (started > job.deadline) {
+            char debugBuf[128];
+            snprintf(debugBuf, sizeof(debugBuf),
+                "FLOW-ON: job %llu started %lld ms past its deadline (%zu queued)\n",
+                static_cast<unsigned long long>(job.id),
+                static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    started - job.deadline).count()),
+                m_queue.pending() - 1);
+            OutputDebugStringA(debugBuf);
+        }
 
-        // Bail out if the trimmed audio is too short (<0.25 s)
-        if (pcm.size() < 4000) {
-            m_busy.store(false, std::memory_order_release);
-            auto* s = new std::string("");
-            PostMessage(hwnd, doneMsg, 0, reinterpret_cast<LPARAM>(s));
-            return;
+        CancelToken& cancel = *job.cancel;
+        std::string text;
+        slot.jobStart = started;
+        {
+            std::shared_lock<std::shared_mutex> model(m_modelMutex);
+            if (!cancel.requested() && ensureLoaded(model, slot)) {
+                const auto ready = std::chrono::steady_clock::now();
+                if (job.payload.kind == JobKind::Prewarm)
+                    logPrewarm(slot, ready);
+                else if (job.payload.kind == JobKind::Pass)
+                    runPass(slot, *job.payload.live, cancel);
+                else if (job.payload.kind == JobKind::Final)
+                    text = runFinal(slot, job.payload, cancel);
+                else
+                    text = run(slot, job.payload.pcm, job.payload.loudBegin, job.payload.loudEnd, cancel,
+                               0, {}, job.payload.live ? job.payload.live->mel.get() : nullptr);
+                if ((job.payload.kind == JobKind::Batch || job.payload.kind == JobKind::Final)
+                    && !cancel.requested())
+                    logReadiness(job, slot, ready);
+            }
         }
 
-        // ============================================================
-        // 2. Configure whisper for maximum throughput
-        // ============================================================
-        whisper_full_params p = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-
-        // -- Threading: reserve 1 core for the UI / OS --
-        const int hw = static_cast<int>(std::thread::hardware_concurrency());
-        p.n_threads   = std::max(1, hw - 1);   // 7 of 8 logical cores
-
-        p.language    = "en";
-        p.translate   = false;
-        p.no_context  = true;
-
-        // -- Segment / timestamp optimisations --
-        p.single_segment   = true;
-        p.no_timestamps    = true;
-        p.token_timestamps = false;
-        p.print_special    = false;
-        p.print_progress   = false;
-        p.print_realtime   = false;
-        p.print_timestamps = false;
-
-        // -- Audio context: aggressive scaling for dictation speed --
-        const float durationSec = static_cast<float>(pcm.size()) / 16000.0f;
-        if      (durationSec < 2.0f)  p.audio_ctx = 128;   // Ultra-fast for short commands
-        else if (durationSec < 5.0f)  p.audio_ctx = 192;   // Short phrases
-        else if (durationSec < 10.0f) p.audio_ctx = 256;   // Medium dictation
-        else if (durationSec < 20.0f) p.audio_ctx = 384;   // Longer dictation
-        else                          p.audio_ctx = 512;   // Cap for long audio
-
-        // -- Decoding: use best_of=1 for speed --
-        p.greedy.best_of    = 1;     // 1 candidate for speed
-        p.temperature       = 0.0f;  // pure greedy — fastest decode
-        p.temperature_inc   = 0.2f;  // skip fallback quickly
-        p.entropy_thold     = 2.2f;  // tighter: reject noisy segments faster
-        p.logprob_thold     = -0.8f; // tighter: drop low-confidence tokens
-        p.no_speech_thold   = 0.65f; // reject silence/noise faster
-
-        // -- Blank suppression --
-        p.suppress_blank = true;
-        p.suppress_nst   = true;    // suppress non-speech tokens
-
-        // Balance speed and accuracy by allowing more output on longer utterances.
-        if      (durationSec < 4.0f)  p.max_tokens = 72;
-        else if (durationSec < 10.0f) p.max_tokens = 128;
-        else                          p.max_tokens = 196;
-
-        // -- No initial prompt (saves token encoding overhead) --
-        p.initial_prompt = nullptr;
-
-        // ============================================================
-        // 3. Run inference
-        // ============================================================
-        const int whisperErr = whisper_full(ctx, p, pcm.data(), static_cast<int>(pcm.size()));
-        if (whisperErr != 0) {
-            char debugBuf[96];
+        if (cancel.requested()) {
+            char debugBuf[160];
             snprintf(debugBuf, sizeof(debugBuf),
-                "FLOW-ON: whisper_full failed with code %d\n", whisperErr);
+                "FLOW-ON: job %llu %s; worker free %.1f ms after the request\n",
+                static_cast<unsigned long long>(job.id),
+                cancel.reason() == CancelToken::Reason::Preempted ? "preempted" : "cancelled",
+                cancel.msSinceRequest(std::chrono::steady_clock::now()));
             OutputDebugStringA(debugBuf);
 
-            m_lastUseMs.store(GetTickCount64(), std::memory_order_release);
-            m_busy.store(false, std::memory_order_release);
-
-            auto* s = new std::string("");
-            PostMessage(hwnd, doneMsg, 0, reinterpret_cast<LPARAM>(s));
-            return;
+            // Preempted: back in the queue with its recording, to run again
+            // once the more urgent work is done.  Not a prewarm: its load
+            // cannot be interrupted, so it is done by now, or the job that
+            // preempted it loads the model itself — a rerun would only
+            // hold that job up.
+            if (cancel.reason() == CancelToken::Reason::Preempted
+                && job.payload.kind != JobKind::Prewarm && m_queue.requeue(job))
+                continue;
+            text.clear();
         }
+        // The next pass may be queued once this one is out of the way.
+        if (job.payload.kind == JobKind::Pass)
+            job.payload.live->passJob.store(0, std::memory_order_release);
 
-        // ============================================================
-        // 4. Collect result and merge overlapping segments conservatively.
-        // ============================================================
-        std::string result;
-        const int nSeg = whisper_full_n_segments(ctx);
+        // Pages go back to the pool before the completion runs.
+        job.payload.pcm.clear();
+        const bool prewarm = job.payload.kind == JobKind::Prewarm;
+        m_queue.complete(job, std::move(text));
+        if (prewarm) m_prewarmQueued.store(false, std::memory_order_release);
+    }
+}
 
-        for (int i = 0; i < nSeg; ++i) {
-            const char* segText = whisper_full_get_segment_text(ctx, i);
-            if (!segText || !*segText) continue;
+// ------------------------------------------------------------------
+// Prewarm.  The hotkey queues a load-only job, so an unloaded model is
+// reloaded while the user speaks instead of after the release.  It runs
+// at Background priority: it never preempts a transcription, and any
+// job queued ahead of it loads the model anyway.  When a transcription
+// preempts it, it completes instead of being requeued.
+// ------------------------------------------------------------------
 
-            appendSegmentDedup(result, std::string(segText));
+// Queue stream for prewarm jobs; their completions carry nothing.
+static constexpr uint32_t kPrewarmStream = 0xFFFFFFFEu;
 
-            if (nSeg > 1 && i == 0) {
-                char debugBuf[128];
-                snprintf(debugBuf, sizeof(debugBuf),
-                    "FLOW-ON: merging %d whisper segments\n", nSeg);
-                OutputDebugStringA(debugBuf);
-            }
+void Transcriber::prewarm()
+{
+    if (m_modelPath.empty()) return;
+    if (m_prewarmQueued.exchange(true, std::memory_order_acq_rel)) return;
+    m_prefetched.close();   // the load reads the file itself
+    startWorkers();
+    m_prewarmAt = std::chrono::steady_clock::now();
+    Request request;
+    request.kind = JobKind::Prewarm;
+    m_queue.push(std::move(request), nullptr, static_cast<int>(JobPriority::Background),
+                 m_prewarmAt + kDeadlineBase, 0, kPrewarmStream);
+}
+
+void Transcriber::logPrewarm(const Slot& slot, std::chrono::steady_clock::time_point ready)
+{
+    char debugBuf[160];
+    if (slot.restored == Restore::None)
+        snprintf(debugBuf, sizeof(debugBuf), "FLOW-ON: prewarm: model and state already loaded\n");
+    else
+        snprintf(debugBuf, sizeof(debugBuf),
+            "FLOW-ON: prewarm: %s in %.0f ms, ready %.0f ms after the hotkey\n",
+            slot.restored == Restore::Model ? "weights and state loaded" : "state re-created",
+            slot.restoreMs, std::chrono::duration<double, std::milli>(ready - m_prewarmAt).count());
+    OutputDebugStringA(debugBuf);
+}
+
+void Transcriber::logReadiness(const Queue::Job& job, const Slot& slot,
+                               std::chrono::steady_clock::time_point ready)
+{
+    // From submit to a loaded model: queueing (possibly behind a prewarm
+    // still loading) plus any load this job did itself.
+    const double readyMs = std::chrono::duration<double, std::milli>(ready - job.submitted).count();
+    const double inferMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - ready).count();
+    char restored[64] = "model already loaded";
+    if (slot.restored == Restore::State)
+        snprintf(restored, sizeof(restored), "state re-created in %.0f ms", slot.restoreMs);
+    else if (slot.restored == Restore::Model)
+        snprintf(restored, sizeof(restored), "weights reloaded in %.0f ms", slot.restoreMs);
+    char debugBuf[192];
+    snprintf(debugBuf, sizeof(debugBuf),
+        "FLOW-ON: job %llu: ready to run %.0f ms after submit (%s), inference %.0f ms\n",
+        static_cast<unsigned long long>(job.id), readyMs, restored, inferMs);
+    OutputDebugStringA(debugBuf);
+}
+
+// ------------------------------------------------------------------
+// Live recording.  The spectrogram is extended on the consumer thread as
+// samples arrive.  Streaming passes are ordinary jobs on the worker, one
+// at a time per recording and at Normal priority, so a finished dictation
+// waiting to be typed always goes first.  They run on their own
+// whisper_state, from the samples: whisper.cpp refines token times
+// against the signal energy, which it only has with PCM input.
+// ------------------------------------------------------------------
+
+// Queue stream for passes; their completions carry nothing.
+static constexpr uint32_t kPassStream = 0xFFFFFFFFu;
+// passJob while queuePass() is between claiming the slot and pushing.
+static constexpr uint64_t kPassPending = ~uint64_t{0};
+
+bool Transcriber::beginRecording(PartialCallback onPartial)
+{
+    if (m_modelPath.empty()) return false;
+    abortRecording();
+
+    auto live = std::make_shared<LiveRecording>();
+    // VAD gating compacts the clip before the encoder; a spectrogram of the
+    // recording as captured would not match what whisper is given.
+    if (m_vadModelPath.empty())
+        live->mel = std::make_unique<LogMelSpectrogram>(m_melBands.load(std::memory_order_acquire));
+    if (onPartial) {
+        startWorkers();
+        live->decoder   = std::make_unique<StreamingDecoder>();
+        live->onPartial = std::move(onPartial);
+    }
+    m_live = std::move(live);
+    return true;
+}
+
+void Transcriber::recordingAppend(const float* x, size_t n)
+{
+    LiveRecording* live = m_live.get();
+    if (!live || live->closed.load(std::memory_order_acquire)) return;
+    if (live->mel) live->mel->push(x, n);
+    if (!live->decoder) return;
+    live->decoder->append(x, n);
+    if (live->passJob.load(std::memory_order_acquire) == 0 && live->decoder->passDue())
+        queuePass(m_live);
+}
+
+void Transcriber::abortRecording()
+{
+    if (!m_live) return;
+    closeRecording(*m_live);
+    m_live.reset();
+}
+
+void Transcriber::queuePass(const std::shared_ptr<LiveRecording>& live)
+{
+    uint64_t idle = 0;
+    if (!live->passJob.compare_exchange_strong(idle, kPassPending, std::memory_order_acq_rel)) return;
+
+    Request request;
+    request.kind = JobKind::Pass;
+    request.live = live;
+    const uint64_t id = m_queue.push(std::move(request), nullptr,
+                                     static_cast<int>(JobPriority::Normal),
+                                     std::chrono::steady_clock::now() + std::chrono::seconds(1),
+                                     0, kPassStream);
+    // Unless the worker has already run it and cleared the slot.
+    uint64_t pending = kPassPending;
+    live->passJob.compare_exchange_strong(pending, id, std::memory_order_acq_rel);
+}
+
+void Transcriber::closeRecording(LiveRecording& live)
+{
+    live.closed.store(true, std::memory_order_release);
+    // A pass over audio that is about to be decoded anyway is wasted work.
+    const uint64_t pass = live.passJob.load(std::memory_order_acquire);
+    if (pass != 0 && pass != kPassPending)
+        m_queue.cancel(pass, std::string{});
+}
+
+void Transcriber::runPass(Slot& slot, LiveRecording& live, CancelToken& cancel)
+{
+    if (live.closed.load(std::memory_order_acquire)) return;
+    auto* ctx = static_cast<whisper_context*>(m_ctx);
+    m_lastUseMs.store(GetTickCount64(), std::memory_order_release);
+
+    const RunningJob running(m_running);
+    whisper_full_params p = baseDecodeParams(running.count());
+    p.max_tokens = 128;
+    if (live.decoder->pass(ctx, static_cast<whisper_state*>(slot.state), p, cancel)
+        && live.onPartial && !live.closed.load(std::memory_order_acquire)) {
+        const StreamingDecoder::Hypothesis h = live.decoder->hypothesis();
+        live.onPartial(h.committed, h.tentative);
+    }
+}
+
+std::string Transcriber::runFinal(Slot& slot, const Request& request, CancelToken& cancel)
+{
+    const StreamingDecoder& decoder = *request.live->decoder;
+    const StreamingDecoder::Tail snapshot = decoder.tail();
+    const size_t from = snapshot.begin;
+    std::string text  = snapshot.committed;
+
+    const std::string tail = run(slot, request.pcm, request.loudBegin, request.loudEnd, cancel,
+                                 from, snapshot.prompt, request.live->mel.get());
+    appendSegmentDedup(text, tail);
+
+    const StreamingDecoder::Stats st = decoder.stats();
+    char debugBuf[224];
+    snprintf(debugBuf, sizeof(debugBuf),
+        "FLOW-ON: streamed %u passes (%.0f ms, %.1f s of windows); %zu chars committed, "
+        "decoded the last %.2f of %.2f s at release\n",
+        st.passes, st.passMs, st.windowSec, snapshot.committed.size(),
+        static_cast<double>(request.pcm.size() - std::min(from, request.pcm.size())) / 16000.0,
+        static_cast<double>(request.pcm.size()) / 16000.0);
+    OutputDebugStringA(debugBuf);
+    return text;
+}
+
+std::string Transcriber::run(Slot& slot, const PcmChain& pcm, size_t loudBegin, size_t loudEnd,
+                             CancelToken& cancel, size_t from, const std::string& prompt,
+                             const LogMelSpectrogram* mel)
+{
+    const auto jobStart = std::chrono::steady_clock::now();
+    m_lastUseMs.store(GetTickCount64(), std::memory_order_release);
+    if (pcm.empty()) return {};
+
+    auto* ctx   = static_cast<whisper_context*>(m_ctx);
+    auto* state = static_cast<whisper_state*>(slot.state);
+
+    // ============================================================
+    // 1. Trim silence — avoid wasting compute on dead air
+    // ============================================================
+    size_t begin = 0, end = 0;
+    trimSilence(pcm, loudBegin, loudEnd, begin, end);
+    begin = std::min(std::max(begin, from), end);
+    size_t nSamples = end - begin;
+
+    // Spectrogram computed while recording: hand whisper the frames of
+    // [begin, end) and skip both the gather and its own STFT.  The clip
+    // starts on the 10 ms frame grid.  Not with VAD gating (the clip is
+    // compacted first) or a model with a different number of mel bands.
+    double melHandoffMs = -1.0;
+    if (mel && !m_vadCtx && nSamples >= 4000
+        && static_cast<int>(mel->melBands()) == whisper_model_n_mels(ctx)) {
+        const auto t0 = std::chrono::steady_clock::now();
+        const size_t nLen = mel->extract(begin, end, slot.melScratch);
+        if (nLen > 0 && whisper_set_mel_with_state(ctx, state, slot.melScratch.data(), static_cast<int>(nLen),
+                                                   static_cast<int>(mel->melBands())) == 0) {
+            begin    -= begin % LogMelSpectrogram::kHop;
+            nSamples  = end - begin;
+            melHandoffMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
         }
+    }
+    const bool melReady = melHandoffMs >= 0.0;
 
-        // Safety net: remove hallucinated repetitions, including short loops.
-        if (!result.empty()) {
-            const std::string deduped = removeRepetitions(result);
-            if (deduped != result) {
-                OutputDebugStringA(("FLOW-ON: collapsed repetition: [" + result + "] -> [" + deduped + "]\n").c_str());
-                result = deduped;
-            }
+    // whisper_full wants one contiguous float buffer.  Use the page
+    // directly when the voiced region fits in one; otherwise gather it
+    // once into the worker's scratch, which keeps its capacity between
+    // jobs.  Compact int16 recordings are converted here, in one SIMD
+    // pass, and nowhere earlier.
+    const float* samples = nSamples >= 4000 && !melReady ? pcm.contiguous(begin, end) : nullptr;
+    if (!samples && nSamples >= 4000 && !melReady) {
+        if (slot.scratch.capacity() < nSamples) slot.scratch.reserve(nSamples);
+        slot.scratch.resize(nSamples);
+        pcm.copyTo(slot.scratch.data(), begin, end);
+        samples = slot.scratch.data();
+    }
+
+    if (cancel.requested()) return {};
+
+    // Neural VAD (optional): keyboard clicks and breathing pass the
+    // amplitude trim; only the model's speech segments go on to the
+    // encoder, with internal pauses compacted.
+    if (samples && m_vadCtx) {
+        const size_t before = nSamples;
+        samples = gateWithVad(slot, samples, nSamples);
+
+        std::lock_guard<std::mutex> lock(m_vadMutex);
+        m_vadFramesIn   += before / 160;
+        m_vadFramesKept += nSamples / 160;
+        char debugBuf[192];
+        snprintf(debugBuf, sizeof(debugBuf),
+            "FLOW-ON: VAD kept %zu of %zu ms; encoder frames %zu -> %zu, audio_ctx %d -> %d "
+            "(%.1f%% of frames saved overall)\n",
+            nSamples / 16, before / 16, before / 160, nSamples / 160,
+            audioCtxFor(before / 16000.0f), audioCtxFor(nSamples / 16000.0f),
+            100.0 * static_cast<double>(m_vadFramesIn - m_vadFramesKept)
+                  / static_cast<double>(std::max<uint64_t>(1, m_vadFramesIn)));
+        OutputDebugStringA(debugBuf);
+    }
+
+    // Bail out if the trimmed audio is too short (<0.25 s)
+    if ((!samples && !melReady) || nSamples < 4000 || cancel.requested())
+        return {};
+
+    // ============================================================
+    // 2. Configure whisper for maximum throughput
+    // ============================================================
+    const RunningJob running(m_running);
+    whisper_full_params p = baseDecodeParams(running.count());
+    if (running.count() > 1) {
+        char debugBuf[96];
+        snprintf(debugBuf, sizeof(debugBuf),
+            "FLOW-ON: %d jobs running; this one on %d threads\n", running.count(), p.n_threads);
+        OutputDebugStringA(debugBuf);
+    }
+
+    // -- Audio context and token budget scale with the clip --
+    const float durationSec = static_cast<float>(nSamples) / 16000.0f;
+    p.audio_ctx  = audioCtxFor(durationSec);
+    p.max_tokens = maxTokensFor(durationSec);
+
+    // -- Streamed recording: the committed text carries the context --
+    if (!prompt.empty()) p.initial_prompt = prompt.c_str();
+
+    // -- Precomputed spectrogram: it carries 30 s of padding frames; only
+    //    the clip's own frames are decoded --
+    if (melReady) p.duration_ms = static_cast<int>(nSamples / 16);
+
+    // -- Cancellation: checked before the encoder and between graph nodes.
+    //    The first check also marks when the encoder started, and the
+    //    first logits filter call when the first token is ready. --
+    struct Timeline {
+        CancelToken*                          cancel;
+        std::chrono::steady_clock::time_point encoder{};
+        std::chrono::steady_clock::time_point firstToken{};
+    } timeline{ &cancel };
+    p.encoder_begin_callback = [](whisper_context*, whisper_state*, void* user) {
+        auto* t = static_cast<Timeline*>(user);
+        if (t->encoder == std::chrono::steady_clock::time_point{}) t->encoder = std::chrono::steady_clock::now();
+        return !t->cancel->requested();
+    };
+    p.encoder_begin_callback_user_data = &timeline;
+    p.logits_filter_callback = [](whisper_context*, whisper_state*, const whisper_token_data*, int,
+                                  float*, void* user) {
+        auto* t = static_cast<Timeline*>(user);
+        if (t->firstToken == std::chrono::steady_clock::time_point{}) t->firstToken = std::chrono::steady_clock::now();
+    };
+    p.logits_filter_callback_user_data = &timeline;
+    p.abort_callback           = &CancelToken::abortCallback;
+    p.abort_callback_user_data = &cancel;
+
+    // ============================================================
+    // 3. Run inference (with no samples, whisper_full uses the mel set above)
+    // ============================================================
+    const int whisperErr = melReady
+        ? whisper_full_with_state(ctx, state, p, nullptr, 0)
+        : whisper_full_with_state(ctx, state, p, samples, static_cast<int>(nSamples));
+    if (timeline.encoder != std::chrono::steady_clock::time_point{}) {
+        char debugBuf[192];
+        const double toEncoderMs = std::chrono::duration<double, std::milli>(timeline.encoder - jobStart).count();
+        if (melReady) {
+            const LogMelSpectrogram::Stats ms = mel->stats();
+            snprintf(debugBuf, sizeof(debugBuf),
+                "FLOW-ON: encoder started %.1f ms into the job; log-mel precomputed while recording "
+                "(%zu frames, %.1f ms), handed over in %.2f ms\n",
+                toEncoderMs, ms.frames, ms.computeMs, melHandoffMs);
+        } else {
+            snprintf(debugBuf, sizeof(debugBuf),
+                "FLOW-ON: encoder started %.1f ms into the job; log-mel computed by whisper_full\n",
+                toEncoderMs);
         }
+        OutputDebugStringA(debugBuf);
+    }
+    if (cancel.requested()) {
+        char debugBuf[160];
+        const double seenMs = cancel.msUntilObserved();
+        if (seenMs >= 0.0)
+            snprintf(debugBuf, sizeof(debugBuf),
+                "FLOW-ON: whisper_full aborted; compute threads saw the request after %.1f ms, "
+                "returned after %.1f ms\n",
+                seenMs, cancel.msSinceRequest(std::chrono::steady_clock::now()));
+        else
+            snprintf(debugBuf, sizeof(debugBuf),
+                "FLOW-ON: whisper_full finished before seeing the cancel request; result dropped\n");
+        OutputDebugStringA(debugBuf);
+        m_lastUseMs.store(GetTickCount64(), std::memory_order_release);
+        return {};
+    }
+    if (whisperErr != 0) {
+        char debugBuf[96];
+        snprintf(debugBuf, sizeof(debugBuf),
+            "FLOW-ON: whisper_full failed with code %d\n", whisperErr);
+        OutputDebugStringA(debugBuf);
 
         m_lastUseMs.store(GetTickCount64(), std::memory_order_release);
-        m_busy.store(false, std::memory_order_release);
+        return {};
+    }
+    if (timeline.firstToken != std::chrono::steady_clock::time_point{})
+        logFirstToken(slot, timeline.firstToken);
 
-        auto* s = new std::string(std::move(result));
-        PostMessage(hwnd, doneMsg, 0, reinterpret_cast<LPARAM>(s));
-    }).detach();
+    // ============================================================
+    // 4. Collect result and merge overlapping segments conservatively.
+    // ============================================================
+    std::string result;
+    const int nSeg = whisper_full_n_segments_from_state(state);
 
-    return true;
+    for (int i = 0; i < nSeg; ++i) {
+        const char* segText = whisper_full_get_segment_text_from_state(state, i);
+        if (!segText || !*segText) continue;
+
+        appendSegmentDedup(result, std::string(segText));
+
+        if (nSeg > 1 && i == 0) {
+            char debugBuf[128];
+            snprintf(debugBuf, sizeof(debugBuf),
+                "FLOW-ON: merging %d whisper segments\n", nSeg);
+            OutputDebugStringA(debugBuf);
+        }
+    }
+
+    // Safety net: remove hallucinated repetitions, including short loops.
+    if (!result.empty()) {
+        const std::string deduped = removeRepetitions(result);
+        if (deduped != result) {
+            OutputDebugStringA(("FLOW-ON: collapsed repetition: [" + result + "] -> [" + deduped + "]\n").c_str());
+            result = deduped;
+        }
+    }
+
+    m_lastUseMs.store(GetTickCount64(), std::memory_order_release);
+    return result;
 }
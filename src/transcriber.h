@@ -2,37 +2,270 @@
 #include <string>
 #include <vector>
 #include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <windows.h>
+#include "pcm_chain.h"
+#include "ordered_job_queue.h"
+#include "streaming_decoder.h"
+#include "log_mel.h"
+#include "mapped_model.h"
 
 // WM_TRANSCRIPTION_DONE lParam is a heap-allocated std::string* the receiver
 // must delete.
 
+// Scheduling class of a transcription job; higher runs first.
+enum class JobPriority { Background = 0, Normal = 1, Interactive = 2 };
+
+// Per-job scheduling for Transcriber::submit().
+struct TranscriptionOptions {
+    // A job submitted above the running job's priority preempts it: the
+    // running job is aborted and queued again, to restart from scratch.
+    JobPriority priority = JobPriority::Normal;
+    // Latest time the job should start; default (epoch) = now plus a
+    // budget that grows with the recording, so that among equal
+    // priorities shorter utterances are scheduled first.
+    std::chrono::steady_clock::time_point deadline{};
+    // Completions are ordered per stream; streams don't wait on each other.
+    uint32_t stream    = 0;
+    // Non-silent range already found by the capture stage; leave empty
+    // to have the worker scan for it.
+    size_t   loudBegin = 0;
+    size_t   loudEnd   = 0;
+};
+
 class Transcriber {
 public:
+    // Called on the worker thread, in submission order within the job's
+    // stream, with the job id and the raw transcript ("" if nothing was
+    // recognised or inference failed).  Keep it short — post a message.
+    using Completion = std::function<void(uint64_t jobId, std::string text)>;
+
+    ~Transcriber() { shutdown(); }
+
     // Configure model and runtime before first transcription.
     void setModelPath(const std::string& modelPath) { m_modelPath = modelPath; }
     void setUseGPU(bool useGPU) { m_useGPU = useGPU; }
+    // Optional whisper.cpp VAD model (e.g. ggml-silero-v5.1.2.bin).  When
+    // set, it is loaded together with the main model and only its speech
+    // segments reach the encoder.  Empty = amplitude trimming only.
+    void setVadModelPath(const std::string& vadModelPath) { m_vadModelPath = vadModelPath; }
+    // How many jobs may run at once, on one copy of the weights: each
+    // worker has its own whisper_state (KV caches and compute buffers),
+    // created when it first runs a job.  Cores are shared out among the
+    // jobs running at the time.  0 = 2 on 8+ logical cores, else 1.
+    // Set before the first submit().
+    void setParallelJobs(int jobs) { m_parallel = jobs; }
 
     // modelPath: e.g. "models/ggml-tiny.en.bin" (relative to CWD or absolute).
-    // Tries GPU first; falls back to CPU silently.
+    // Tries GPU first; falls back to CPU silently.  Loads the weights
+    // only; the workers add their states.  UI thread; the workers reload
+    // lazily (before the first job and after an idle unload) through
+    // loadModel().
     bool init(const char* modelPath);
+
+    // Stops the workers (queued jobs are discarded, running ones are
+    // aborted) and frees the model.
     void shutdown();
 
-    // Non-blocking: spins up a worker thread that calls whisper_full, then
-    // posts WM_TRANSCRIPTION_DONE to hwnd when done.
-    // Returns false if already busy (drop this call — the FSM prevents double-
-    // recording, but guard again here for safety).
-    bool transcribeAsync(HWND hwnd, std::vector<float> pcm, UINT doneMsg);
+    // Queues a recording for the persistent worker threads, which are
+    // started on first use.  Never rejects for being busy: jobs wait their
+    // turn.
+    // Takes ownership of the recording's pages; they go back to the pool
+    // when the job finishes.  If a live recording is open
+    // (beginRecording()), this is the recording it followed: its log-mel
+    // spectrogram is already computed, and when streaming, the job decodes
+    // only the audio after the committed text.  Returns the job id, or 0
+    // if no model path is configured.  Call from one thread (the UI thread).
+    uint64_t submit(PcmChain pcm, Completion done, const TranscriptionOptions& options = {});
+
+    // submit() that posts doneMsg to hwnd on completion: wParam = job id,
+    // lParam = heap-allocated std::string* the receiver must delete.
+    uint64_t transcribeAsync(HWND hwnd, PcmChain pcm, UINT doneMsg,
+                             size_t loudBegin = 0, size_t loudEnd = 0,
+                             JobPriority priority = JobPriority::Normal, uint32_t stream = 0);
+
+    // ---- Live recording: work done while the user is still speaking ----
+
+    // UI thread, when the hotkey goes down: loads the weights and a
+    // worker state, if an idle unload freed them, while the user speaks.
+    // Queues a Background job that only loads (unless one is queued
+    // already); the recording's job then finds the model ready, or waits
+    // for the load in progress instead of starting its own.  Cheap when
+    // everything is loaded.
+    void prewarm();
+
+    // Text of the recording in progress after each streaming pass, on the
+    // worker thread: `committed` is final, `tentative` may still change.
+    // Keep it short — post a message.
+    using PartialCallback = std::function<void(const std::string& committed,
+                                               const std::string& tentative)>;
+
+    // UI thread, before AudioManager::startCapture(): follow the coming
+    // recording as it is captured.  Its log-mel spectrogram is computed as
+    // the samples arrive (unless VAD gating is on, which changes the clip),
+    // so the encoder can start as soon as the job does.  With onPartial,
+    // it is also streamed: every second of new audio queues a pass (Normal
+    // priority) over a sliding window, words two passes agree on are
+    // committed, and the recording's submit() decodes only the uncommitted
+    // tail and completes with committed + tail.  Returns false if no model
+    // path is configured.
+    bool beginRecording(PartialCallback onPartial = nullptr);
+    // AudioManager sample callback: the block just appended to the
+    // recording.  No-op without an open recording.
+    void recordingAppend(const float* x, size_t n);
+    // The recording was discarded instead of submitted.
+    void abortRecording();
+
+    // Stops a job: a queued one completes at once, a running one within
+    // a few milliseconds (whisper.cpp's abort callback is polled between
+    // graph nodes).  Either way its completion gets "" like a silent
+    // recording, still in stream order.  False if it already completed.
+    bool cancel(uint64_t jobId) { return m_queue.cancel(jobId, std::string{}); }
+    // cancel() for everything queued or running; returns how many.
+    size_t cancelAll() { return m_queue.cancelAll(std::string{}); }
 
-    // Unload model after idle to reduce RAM when unused
-    void unloadIfIdle(uint64_t nowMs, uint64_t idleMs);
+    // Two-tier idle unload, to reduce RAM when unused.  After stateIdleMs
+    // without a job, the workers' states (KV caches and compute buffers)
+    // are freed: the next job re-creates one in tens of milliseconds.
+    // After modelIdleMs the weights go too, and the next job reloads them.
+    // Each tier logs the process memory before and after.
+    void unloadIfIdle(uint64_t nowMs, uint64_t stateIdleMs, uint64_t modelIdleMs);
 
-    bool isBusy() const { return m_busy.load(std::memory_order_acquire); }
+    // True while the weights are in memory (a job may be loading them).
+    bool modelLoaded() const { return m_loaded.load(std::memory_order_acquire); }
+    // UI thread, while the model is unloaded: maps the model file and has
+    // the OS read it into the page cache in the background, so the next
+    // load copies from memory.  The mapping is kept until prewarm() or a
+    // call made once the model is loaded.  No-op if already prefetched.
+    void prefetchModelFile();
+
+    // True while any job is queued or running; a prewarm() does not count.
+    bool isBusy() const { return pendingJobs() > 0; }
+    size_t pendingJobs() const
+    {
+        const size_t pending = m_queue.pending();
+        const size_t prewarm = m_prewarmQueued.load(std::memory_order_acquire) ? 1 : 0;
+        return pending > prewarm ? pending - prewarm : 0;
+    }
 
 private:
-    void* m_ctx = nullptr;              // whisper_context* (opaque)
+    // The recording in progress.  The UI thread opens and closes it; the
+    // consumer thread appends (and queues passes); a worker runs them.
+    struct LiveRecording {
+        std::unique_ptr<LogMelSpectrogram> mel;       // unless VAD gating is on
+        std::unique_ptr<StreamingDecoder>  decoder;   // streaming only
+        PartialCallback       onPartial;
+        std::atomic<uint64_t> passJob{0};      // queued or running pass; 0 = none
+        std::atomic<bool>     closed{false};   // submitted or discarded
+    };
+
+    enum class JobKind {
+        Batch,   // a whole recording (with its spectrogram if it was live)
+        Pass,    // streaming pass over the live window
+        Final,   // the uncommitted tail of a streamed recording
+        Prewarm, // load the model and a state; no audio
+    };
+
+    struct Request {
+        PcmChain pcm;
+        size_t   loudBegin = 0;
+        size_t   loudEnd   = 0;
+        JobKind  kind      = JobKind::Batch;
+        std::shared_ptr<LiveRecording> live;  // Pass, Final; Batch if recorded live
+    };
+    using Queue = OrderedJobQueue<Request, std::string>;
+
+    // What the current job had to rebuild after an idle unload.
+    enum class Restore { None, State, Model, Count };
+
+    // One worker's share of the pool: its whisper_state and the buffers
+    // its jobs reuse.  Only that worker touches it, except freeStates().
+    struct Slot {
+        void* state = nullptr;           // whisper_state* (opaque), with the model
+        std::vector<float> scratch;      // contiguous input for whisper_full
+        std::vector<float> vadScratch;   // VAD-compacted input
+        std::vector<float> melScratch;   // spectrogram for whisper_set_mel_with_state
+        // Current job: when the worker took it, and what it had to reload
+        // first (for the first-token latency log).
+        std::chrono::steady_clock::time_point jobStart;
+        Restore restored  = Restore::None;
+        double  restoreMs = 0.0;
+    };
+
+    void startWorkers();   // UI thread
+    void workerLoop(Slot& slot);
+    // Loads the model if it was unloaded (dropping `model` meanwhile) and
+    // the slot's state if it has none.  False if either fails.
+    bool ensureLoaded(std::shared_lock<std::shared_mutex>& model, Slot& slot);
+    // Trim, gate and run whisper_full on one recording, from sample `from`
+    // on, with an optional prompt; m_modelMutex held shared.  With the
+    // recording's spectrogram, whisper_full starts from its frames instead
+    // of the samples.  Returns early, with "", as soon as `cancel` is
+    // requested.
+    std::string run(Slot& slot, const PcmChain& pcm, size_t loudBegin, size_t loudEnd,
+                    CancelToken& cancel, size_t from = 0, const std::string& prompt = {},
+                    const LogMelSpectrogram* mel = nullptr);
+    void runPass(Slot& slot, LiveRecording& live, CancelToken& cancel);              // shared
+    std::string runFinal(Slot& slot, const Request& request, CancelToken& cancel);   // shared
+    void queuePass(const std::shared_ptr<LiveRecording>& live);
+    void closeRecording(LiveRecording& live);
+    void freeStates();  // m_modelMutex held exclusively
+    void freeModel();   // m_modelMutex held exclusively
+    // Loads the weights (and VAD model) from m_modelPath, which it only
+    // reads: the UI thread reads it unlocked, so only init() and
+    // setModelPath() — UI thread — may write it.
+    bool loadModel();
+    // Logs when the job's first token was ready, by what it had to reload.
+    void logFirstToken(const Slot& slot, std::chrono::steady_clock::time_point firstToken);
+    // Load time apart from inference: a prewarm's load, and how long a
+    // recording's job waited for the model before whisper_full.
+    void logPrewarm(const Slot& slot, std::chrono::steady_clock::time_point ready);
+    void logReadiness(const Queue::Job& job, const Slot& slot, std::chrono::steady_clock::time_point ready);
+
+    // Runs the neural VAD over x[0, n) and returns its speech segments
+    // packed back to back (100 ms of silence between them) in the slot's
+    // vadScratch, updating n.  Returns x unchanged if nothing can be cut,
+    // nullptr if there is no speech at all.  Takes m_vadMutex.
+    const float* gateWithVad(Slot& slot, const float* x, size_t& n);
+
+    void* m_ctx = nullptr;              // whisper_context* (opaque), weights only
+    void* m_vadCtx = nullptr;           // whisper_vad_context* (opaque), optional
     std::string m_modelPath;
+    std::string m_vadModelPath;
     bool m_useGPU = true;
-    std::atomic<bool> m_busy{false};
+    int  m_parallel = 0;
+    std::atomic<size_t> m_melBands{80};   // of the loaded (or last loaded) model
     std::atomic<uint64_t> m_lastUseMs{0};
+    std::atomic<int> m_running{0};      // jobs inside whisper_full, for the thread budget
+    std::atomic<bool> m_prewarmQueued{false};   // a Prewarm job is queued or running
+    std::atomic<bool> m_loaded{false};          // m_ctx != nullptr, for the UI thread
+    MappedModel m_prefetched;                   // UI thread: prefetchModelFile()
+    std::chrono::steady_clock::time_point m_prewarmAt;   // its prewarm() call; read by the worker after pop()
+
+    // Persistent workers, one slot each.  Jobs hold m_modelMutex shared
+    // for their whole run; loading and an idle unload hold it exclusively,
+    // so the model never disappears under whisper_full.
+    Queue       m_queue;
+    std::vector<std::thread>           m_workers;
+    std::vector<std::unique_ptr<Slot>> m_slots;
+    std::shared_mutex m_modelMutex;
+
+    // Open recording: set and cleared by the UI thread while the capture
+    // consumer is parked, read by the consumer while it is capturing.
+    std::shared_ptr<LiveRecording> m_live;
+
+    // The VAD context keeps recurrent state: one job at a time.
+    std::mutex m_vadMutex;
+    uint64_t m_vadFramesIn   = 0;       // m_vadMutex: mel frames before / after VAD
+    uint64_t m_vadFramesKept = 0;
+
+    // First-token latency per Restore kind: job count and total ms.
+    std::mutex m_latencyMutex;
+    uint32_t   m_firstTokenJobs[static_cast<int>(Restore::Count)] = {};
+    double     m_firstTokenMs[static_cast<int>(Restore::Count)]   = {};
 };
@@ -0,0 +1,176 @@
+// usage_predictor.cpp — dictation likelihood from usage history.
+#include "usage_predictor.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+using json = nlohmann::json;
+
+static constexpr double kHalfLifeMin = 14.0 * 24.0 * 60.0;   // of observed time
+static constexpr double kPriorMin    = 120.0;   // pseudo-minutes at the overall rate
+static constexpr size_t kMaxApps     = 64;
+
+static int hourOf(int minuteOfDay)
+{
+    return ((minuteOfDay % 1440 + 1440) % 1440) / 60;
+}
+
+void UsagePredictor::forget(double minutes)
+{
+    const double keep = std::pow(0.5, minutes / kHalfLifeMin);
+    auto decay = [keep](Counts& c) { c.uses *= keep; c.minutes *= keep; };
+    for (Counts& c : m_hours) decay(c);
+    decay(m_total);
+    for (auto& [app, c] : m_apps) decay(c);
+}
+
+void UsagePredictor::observe(int minuteOfDay, const std::string& app, double minutes)
+{
+    if (minutes <= 0.0) return;
+    forget(minutes);
+    m_hours[hourOf(minuteOfDay)].minutes += minutes;
+    m_total.minutes += minutes;
+    if (app.empty()) return;
+
+    m_apps[app].minutes += minutes;
+    if (m_apps.size() > kMaxApps) {
+        // Forget the app seen least.
+        auto least = std::min_element(m_apps.begin(), m_apps.end(),
+            [](const auto& a, const auto& b) { return a.second.minutes < b.second.minutes; });
+        m_apps.erase(least);
+    }
+}
+
+bool UsagePredictor::recordUse(int minuteOfDay, const std::string& app, uint64_t nowMs, bool modelLoaded)
+{
+    m_hours[hourOf(minuteOfDay)].uses += 1.0;
+    m_total.uses += 1.0;
+    if (!app.empty()) m_apps[app].uses += 1.0;
+    ++m_stats.uses;
+    if (!modelLoaded) ++m_stats.coldStarts;
+
+    if (m_warmPending && nowMs - m_warmAt <= static_cast<uint64_t>(kHitWindowMin * 60000.0)) {
+        m_warmPending = false;
+        ++m_stats.hits;
+        return true;
+    }
+    return false;
+}
+
+double UsagePredictor::overallRate() const
+{
+    return m_total.minutes > 0.0 ? m_total.uses / m_total.minutes : 0.0;
+}
+
+double UsagePredictor::likelihood(int minuteOfDay, const std::string& app) const
+{
+    const double overall = overallRate();
+    if (overall <= 0.0) return 0.0;
+
+    // Sparse hours and apps are pulled towards the overall rate.
+    auto rate = [overall](const Counts& c) {
+        return (c.uses + overall * kPriorMin) / (c.minutes + kPriorMin);
+    };
+    double appFactor = 1.0;
+    if (!app.empty()) {
+        const auto it = m_apps.find(app);
+        if (it != m_apps.end())
+            appFactor = std::clamp(rate(it->second) / overall, 0.2, 5.0);
+    }
+
+    // Expected dictations over the horizon, minute by minute across the
+    // hour boundary; Poisson arrivals.
+    double expected = 0.0;
+    for (int m = 0; m < static_cast<int>(kHorizonMin); ++m)
+        expected += rate(m_hours[hourOf(minuteOfDay + m)]);
+    return 1.0 - std::exp(-expected * appFactor);
+}
+
+UsagePredictor::Advice UsagePredictor::advise(int minuteOfDay, const std::string& app) const
+{
+    // Until there is a day of history, the configured timeouts apply.
+    if (m_total.minutes < 24.0 * 60.0) return Advice::Normal;
+    const double p = likelihood(minuteOfDay, app);
+    if (p >= kPreloadAt)  return Advice::Preload;
+    if (p >= kPrefetchAt) return Advice::Prefetch;
+    if (p <  kEvictBelow) return Advice::Evict;
+    return Advice::Normal;
+}
+
+void UsagePredictor::warmedUp(uint64_t nowMs)
+{
+    if (m_warmPending) return;   // still waiting on the previous one
+    m_warmPending = true;
+    m_warmAt      = nowMs;
+    ++m_stats.warmUps;
+}
+
+bool UsagePredictor::expire(uint64_t nowMs)
+{
+    if (!m_warmPending || nowMs - m_warmAt <= static_cast<uint64_t>(kHitWindowMin * 60000.0)) return false;
+    m_warmPending = false;
+    ++m_stats.misses;
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Persistence
+// ------------------------------------------------------------------
+
+bool UsagePredictor::load(const std::filesystem::path& path)
+{
+    std::ifstream f(path);
+    if (!f.is_open()) return false;
+    try {
+        json j;
+        f >> j;
+        auto counts = [](const json& v) {
+            return v.is_array() && v.size() == 2 ? Counts{ v[0].get<double>(), v[1].get<double>() } : Counts{};
+        };
+        UsagePredictor p;
+        if (j.contains("hours") && j["hours"].is_array() && j["hours"].size() == 24)
+            for (size_t h = 0; h < 24; ++h) p.m_hours[h] = counts(j["hours"][h]);
+        if (j.contains("total"))  p.m_total = counts(j["total"]);
+        if (j.contains("apps") && j["apps"].is_object())
+            for (auto& [app, v] : j["apps"].items())
+                if (p.m_apps.size() < kMaxApps) p.m_apps[app] = counts(v);
+        if (j.contains("stats") && j["stats"].is_object()) {
+            const json& s = j["stats"];
+            if (s.contains("warm_ups"))    p.m_stats.warmUps    = s["warm_ups"];
+            if (s.contains("hits"))        p.m_stats.hits       = s["hits"];
+            if (s.contains("misses"))      p.m_stats.misses     = s["misses"];
+            if (s.contains("uses"))        p.m_stats.uses       = s["uses"];
+            if (s.contains("cold_starts")) p.m_stats.coldStarts = s["cold_starts"];
+        }
+        *this = std::move(p);
+    } catch (...) {
+        // Corrupted history — start learning again.
+        *this = UsagePredictor{};
+        return false;
+    }
+    return true;
+}
+
+bool UsagePredictor::save(const std::filesystem::path& path) const
+{
+    std::ofstream f(path);
+    if (!f.is_open()) return false;
+
+    auto counts = [](const Counts& c) { return json::array({ c.uses, c.minutes }); };
+    json j;
+    j["version"] = 1;
+    j["hours"]   = json::array();
+    for (const Counts& c : m_hours) j["hours"].push_back(counts(c));
+    j["total"]   = counts(m_total);
+    j["apps"]    = json::object();
+    for (const auto& [app, c] : m_apps) j["apps"][app] = counts(c);
+    j["stats"]["warm_ups"]    = m_stats.warmUps;
+    j["stats"]["hits"]        = m_stats.hits;
+    j["stats"]["misses"]      = m_stats.misses;
+    j["stats"]["uses"]        = m_stats.uses;
+    j["stats"]["cold_starts"] = m_stats.coldStarts;
+
+    f << j.dump(2);
+    return f.good();
+}
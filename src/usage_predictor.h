@@ -0,0 +1,95 @@
+#pragma once
+// usage_predictor.h — when is the user likely to dictate next?
+//
+// The idle unload runs on a fixed timer, so the model is freed just
+// before the usual morning dictation and kept through the night after
+// the last one.  This learns, from the app's own history, how often the
+// user dictates in each hour of the day and with each foreground app,
+// and turns that into the probability of a dictation in the next few
+// minutes.  The UI thread's idle check asks for advice:
+//
+//   Preload   — likely: load the weights now and keep them loaded;
+//   Prefetch  — possible: read the model file into the page cache, so a
+//               load costs no disk I/O;
+//   Normal    — the configured idle timeouts;
+//   Evict     — unlikely: free state and weights soon after the last use.
+//
+// Rates are dictations per minute the app was running, per hour of day
+// and per foreground app (exe file name), with exponential forgetting
+// (two-week half-life of observed time) so habits can change.  Hours and
+// apps with little history lean on the overall rate.
+//
+// Each Preload is scored: a dictation within kHitWindowMin is a hit, none
+// is a miss.  A dictation that found the model unloaded is a cold start.
+// Counts and scores persist as JSON.  Not thread-safe: one thread (the
+// UI thread) owns it.
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+class UsagePredictor {
+public:
+    enum class Advice { Evict, Normal, Prefetch, Preload };
+
+    static constexpr double kHorizonMin   = 5.0;    // "next few minutes"
+    static constexpr double kPreloadAt    = 0.5;    // P(dictation within the horizon)
+    static constexpr double kPrefetchAt   = 0.2;
+    static constexpr double kEvictBelow   = 0.02;
+    static constexpr double kHitWindowMin = 15.0;   // a warm-up used this soon is a hit
+
+    struct Stats {
+        uint32_t warmUps     = 0;   // Preloads acted on
+        uint32_t hits        = 0;   // followed by a dictation in time
+        uint32_t misses      = 0;   // expired unused
+        uint32_t uses        = 0;   // dictations recorded
+        uint32_t coldStarts  = 0;   // dictations that found the model unloaded
+        double hitRate() const { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+    };
+
+    // Times of day are local minutes since midnight (0..1439); apps are
+    // exe file names, "" if unknown.
+
+    // `minutes` of the app running, ending at `minuteOfDay`, with `app`
+    // in front.  Call on every idle check.
+    void observe(int minuteOfDay, const std::string& app, double minutes);
+
+    // A dictation started; `modelLoaded` says whether the weights were
+    // already in memory.  Returns true if it redeemed a pending warm-up
+    // (a hit).
+    bool recordUse(int minuteOfDay, const std::string& app, uint64_t nowMs, bool modelLoaded);
+
+    // Probability of a dictation within kHorizonMin from `minuteOfDay`;
+    // the horizon may reach into the next hour, so a busy hour is
+    // anticipated a few minutes before it starts.
+    double likelihood(int minuteOfDay, const std::string& app) const;
+    Advice advise(int minuteOfDay, const std::string& app) const;
+
+    // The model was preloaded on advice at nowMs (scored later).
+    void warmedUp(uint64_t nowMs);
+    // Scores a warm-up older than kHitWindowMin as a miss.  Returns true
+    // if one was scored now.
+    bool expire(uint64_t nowMs);
+
+    const Stats& stats() const { return m_stats; }
+
+    // usage.json: counts per hour and app, and the scores.
+    bool load(const std::filesystem::path& path);
+    bool save(const std::filesystem::path& path) const;
+
+private:
+    struct Counts {
+        double uses    = 0.0;   // dictations (decayed)
+        double minutes = 0.0;   // observed time (decayed)
+    };
+
+    double overallRate() const;   // dictations per minute, all hours
+    void   forget(double minutes);
+
+    Counts   m_hours[24];
+    Counts   m_total;
+    std::unordered_map<std::string, Counts> m_apps;
+    bool     m_warmPending = false;
+    uint64_t m_warmAt      = 0;
+    Stats    m_stats;
+};
@@ -0,0 +1,64 @@
+// vad_engine.cpp
+#include "vad_engine.h"
+#include <algorithm>
+#include <cmath>
+
+void VadEngine::resetSession()
+{
+    m_frame        = 0;
+    m_speechFrames = 0;
+    m_silentFrames = 0;
+    m_inSpeech     = false;
+}
+
+void VadEngine::reset(float noiseFloor)
+{
+    resetSession();
+    m_noiseFloor = std::max(m_cfg.floorMin, noiseFloor);
+}
+
+float VadEngine::voicedThreshold() const
+{
+    return std::max(m_cfg.voicedMin, m_noiseFloor * m_cfg.voicedRatio);
+}
+
+VadEvent VadEngine::process(const FeatureFrame& f)
+{
+    const float rms = std::sqrt(f.energy);
+    ++m_frame;
+
+    const float speechThreshold  = std::max(m_cfg.speechMin,  m_noiseFloor * m_cfg.speechRatio);
+    const float silenceThreshold = std::max(m_cfg.silenceMin, m_noiseFloor * m_cfg.silenceRatio);
+
+    // The floor learns from non-speech frames only; letting speech into the
+    // average would drag the thresholds up until a long utterance ended itself.
+    if (rms < speechThreshold)
+        m_noiseFloor = std::max(m_cfg.floorMin,
+                                m_noiseFloor * (1.0f - m_cfg.floorAlpha) + rms * m_cfg.floorAlpha);
+
+    if (rms >= speechThreshold) {
+        m_speechFrames++;
+        m_silentFrames = 0;
+        if (!m_inSpeech && m_speechFrames >= m_cfg.startFrames) {
+            m_inSpeech = true;
+            return VadEvent::SpeechStart;
+        }
+        return VadEvent::None;
+    }
+
+    if (m_inSpeech) {
+        // Between the two thresholds counts as neither: the silent run
+        // neither grows nor resets, so a soft trailing word can't end it.
+        if (rms <= silenceThreshold && ++m_silentFrames >= m_cfg.endFrames) {
+            m_inSpeech     = false;
+            m_speechFrames = 0;
+            m_silentFrames = 0;
+            return VadEvent::SpeechEnd;
+        }
+    } else if (m_speechFrames == 0) {
+        // Before any speech, keep adapting quickly to the ambient noise.
+        m_noiseFloor = std::max(m_cfg.floorMin,
+                                m_noiseFloor * (1.0f - m_cfg.floorAlphaIdle) + rms * m_cfg.floorAlphaIdle);
+    }
+    return VadEvent::None;
+}
@@ -0,0 +1,57 @@
+#pragma once
+// vad_engine.h — frame-accurate voice activity detection.
+//
+// Driven once per 10 ms FeatureFrame from the audio consumer stage, so its
+// decisions depend only on the audio, never on how busy the UI thread is:
+// the same input always produces the same events at the same frame index.
+// Portable — no Win32, no device; feed it frames and read the events back.
+#include <cstddef>
+#include "feature_extractor.h"
+
+enum class VadEvent { None, SpeechStart, SpeechEnd };
+
+struct VadConfig {
+    // Thresholds are multiples of the tracked noise floor (RMS), clamped
+    // below by an absolute minimum.  speech > silence gives the hysteresis.
+    float speechRatio    = 2.4f;
+    float speechMin      = 0.0065f;
+    float silenceRatio   = 1.5f;
+    float silenceMin     = 0.0045f;
+    float voicedRatio    = 2.0f;      // feature-frame "voiced" flag
+    float voicedMin      = 0.0065f;
+
+    float floorMin       = 0.0015f;
+    float floorAlpha     = 0.0067f;   // slow tracker, every frame
+    float floorAlphaIdle = 0.034f;    // fast tracker before the first speech
+
+    size_t startFrames   = 12;        // speech frames before SpeechStart (120 ms)
+    size_t endFrames     = 150;       // consecutive silent frames before SpeechEnd (1.5 s)
+};
+
+class VadEngine {
+public:
+    explicit VadEngine(const VadConfig& cfg = VadConfig{}) : m_cfg(cfg) {}
+
+    // Starts a new utterance.  The noise floor carries over between
+    // sessions, as the room rarely changes between two hotkey presses.
+    void resetSession();
+
+    // Forgets the learned noise floor as well.
+    void reset(float noiseFloor = 0.004f);
+
+    // Feeds one frame; returns the event it triggers, if any.
+    VadEvent process(const FeatureFrame& f);
+
+    bool   inSpeech()         const { return m_inSpeech; }
+    float  noiseFloor()       const { return m_noiseFloor; }
+    size_t frameIndex()       const { return m_frame; }   // frames processed this session
+    float  voicedThreshold()  const;
+
+private:
+    VadConfig m_cfg;
+    float     m_noiseFloor   = 0.004f;
+    size_t    m_frame        = 0;
+    size_t    m_speechFrames = 0;   // cumulative, since the last SpeechEnd
+    size_t    m_silentFrames = 0;   // consecutive
+    bool      m_inSpeech     = false;
+};